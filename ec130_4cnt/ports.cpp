@@ -0,0 +1,55 @@
+// Friden EC-130 (4 counter) model ports
+
+#include "Vtop.h"
+#include "shm_view.h"
+#include "ports.h"
+
+const char *ports_model = "ec130_4cnt";
+const int ports_dl_origin = 1504;
+
+void ports_read(Vtop *top, shm_view_t *v) {
+    v->a_cnt = top->a_cnt;
+    v->b_cnt = top->b_cnt;
+    v->c_cnt = top->c_cnt;
+    v->d_cnt = top->d_cnt;
+    v->timing = top->timing;
+
+    PORTS_FF(v, SHM_FF_START, top->ff_start);
+    PORTS_FF(v, SHM_FF_HOME, top->ff_home);
+    PORTS_FF(v, SHM_FF_COM_DIG, top->ff_com_dig);
+    PORTS_FF(v, SHM_FF_COM_FUN, top->ff_com_fun);
+    PORTS_FF(v, SHM_FF_MULT, top->ff_mult);
+    PORTS_FF(v, SHM_FF_DIV, top->ff_div);
+    PORTS_FF(v, SHM_FF_ADD_SUB, top->ff_add_sub);
+    PORTS_FF(v, SHM_FF_CHG_SIGN, top->ff_chg_sign);
+    PORTS_FF(v, SHM_FF_SHIFT_DOWN, top->ff_shift_down);
+    PORTS_FF(v, SHM_FF_STORE, top->ff_store);
+    PORTS_FF(v, SHM_FF_RECALL, top->ff_recall);
+    PORTS_FF(v, SHM_FF_REPEAT, top->ff_repeat);
+    PORTS_FF(v, SHM_FF_CFS, top->ff_cfs);
+    PORTS_FF(v, SHM_FF_SIGN_CONT, top->ff_sign_cont);
+    PORTS_FF(v, SHM_FF_DPS, top->ff_dps);
+    PORTS_FF(v, SHM_FF_OF, top->ff_of);
+    PORTS_FF(v, SHM_FF_CARRY, top->ff_carry);
+    PORTS_FF(v, SHM_FF_CARRY_OF, top->ff_carry_of);
+}
+
+#ifdef LOCKSTEP
+// every port but clk, for the lockstep check
+#define PORTS_INPUTS(X) \
+    X(key_of_lock) X(key_chg_sign) X(key_repeat) X(key_div) \
+    X(key_clr_ent) X(key_enter) X(key_mult) X(key_clr_all) X(key_sub) \
+    X(key_add) X(key_store) X(key_recall) X(key_dp) X(key_0) X(key_1) \
+    X(key_2) X(key_3) X(key_4) X(key_5) X(key_6) X(key_7) X(key_8) \
+    X(key_9) X(sw_dp)
+#define PORTS_OUTPUTS(X) \
+    X(lamp_overflow) X(kbd_lock) X(kbd_ack) X(phase) X(a_cnt) X(b_cnt) \
+    X(c_cnt) X(d_cnt) X(dp_cnt) X(ff_start) X(ff_chg_sign) \
+    X(ff_shift_down) X(ff_store) X(ff_recall) X(ff_repeat) X(ff_mult) \
+    X(ff_div) X(ff_com_dig) X(ff_com_fun) X(ff_add_sub) X(ff_cfs) \
+    X(ff_sign_cont) X(ff_dps) X(ff_of) X(ff_carry) X(ff_carry_of) \
+    X(ff_home) X(timing) X(reg_4) X(reg_3) X(reg_2) X(reg_1) X(reg_0) \
+    X(reg_s) X(reg_4_l) X(reg_3_l) X(reg_2_l) X(reg_1_l) X(reg_0_l) \
+    X(reg_s_l)
+#include "ports_lockstep.h"
+#endif
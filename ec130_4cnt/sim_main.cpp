@@ -9,8 +9,19 @@
 #include "verilated_vcd_c.h"
 #include "Vtop.h"
 #include <ncurses.h>
-
-#define KEY_DELAY 50000UL
+#include "sim.h"
+#include "keys.h"
+#include "batch.h"
+#include "scenario.h"
+#include "snapshot.h"
+#include "metrics.h"
+#include "engine.h"
+#include "shm.h"
+#include "dltrace.h"
+#include "lockstep.h"
+#include "typeahead.h"
+#include "realtime.h"
+#include "trace_writer.h"
 
 // prints a register in a human-readable way
 void print_reg(uint8_t * reg, int dp) {
@@ -28,19 +39,37 @@ void print_reg(uint8_t * reg, int dp) {
 }
 
 int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    // +scenario+<names> runs tests headlessly, as batch mode does, and
+    // so does +dltrace_replay+<file>
+    const char *scenario = sim_plusarg("scenario");
+    const char *replay = sim_plusarg("dltrace_replay");
+    int batch = sim_plusflag("batch") || scenario || replay;
+    metrics_start(sim_plusarg("metrics"));
+    if (shm_start(sim_plusarg("shm")) || dltrace_start(sim_plusarg("dltrace")))
+        exit(1);
+
     WINDOW *win;
-    win = initscr();
-    nodelay(win, TRUE);
-    keypad(win, TRUE);
-    noecho();
-    curs_set(0);
+    if (!batch) {
+        win = initscr();
+        nodelay(win, TRUE);
+        keypad(win, TRUE);
+        noecho();
+        curs_set(0);
+    }
 
     if (false && argc && argv && env) {}
 
     Verilated::debug(0);
     Verilated::randReset(2);
     Verilated::traceEverOn(true);
-    Verilated::commandArgs(argc, argv);
+
+    // before the model is created, as the check starts it from reset
+    if (lockstep_start(sim_plusarg("lockstep"))) {
+        if (!batch)
+            endwin();
+        exit(1);
+    }
 
     Vtop *top = new Vtop;
 
@@ -48,43 +77,58 @@ int main(int argc, char** argv, char** env) {
 	VerilatedVcdC* tfp = nullptr;
 	const char* flag = Verilated::commandArgsPlusMatch("trace");
     if (flag && 0 == strcmp(flag, "+trace")) {
-		tfp = new VerilatedVcdC;
-		top->trace(tfp, 99);
-		tfp->open("logs/trace.vcd");
+		tfp = trace_open(top, "logs/trace.vcd");
 	}
 	VL_PRINTF("starting simulation...\n");
 #endif
 
-    top->key_of_lock = 0;
-    top->key_chg_sign = 0;
-    top->key_repeat = 0;
-    top->key_div = 0;
-    top->key_clr_ent = 0;
-    top->key_enter = 0;
-    top->key_mult = 0;
-    top->key_clr_all = 0;
-    top->key_sub = 0;
-    top->key_add = 0;
-    top->key_store = 0;
-    top->key_recall = 0;
-    top->key_dp = 0;
-    top->key_0 = 0;
-    top->key_1 = 0;
-    top->key_2 = 0;
-    top->key_3 = 0;
-    top->key_4 = 0;
-    top->key_5 = 0;
-    top->key_6 = 0;
-    top->key_7 = 0;
-    top->key_8 = 0;
-    top->key_9 = 0;
+    key_release_all(top);
     top->sw_dp = 5;
 
     top->eval();
 
-    uint64_t t_event;
-    int valid_press = 0;
-    int key_processed = 1;
+    // start out cleared and idle if given a power-on image
+    if (snapshot_poweron(top)) {
+        if (!batch)
+            endwin();
+        fprintf(stderr, "can't read power-on image %s\n", sim_plusarg("poweron"));
+        exit(1);
+    }
+
+    if (batch) {
+#if VM_TRACE
+        int status = replay ? dltrace_replay(top, tfp, replay) :
+                     scenario ? scenario_main(top, tfp, scenario) : batch_main(top, tfp);
+        if (tfp)
+            tfp->close();
+#else
+        int status = replay ? dltrace_replay(top, nullptr, replay) :
+                     scenario ? scenario_main(top, nullptr, scenario) : batch_main(top, nullptr);
+#endif
+        top->final();
+        exit(status);
+    }
+
+    sim_t s;
+    sim_init(&s, top);
+#if VM_TRACE
+    s.tfp = tfp;
+#endif
+    if (engine_arg() == ENGINE_FUNC)
+        s.engine = engine_new(top);
+
+    // keys wait in the type-ahead queue until the machine takes them,
+    // so a paste or +typein+<file> goes in as fast as it can
+    s.keyhold = sim_keyhold_arg(KEYHOLD_ADAPTIVE);
+    typeahead_t q;
+    typeahead_init(&q);
+    if (typeahead_open(&q, sim_plusarg("typein"))) {
+        endwin();
+        exit(1);
+    }
+    realtime_t rt;
+    realtime_init(&rt, &s);
+
     int c;
     int quit = 0;
 
@@ -95,123 +139,6 @@ int main(int argc, char** argv, char** env) {
         c = getch();
         if (c > 0) {
             switch (c) {
-                case '0':
-                    mvprintw(8,0,"key press: 0\n");
-                    valid_press = 1;
-                    top->key_0 = 1;
-                    break;
-                case '1':
-                    mvprintw(8,0,"key press: 1\n");
-                    valid_press = 1;
-                    top->key_1 = 1;
-                    break;
-                case '2':
-                    mvprintw(8,0,"key press: 2\n");
-                    valid_press = 1;
-                    top->key_2 = 1;
-                    break;
-                case '3':
-                    mvprintw(8,0,"key press: 3\n");
-                    valid_press = 1;
-                    top->key_3 = 1;
-                    break;
-                case '4':
-                    mvprintw(8,0,"key press: 4\n");
-                    valid_press = 1;
-                    top->key_4 = 1;
-                    break;
-                case '5':
-                    mvprintw(8,0,"key press: 5\n");
-                    valid_press = 1;
-                    top->key_5 = 1;
-                    break;
-                case '6':
-                    mvprintw(8,0,"key press: 6\n");
-                    valid_press = 1;
-                    top->key_6 = 1;
-                    break;
-                case '7':
-                    mvprintw(8,0,"key press: 7\n");
-                    valid_press = 1;
-                    top->key_7 = 1;
-                    break;
-                case '8':
-                    mvprintw(8,0,"key press: 8\n");
-                    valid_press = 1;
-                    top->key_8 = 1;
-                    break;
-                case '9':
-                    mvprintw(8,0,"key press: 9\n");
-                    valid_press = 1;
-                    top->key_9 = 1;
-                    break;
-                case KEY_ENTER:
-                case '\n':
-                case '\r':
-                    mvprintw(8,0,"key press: ENTER\n");
-                    valid_press = 1;
-                    top->key_enter = 1;
-                    break;
-                case KEY_BACKSPACE:
-                    mvprintw(8,0,"key press: CLEAR ENTRY\n");
-                    valid_press = 1;
-                    top->key_clr_ent = 1;
-                    break;
-                case 'c':
-                    mvprintw(8,0,"key press: CLEAR ALL\n");
-                    valid_press = 1;
-                    top->key_clr_all = 1;
-                    break;
-                case '.':
-                    mvprintw(8,0,"key press: DECIMAL POINT\n");
-                    valid_press = 1;
-                    top->key_dp = 1;
-                    break;
-                case 's':
-                    mvprintw(8,0,"key press: CHANGE SIGN\n");
-                    valid_press = 1;
-                    top->key_chg_sign = 1;
-                    break;
-                case 'r':
-                    mvprintw(8,0,"key press: REPEAT\n");
-                    valid_press = 1;
-                    top->key_repeat = 1;
-                    break;
-                case 'o':
-                    mvprintw(8,0,"key press: OVERFLOW LOCK\n");
-                    valid_press = 1;
-                    top->key_of_lock = 1;
-                    break;
-                case 't':
-                    mvprintw(8,0,"key press: STORE\n");
-                    valid_press = 1;
-                    top->key_store = 1;
-                    break;
-                case 'e':
-                    mvprintw(8,0,"key press: RECALL\n");
-                    valid_press = 1;
-                    top->key_recall = 1;
-                    break;
-                case '*':
-                    mvprintw(8,0,"key press: MUL\n");
-                    valid_press = 1;
-                    top->key_mult = 1;
-                    break;
-                case '/':
-                    mvprintw(8,0,"key press: DIV\n");
-                    valid_press = 1;
-                    top->key_div = 1;
-                    break;
-                case '+':
-                    mvprintw(8,0,"key press: ADD\n");
-                    valid_press = 1;
-                    top->key_add = 1;
-                    break;
-                case '-':
-                    mvprintw(8,0,"key press: SUB\n");
-                    valid_press = 1;
-                    top->key_sub = 1;
-                    break;
                 case KEY_UP:
                     if (top->sw_dp < 13)
                         top->sw_dp++;
@@ -225,44 +152,28 @@ int main(int argc, char** argv, char** env) {
                     quit = 1;
                     break;
                 default:
-                    mvprintw(8,0,"unknown key press: 0x%03x\n", c);
+                    if (c == KEY_ENTER)
+                        c = '\n';
+                    if (c == KEY_BACKSPACE)
+                        c = '\b';
+                    if (!key_name(c))
+                        mvprintw(8,0,"unknown key press: 0x%03x\n", c);
+                    else if (TYPEAHEAD_NOW(c)) {
+                        typeahead_now(&q, &s, c);
+                        mvprintw(8,0,"key press: %s\n", key_name(c));
+                    }
+                    else if (typeahead_put(&q, c) < 0)
+                        mvprintw(8,0,"type-ahead full, %s dropped\n", key_name(c));
                     break;
             }
         }
 
-        if (valid_press) {
-            valid_press = 0;
-            key_processed = 0;
-            t_event = i + KEY_DELAY;
-        }
-
-        if (!key_processed && (t_event == i)) {
-            key_processed = 1;
+        c = typeahead_cycle(&q, &s);
+        if (c > 0)
+            mvprintw(8,0,"key press: %s (%u queued)\n", key_name(c), typeahead_pending(&q));
+        else if (c < 0) {
             move(8,0);
             printw("\n");
-            top->key_of_lock = 0;
-            top->key_chg_sign = 0;
-            top->key_repeat = 0;
-            top->key_div = 0;
-            top->key_clr_ent = 0;
-            top->key_enter = 0;
-            top->key_mult = 0;
-            top->key_clr_all = 0;
-            top->key_sub = 0;
-            top->key_add = 0;
-            top->key_store = 0;
-            top->key_recall = 0;
-            top->key_dp = 0;
-            top->key_0 = 0;
-            top->key_1 = 0;
-            top->key_2 = 0;
-            top->key_3 = 0;
-            top->key_4 = 0;
-            top->key_5 = 0;
-            top->key_6 = 0;
-            top->key_7 = 0;
-            top->key_8 = 0;
-            top->key_9 = 0;
         }
 
         move(10,0);
@@ -312,12 +223,21 @@ int main(int argc, char** argv, char** env) {
         print_reg(top->reg_0, top->sw_dp);
         print_reg(top->reg_s, top->sw_dp);
 
-        for (int clk = 0; clk < 2; clk++) {
-#if VM_TRACE
-            tfp->dump(10*i + 5*clk);
-#endif
-            top->clk = clk;
-            top->eval();
+        sim_cycle(&s);
+
+        // with +realtime, keep to the speed of the real machine, and
+        // once it's idle, wait for a key instead of running it
+        if (rt.on) {
+            if (realtime_idle(&rt, &s, &q)) {
+                refresh();
+                realtime_poll(-1, q.fd);
+                realtime_resume(&rt, &s);
+            }
+            else {
+                int64_t us = realtime_delay(&rt, &s);
+                if (us)
+                    realtime_poll(us, -1);
+            }
         }
     }
 
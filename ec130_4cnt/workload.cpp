@@ -0,0 +1,26 @@
+// Friden EC-130 (4 counter) standard batch workload
+// touches every operation at least once; used for profiling
+
+#include <stddef.h>
+#include "batch.h"
+
+const batch_op batch_workload[] = {
+    {"clear",    "c"},
+    {"entry",    "1234.5678"},
+    {"enter",    "\n"},
+    {"entry",    "87.65"},
+    {"add",      "+"},
+    {"entry",    "3"},
+    {"sub",      "-"},
+    {"entry",    "12.5"},
+    {"mult",     "*"},
+    {"entry",    "7"},
+    {"div",      "/"},
+    {"store",    "t"},
+    {"chg_sign", "s"},
+    {"repeat",   "r"},
+    {"recall",   "e"},
+    {"entry",    "42"},
+    {"clr_ent",  "\b"},
+    {NULL,       NULL}
+};
@@ -0,0 +1,171 @@
+// Friden EC-130 display DACs
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "Vtop.h"
+#include "sim.h"
+#include "spsc_ring.h"
+#include "display.h"
+#include "dac.h"
+
+// one sample of the three DAC outputs, as written (on a little endian
+// host, which is what WAV and the raw format want)
+struct dac_frame_t {
+    int16_t x, y, z;
+};
+
+// frames between the simulation and the writer: about a third of a
+// second at the default rate
+#define DAC_RING (1 << 16)
+
+int dac_on = 0;
+
+static FILE *out;
+static int wav;
+static uint64_t rate;
+static spsc_ring<dac_frame_t, DAC_RING> *ring;
+static std::thread writer;
+static std::atomic<int> stopping;
+static uint64_t written;
+static uint64_t dropped;
+
+// the decimator: the beam position summed over the cycles of a sample
+static uint64_t phase;
+static double sum_x, sum_y, sum_z;
+static int cycles;
+
+// cycles the segment generator has run since the beam was last blanked
+static int seg_count;
+
+static void put16(uint16_t v) {
+    putc(v & 0xff, out);
+    putc(v >> 8, out);
+}
+
+static void put32(uint32_t v) {
+    put16(v & 0xffff);
+    put16(v >> 16);
+}
+
+// a 3 channel, 16 bit PCM header; the sizes are filled in by dac_stop()
+static void wav_header(uint32_t frames) {
+    uint32_t bytes = frames * sizeof(dac_frame_t);
+    fwrite("RIFF", 4, 1, out);
+    put32(36 + bytes);
+    fwrite("WAVEfmt ", 8, 1, out);
+    put32(16);
+    put16(1); // PCM
+    put16(3);
+    put32(rate);
+    put32(rate * sizeof(dac_frame_t));
+    put16(sizeof(dac_frame_t));
+    put16(16);
+    fwrite("data", 4, 1, out);
+    put32(bytes);
+}
+
+static void write_frames() {
+    static dac_frame_t buf[4096];
+    for (;;) {
+        // checked before popping, so nothing pushed before the stop is lost
+        int stop = stopping.load(std::memory_order_acquire);
+        size_t n = ring->pop(buf, sizeof(buf) / sizeof(buf[0]));
+        if (n) {
+            fwrite(buf, sizeof(dac_frame_t), n, out);
+            written += n;
+            continue;
+        }
+        if (stop)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+int dac_start(const char *filename) {
+    if (!filename || !*filename || dac_on)
+        return 0;
+
+    const char *arg = sim_plusarg("dac_rate");
+    rate = arg ? strtoull(arg, NULL, 0) : DAC_RATE;
+    if (!rate || rate > DAC_CLOCK) {
+        fprintf(stderr, "+dac_rate+ must be between 1 and %d\n", DAC_CLOCK);
+        return -1;
+    }
+
+    // a named pipe blocks here until its reader opens it
+    out = fopen(filename, "wb");
+    if (!out) {
+        perror(filename);
+        return -1;
+    }
+    size_t len = strlen(filename);
+    wav = len > 4 && !strcmp(filename + len - 4, ".wav");
+    if (wav)
+        wav_header(0);
+
+    ring = new spsc_ring<dac_frame_t, DAC_RING>;
+    stopping = 0;
+    writer = std::thread(write_frames);
+    dac_on = 1;
+    atexit(dac_stop);
+    return 0;
+}
+
+void dac_stop() {
+    if (!dac_on)
+        return;
+    dac_on = 0;
+    stopping.store(1, std::memory_order_release);
+    writer.join();
+
+    if (wav && !fseek(out, 0, SEEK_SET))
+        wav_header(written);
+    fclose(out);
+    delete ring;
+    if (dropped)
+        fprintf(stderr, "dac: %lu samples dropped, as the writer fell behind\n", dropped);
+}
+
+void dac_cycle(Vtop *top) {
+    // the beam sits at the start of the segment while blanked, and the
+    // segment generator then sweeps it along it, as display.c draws it
+    if (top->blank)
+        seg_count = 0;
+    else if (top->seg_gen)
+        seg_count++;
+    double len = seg_count / 48.0;
+    double v = V_LUT[top->v_dot > 2 ? 2 : top->v_dot];
+    double h = H_LUT[top->h_dot > 2 ? 2 : top->h_dot];
+    if (top->v_seg)
+        v -= len;
+    else
+        h -= len;
+
+    sum_x += top->shift1 * SHIFT_1 + top->shift7 * SHIFT_7 +
+             (13 - top->h_staircase) * H_SPACING + h * H_SCALE + SLANT_FACTOR * v * V_SCALE;
+    sum_y += top->v_staircase * V_SPACING + v * V_SCALE;
+    sum_z += !top->blank;
+    cycles++;
+
+    // a sample every DAC_CLOCK / rate cycles, on average, of the beam
+    // averaged over them
+    phase += rate;
+    if (phase < DAC_CLOCK)
+        return;
+    phase -= DAC_CLOCK;
+
+    // the window display.c sets up, -15 to 145 by -8 to 72, at full scale
+    dac_frame_t f;
+    f.x = (int16_t)((sum_x / cycles - 65.0) / 80.0 * 32767);
+    f.y = (int16_t)((sum_y / cycles - 32.0) / 40.0 * 32767);
+    f.z = (int16_t)(sum_z / cycles * 32767);
+    if (!ring->push(f))
+        dropped++;
+    sum_x = sum_y = sum_z = 0;
+    cycles = 0;
+}
@@ -0,0 +1,40 @@
+// Friden EC-130 display DACs
+// turns the display outputs of the model (staircases, dots, segment
+// generator and blanking) into the X, Y and Z (beam on) voltages an
+// oscilloscope in X-Y mode would be driven with, and streams them as
+// 16 bit samples at a fixed rate of simulated time, so the sample rate
+// doesn't depend on how fast the simulation runs
+//
+// the samples go through a lock-free ring to a writer thread, which
+// writes them to +dac+<file>: a WAV file if it ends in .wav, raw
+// interleaved 16 bit little endian X, Y, Z otherwise, which can be a
+// named pipe read by a vector display emulator; if the writer falls
+// behind, samples are dropped (and counted) rather than slowing the
+// simulation down
+
+#ifndef DAC_H
+#define DAC_H
+
+class Vtop;
+
+// samples per second of simulated time, unless given by +dac_rate+<Hz>
+#define DAC_RATE 192000
+
+// the master clock, 8x TOSC4
+#define DAC_CLOCK 2666667
+
+// set while samples are being written
+extern int dac_on;
+
+// starts writing samples to filename (from +dac+<file>); does nothing if
+// filename is NULL
+// returns -1 if the file can't be opened
+int dac_start(const char *filename);
+
+// flushes and closes the output; called at exit
+void dac_stop();
+
+// called every cycle
+void dac_cycle(Vtop *top);
+
+#endif
@@ -0,0 +1,230 @@
+// Friden EC-130 key to display latency
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "latency.h"
+
+// what happens to a key, in order; each stage runs from one to the next
+enum {
+    LAT_KEY, // typed
+    LAT_PRESS, // pressed by the type-ahead queue
+    LAT_ACK, // acknowledged
+    LAT_REG, // registers changed
+    LAT_SEG, // first segment drawn from them
+    LAT_SWAP, // and swapped in
+    LAT_EVENTS
+};
+
+#define LAT_STAGES (LAT_EVENTS - 1)
+
+static const char *stage_names[LAT_STAGES] = {"queued", "ack", "compute", "scan", "swap"};
+
+// the registers the display shows, as decoded
+#define LAT_REGS (6 * 16)
+
+struct latency_key_t {
+    int key;
+    unsigned seq; // number in the type-ahead queue
+    int reached; // last of the events it has got to
+    uint64_t cycle[LAT_EVENTS];
+    int64_t us[LAT_EVENTS];
+    uint8_t regs[LAT_REGS]; // as they were when it was pressed
+};
+
+int latency_on = 0;
+
+static FILE *out;
+static std::chrono::steady_clock::time_point start;
+
+static std::deque<latency_key_t> typed; // and not yet pressed
+static std::vector<latency_key_t> pressed; // and not yet on screen
+
+static std::vector<int64_t> stage_us[LAT_STAGES], stage_cycles[LAT_STAGES];
+static std::vector<int64_t> total_us, total_cycles;
+static uint64_t unchanged; // keys that never changed the registers
+static uint64_t dropped; // keys dropped from the queue by CLEAR ALL or OVERFLOW LOCK
+
+static void read_regs(Vtop *top, uint8_t *regs) {
+    memcpy(regs, &top->reg_4[0], 16);
+    memcpy(regs + 16, &top->reg_3[0], 16);
+    memcpy(regs + 32, &top->reg_2[0], 16);
+    memcpy(regs + 48, &top->reg_1[0], 16);
+    memcpy(regs + 64, &top->reg_0[0], 16);
+    memcpy(regs + 80, &top->reg_s[0], 16);
+}
+
+static void mark(latency_key_t &k, int event, sim_t *s) {
+    k.reached = event;
+    k.cycle[event] = s->cycle;
+    k.us[event] = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+int latency_start() {
+    if (!sim_plusflag("latency"))
+        return 0;
+    const char *filename = sim_plusarg("latency");
+    if (filename && *filename) {
+        out = fopen(filename, "w");
+        if (!out) {
+            perror(filename);
+            return -1;
+        }
+        fprintf(out, "key");
+        for (int i = 0; i < LAT_STAGES; i++)
+            fprintf(out, ",%s_us", stage_names[i]);
+        fprintf(out, ",total_us");
+        for (int i = 0; i < LAT_STAGES; i++)
+            fprintf(out, ",%s_cycles", stage_names[i]);
+        fprintf(out, ",total_cycles\n");
+    }
+    start = std::chrono::steady_clock::now();
+    latency_on = 1;
+    atexit(latency_stop);
+    return 0;
+}
+
+// nearest rank
+static int64_t percentile(std::vector<int64_t> v, double p) {
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)(p * v.size() + 0.999999);
+    return v[rank ? rank - 1 : 0];
+}
+
+void latency_stop() {
+    if (!latency_on)
+        return;
+    latency_on = 0;
+    if (out)
+        fclose(out);
+
+    unchanged += pressed.size();
+    fprintf(stderr, "latency: %zu keys shown, %lu changed nothing, %lu dropped\n",
+            total_us.size(), unchanged, dropped);
+    if (total_us.empty())
+        return;
+    fprintf(stderr, "%-8s %10s %10s %12s %12s\n", "stage", "p50 ms", "p99 ms",
+            "p50 cycles", "p99 cycles");
+    for (int i = 0; i <= LAT_STAGES; i++) {
+        std::vector<int64_t> &us = i < LAT_STAGES ? stage_us[i] : total_us;
+        std::vector<int64_t> &cycles = i < LAT_STAGES ? stage_cycles[i] : total_cycles;
+        fprintf(stderr, "%-8s %10.3f %10.3f %12ld %12ld\n",
+                i < LAT_STAGES ? stage_names[i] : "total",
+                percentile(us, 0.5) / 1000.0, percentile(us, 0.99) / 1000.0,
+                percentile(cycles, 0.5), percentile(cycles, 0.99));
+    }
+}
+
+static void shown(latency_key_t &k) {
+    for (int i = 0; i < LAT_STAGES; i++) {
+        stage_us[i].push_back(k.us[i + 1] - k.us[i]);
+        stage_cycles[i].push_back(k.cycle[i + 1] - k.cycle[i]);
+    }
+    total_us.push_back(k.us[LAT_SWAP] - k.us[LAT_KEY]);
+    total_cycles.push_back(k.cycle[LAT_SWAP] - k.cycle[LAT_KEY]);
+
+    if (!out)
+        return;
+    fprintf(out, "%s", key_name(k.key));
+    for (int i = 0; i < LAT_STAGES; i++)
+        fprintf(out, ",%ld", k.us[i + 1] - k.us[i]);
+    fprintf(out, ",%ld", k.us[LAT_SWAP] - k.us[LAT_KEY]);
+    for (int i = 0; i < LAT_STAGES; i++)
+        fprintf(out, ",%lu", k.cycle[i + 1] - k.cycle[i]);
+    fprintf(out, ",%lu\n", k.cycle[LAT_SWAP] - k.cycle[LAT_KEY]);
+}
+
+static void press(latency_key_t &k, sim_t *s) {
+    // keys before it that never changed the registers won't now
+    for (size_t i = 0; i < pressed.size(); ) {
+        if (pressed[i].reached < LAT_REG) {
+            unchanged++;
+            pressed.erase(pressed.begin() + i);
+        }
+        else
+            i++;
+    }
+    mark(k, LAT_PRESS, s);
+    read_regs(s->top, k.regs);
+    pressed.push_back(k);
+}
+
+void latency_key(sim_t *s, int c, unsigned seq) {
+    latency_key_t k;
+    k.key = c;
+    k.seq = seq;
+    mark(k, LAT_KEY, s);
+    typed.push_back(k);
+}
+
+void latency_now(sim_t *s, int c) {
+    dropped += typed.size();
+    typed.clear();
+    latency_key_t k;
+    k.key = c;
+    k.seq = 0;
+    mark(k, LAT_KEY, s);
+    press(k, s);
+}
+
+// true if k got to its next event on this cycle
+static int next(latency_key_t &k, sim_t *s, const uint8_t *regs) {
+    Vtop *top = s->top;
+    switch (k.reached) {
+        case LAT_PRESS:
+            if (!top->kbd_ack && !memcmp(regs, k.regs, LAT_REGS))
+                return 0;
+            break;
+        case LAT_ACK:
+            if (!memcmp(regs, k.regs, LAT_REGS))
+                return 0;
+            break;
+        case LAT_REG:
+            if (!top->seg_samp)
+                return 0;
+            break;
+        case LAT_SEG:
+            // a segment sampled as the screen is erased goes to the next
+            // frame, so the swap has to come after it
+            if (!top->erase || k.cycle[LAT_SEG] == s->cycle)
+                return 0;
+            break;
+        default:
+            return 0;
+    }
+    mark(k, k.reached + 1, s);
+    return 1;
+}
+
+void latency_cycle(sim_t *s, int c, unsigned seq) {
+    // keys from +typein+ aren't followed, and don't match
+    if (c > 0 && !typed.empty() && typed.front().seq == seq) {
+        press(typed.front(), s);
+        typed.pop_front();
+    }
+    if (pressed.empty())
+        return;
+
+    uint8_t regs[LAT_REGS];
+    read_regs(s->top, regs);
+    for (size_t i = 0; i < pressed.size(); ) {
+        while (next(pressed[i], s, regs))
+            ;
+        if (pressed[i].reached == LAT_SWAP) {
+            shown(pressed[i]);
+            pressed.erase(pressed.begin() + i);
+        }
+        else
+            i++;
+    }
+}
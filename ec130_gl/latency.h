@@ -0,0 +1,50 @@
+// Friden EC-130 key to display latency
+// with +latency, follows each key typed into the window through to the
+// frame that shows what it did, timing each stage in cycles and in
+// wall clock time:
+//  - queued: the key callback, until the type-ahead queue presses it
+//  - ack: until the keyboard acknowledges it (kbd_ack); keys that aren't
+//    acknowledged, like CLEAR ALL, count as acked when the registers
+//    change
+//  - compute: until the decoded registers first change
+//  - scan: until the display next samples a segment (seg_samp), which
+//    draws from the new contents
+//  - swap: until the frame being drawn is swapped in (erase)
+// and prints the median and 99th percentile of each, and of the whole,
+// at exit; with +latency+<file>, each key is also written to <file> as
+// a line of CSV
+//
+// keys that change nothing on the display never get past compute, and
+// are counted separately once the next key is pressed
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+class Vtop;
+struct sim_t;
+
+// set while keys are being followed
+extern int latency_on;
+
+// starts following keys if +latency was given, writing them to the
+// file given with +latency+<file>, if any
+// returns -1 if the file can't be written
+int latency_start();
+
+// prints the summary and closes the file; called at exit
+void latency_stop();
+
+// key c (as in keys.h) was typed and queued, as number seq in the
+// type-ahead queue
+void latency_key(sim_t *s, int c, unsigned seq);
+
+// key c was typed and pressed straight away, dropping the queued keys
+void latency_now(sim_t *s, int c);
+
+// called every cycle, after typeahead_cycle(), with what it returned
+// and the number of the key it last pressed (q->last); keys are matched
+// by number, so keys queued from +typein+ in between aren't taken for
+// the ones typed
+void latency_cycle(sim_t *s, int pressed, unsigned seq);
+
+#endif
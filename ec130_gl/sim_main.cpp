@@ -4,25 +4,50 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory>
+#include <unistd.h>
 #include <verilated_vcd_c.h>
 #include "Vtop.h"
 
 #include <GL/glut.h>
 
 #include "display.h"
+#include "sim.h"
+#include "keys.h"
+#include "batch.h"
+#include "scenario.h"
+#include "snapshot.h"
+#include "metrics.h"
+#include "engine.h"
+#include "shm.h"
+#include "dltrace.h"
+#include "lockstep.h"
+#include "typeahead.h"
+#include "dac.h"
+#include "realtime.h"
+#include "trace_writer.h"
+#include "latency.h"
 
-#define KEY_DELAY 50000UL
-uint64_t t_event;
-int valid_press = 0;
-int key_processed = 1;
 int quit = 0;
-uint64_t i = 0;
 Vtop *top;
+sim_t s;
+typeahead_t q;
+realtime_t rt;
+int parked = 0;
 
 #if VM_TRACE
 VerilatedVcdC* tfp;
 #endif
 
+// runs the model again after it was parked
+void wake()
+{
+    if (!parked)
+        return;
+    parked = 0;
+    realtime_resume(&rt, &s);
+    glutPostRedisplay();
+}
+
 void display(void)
 {
     if (quit) {
@@ -35,13 +60,12 @@ void display(void)
         exit(0);
     }
 
-    for (int clk = 0; clk < 2; clk++) {
-#if VM_TRACE
-        tfp->dump(10*i + 5*clk);
-#endif
-        top->clk = clk;
-        top->eval();
-    }
+    // while parked, only when uncovered, say
+    wake();
+
+    sim_cycle(&s);
+    if (dac_on)
+        dac_cycle(top);
 
     // do display stuff, like:
     //  - draw segments
@@ -49,40 +73,25 @@ void display(void)
     display_helper(top->erase, top->seg_samp, top->v_staircase, top->h_staircase, 
                    top->v_dot, top->h_dot, top->v_seg, top->seg_len, top->shift1, top->shift7);
 
-    if (valid_press) {
-        valid_press = 0;
-        key_processed = 0;
-        t_event = i + KEY_DELAY;
+    int c = typeahead_cycle(&q, &s);
+    if (latency_on)
+        latency_cycle(&s, c, q.last);
+
+    // with +realtime, keep to the speed of the real machine, and once
+    // it's idle, stop redrawing until a key comes in; that's just after
+    // a frame has been swapped in, so the display stays up meanwhile
+    // (keys from +typein+ can't wake it, so it keeps going while they
+    // may come)
+    if (rt.on) {
+        if (realtime_idle(&rt, &s, &q) && top->erase && q.fd < 0) {
+            parked = 1;
+            return;
+        }
+        int64_t us = realtime_delay(&rt, &s);
+        if (us)
+            usleep(us);
     }
 
-    if (!key_processed && (t_event == i)) {
-        key_processed = 1;
-        top->key_of_lock = 0;
-        top->key_chg_sign = 0;
-        top->key_repeat = 0;
-        top->key_div = 0;
-        top->key_clr_ent = 0;
-        top->key_enter = 0;
-        top->key_mult = 0;
-        top->key_clr_all = 0;
-        top->key_sub = 0;
-        top->key_add = 0;
-        top->key_store = 0;
-        top->key_recall = 0;
-        top->key_dp = 0;
-        top->key_0 = 0;
-        top->key_1 = 0;
-        top->key_2 = 0;
-        top->key_3 = 0;
-        top->key_4 = 0;
-        top->key_5 = 0;
-        top->key_6 = 0;
-        top->key_7 = 0;
-        top->key_8 = 0;
-        top->key_9 = 0;
-    }
-
-    i++;
     glutPostRedisplay();
 }
 
@@ -100,95 +109,27 @@ void keyboard_sf(int key, int x, int y)
         default:
             break;
     }
+    wake();
 }
 
 void keyboard(unsigned char key, int x, int y)
 {
-    // lock out everything but clear all, overflow lock, and quit
-    if (top->kbd_lock && ((key != 'c') && (key != 'o') && (key != 'q')))
-        return;
-
-    valid_press = 1;
+    // keys wait in the type-ahead queue until the machine takes them,
+    // but clear all and overflow lock go in straight away
     switch (key) {
-        case '0':
-            top->key_0 = 1;
-            break;
-        case '1':
-            top->key_1 = 1;
-            break;
-        case '2':
-            top->key_2 = 1;
-            break;
-        case '3':
-            top->key_3 = 1;
-            break;
-        case '4':
-            top->key_4 = 1;
-            break;
-        case '5':
-            top->key_5 = 1;
-            break;
-        case '6':
-            top->key_6 = 1;
-            break;
-        case '7':
-            top->key_7 = 1;
-            break;
-        case '8':
-            top->key_8 = 1;
-            break;
-        case '9':
-            top->key_9 = 1;
-            break;
-        case '\r':
-        case '\n':
-            top->key_enter = 1;
-            break;
-        case 0x7F:
-        case '\b':
-            top->key_clr_ent = 1;
-            break;
-        case 'c':
-            top->key_clr_all = 1;
-            break;
-        case '.':
-            top->key_dp = 1;
-            break;
-        case 's':
-            top->key_chg_sign = 1;
-            break;
-        case 'r':
-            top->key_repeat = 1;
-            break;
-        case 'o':
-            top->key_of_lock = 1;
-            break;
-        case 't':
-            top->key_store = 1;
-            break;
-        case 'e':
-            top->key_recall = 1;
-            break;
-        case '*':
-            top->key_mult = 1;
-            break;
-        case '/':
-            top->key_div = 1;
-            break;
-        case '+':
-            top->key_add = 1;
-            break;
-        case '-':
-            top->key_sub = 1;
-            break;
         case 'q':
-            valid_press = 0;
             quit = 1;
             break;
         default:
-            valid_press = 0;
+            if (TYPEAHEAD_NOW(key)) {
+                if (typeahead_now(&q, &s, key) && latency_on)
+                    latency_now(&s, key);
+            }
+            else if (typeahead_put(&q, key) > 0 && latency_on)
+                latency_key(&s, key, q.tail - 1);
             break;
     }
+    wake();
 }
 
 int main(int argc, char** argv, char** env) {
@@ -198,46 +139,69 @@ int main(int argc, char** argv, char** env) {
     Verilated::randReset(2);
     Verilated::traceEverOn(true);
     Verilated::commandArgs(argc, argv);
+    // +scenario+<names> runs tests headlessly, as batch mode does, and
+    // so does +dltrace_replay+<file>
+    const char *scenario = sim_plusarg("scenario");
+    const char *replay = sim_plusarg("dltrace_replay");
+    int batch = sim_plusflag("batch") || scenario || replay;
+    metrics_start(sim_plusarg("metrics"));
+    if (shm_start(sim_plusarg("shm")) || dltrace_start(sim_plusarg("dltrace")))
+        exit(1);
+    // before the model is created, as the check starts it from reset
+    if (lockstep_start(sim_plusarg("lockstep")))
+        exit(1);
 
     top = new Vtop;
 
 #if VM_TRACE
 	const char* flag = Verilated::commandArgsPlusMatch("trace");
     if (flag && 0 == strcmp(flag, "+trace")) {
-		tfp = new VerilatedVcdC;
-		top->trace(tfp, 99);
-		tfp->open("logs/trace.vcd");
+		tfp = trace_open(top, "logs/trace.vcd");
 	}
 #endif
 	VL_PRINTF("starting simulation...\n");
 
-    top->key_of_lock = 0;
-    top->key_chg_sign = 0;
-    top->key_repeat = 0;
-    top->key_div = 0;
-    top->key_clr_ent = 0;
-    top->key_enter = 0;
-    top->key_mult = 0;
-    top->key_clr_all = 0;
-    top->key_sub = 0;
-    top->key_add = 0;
-    top->key_store = 0;
-    top->key_recall = 0;
-    top->key_dp = 0;
-    top->key_0 = 0;
-    top->key_1 = 0;
-    top->key_2 = 0;
-    top->key_3 = 0;
-    top->key_4 = 0;
-    top->key_5 = 0;
-    top->key_6 = 0;
-    top->key_7 = 0;
-    top->key_8 = 0;
-    top->key_9 = 0;
+    key_release_all(top);
     top->sw_dp = 5;
 
     top->eval();
 
+    // start out cleared and idle if given a power-on image
+    if (snapshot_poweron(top)) {
+        fprintf(stderr, "can't read power-on image %s\n", sim_plusarg("poweron"));
+        exit(1);
+    }
+
+    if (batch) {
+#if VM_TRACE
+        int status = replay ? dltrace_replay(top, tfp, replay) :
+                     scenario ? scenario_main(top, tfp, scenario) : batch_main(top, tfp);
+        if (tfp)
+            tfp->close();
+#else
+        int status = replay ? dltrace_replay(top, nullptr, replay) :
+                     scenario ? scenario_main(top, nullptr, scenario) : batch_main(top, nullptr);
+#endif
+        top->final();
+        exit(status);
+    }
+
+    sim_init(&s, top);
+#if VM_TRACE
+    s.tfp = tfp;
+#endif
+    if (engine_arg() == ENGINE_FUNC)
+        s.engine = engine_new(top);
+    s.keyhold = sim_keyhold_arg(KEYHOLD_ADAPTIVE);
+    typeahead_init(&q);
+    if (typeahead_open(&q, sim_plusarg("typein")))
+        exit(1);
+    realtime_init(&rt, &s);
+    if (dac_start(sim_plusarg("dac")))
+        exit(1);
+    if (latency_start())
+        exit(1);
+
     glutInit(&argc, argv);
     init();
     glutKeyboardFunc(keyboard);
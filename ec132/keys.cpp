@@ -0,0 +1,126 @@
+// Friden EC-132 key mapping
+
+#include <stddef.h>
+#include "Vtop.h"
+#include "keys.h"
+
+int key_press(Vtop *top, int c) {
+    switch (c) {
+        case '0': top->key_0 = 1; break;
+        case '1': top->key_1 = 1; break;
+        case '2': top->key_2 = 1; break;
+        case '3': top->key_3 = 1; break;
+        case '4': top->key_4 = 1; break;
+        case '5': top->key_5 = 1; break;
+        case '6': top->key_6 = 1; break;
+        case '7': top->key_7 = 1; break;
+        case '8': top->key_8 = 1; break;
+        case '9': top->key_9 = 1; break;
+        case '\n':
+        case '\r':
+        case '=': top->key_enter = 1; break;
+        case '\b':
+        case 0x7f: top->key_clr_ent = 1; break;
+        case 'd': top->key_clr_disp = 1; break;
+        case 'c': top->key_clr_all = 1; break;
+        case '.': top->key_dp = 1; break;
+        case 's': top->key_chg_sign = 1; break;
+        case 'r': top->key_repeat = 1; break;
+        case 'o': top->key_of_lock = 1; break;
+        case 't': top->key_store = 1; break;
+        case 'e': top->key_recall = 1; break;
+        case '*': top->key_mult = 1; break;
+        case '/': top->key_div = 1; break;
+        case '+': top->key_add = 1; break;
+        case '-': top->key_sub = 1; break;
+        case 'q': top->key_sqrt = 1; break;
+        default: return 0;
+    }
+    return 1;
+}
+
+void key_release_all(Vtop *top) {
+    top->key_of_lock = 0;
+    top->key_clr_disp = 0;
+    top->key_chg_sign = 0;
+    top->key_repeat = 0;
+    top->key_div = 0;
+    top->key_clr_ent = 0;
+    top->key_enter = 0;
+    top->key_mult = 0;
+    top->key_clr_all = 0;
+    top->key_sub = 0;
+    top->key_add = 0;
+    top->key_store = 0;
+    top->key_recall = 0;
+    top->key_sqrt = 0;
+    top->key_dp = 0;
+    top->key_0 = 0;
+    top->key_1 = 0;
+    top->key_2 = 0;
+    top->key_3 = 0;
+    top->key_4 = 0;
+    top->key_5 = 0;
+    top->key_6 = 0;
+    top->key_7 = 0;
+    top->key_8 = 0;
+    top->key_9 = 0;
+}
+
+int key_down(Vtop *top) {
+    if (top->key_0) return '0';
+    if (top->key_1) return '1';
+    if (top->key_2) return '2';
+    if (top->key_3) return '3';
+    if (top->key_4) return '4';
+    if (top->key_5) return '5';
+    if (top->key_6) return '6';
+    if (top->key_7) return '7';
+    if (top->key_8) return '8';
+    if (top->key_9) return '9';
+    if (top->key_enter) return '\n';
+    if (top->key_clr_ent) return '\b';
+    if (top->key_clr_all) return 'c';
+    if (top->key_clr_disp) return 'd';
+    if (top->key_dp) return '.';
+    if (top->key_chg_sign) return 's';
+    if (top->key_repeat) return 'r';
+    if (top->key_of_lock) return 'o';
+    if (top->key_store) return 't';
+    if (top->key_recall) return 'e';
+    if (top->key_mult) return '*';
+    if (top->key_div) return '/';
+    if (top->key_add) return '+';
+    if (top->key_sub) return '-';
+    if (top->key_sqrt) return 'q';
+    return 0;
+}
+
+const char *key_name(int c) {
+    static const char *digits[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+
+    switch (c) {
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return digits[c - '0'];
+        case '\n':
+        case '\r':
+        case '=': return "ENTER";
+        case '\b':
+        case 0x7f: return "CLEAR ENTRY";
+        case 'd': return "CLEAR DISPLAY";
+        case 'c': return "CLEAR ALL";
+        case '.': return "DECIMAL POINT";
+        case 's': return "CHANGE SIGN";
+        case 'r': return "REPEAT";
+        case 'o': return "OVERFLOW LOCK";
+        case 't': return "STORE";
+        case 'e': return "RECALL";
+        case '*': return "MUL";
+        case '/': return "DIV";
+        case '+': return "ADD";
+        case '-': return "SUB";
+        case 'q': return "SQUARE ROOT";
+        default: return NULL;
+    }
+}
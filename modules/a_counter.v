@@ -0,0 +1,242 @@
+// Friden EC-130 A counter
+//
+// the A digit counter, the same in all the machines
+
+`include "clock.vh"
+
+module a_counter (
+    input clk,
+    input CIA9,
+    input CD51,
+    input SDA9,
+    input CD52,
+    input CRA9,
+    input CD41,
+    input CD42,
+    input CD31,
+    input CD32,
+    input CD21,
+    input CD22,
+    input ASA13,
+    input CD11,
+    input CD12,
+    input ARA13,
+    input TC13,
+    output CA41,
+    output CA42,
+    output CA51,
+    output CA52,
+    output CA31,
+    output CA32,
+    output CA21,
+    output CA22,
+    output CA11,
+    output CA12,
+    output CA94
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+wire s_1251, s_1252, r_1254, r_1253;
+ac AC_1251 (
+    .clk(clk),
+    .en(CA41),
+    .trans(CIA9),
+    .out(s_1251)
+);
+ac AC_1252 (
+    .clk(clk),
+    .en(CD51),
+    .trans(SDA9),
+    .out(s_1252)
+);
+ac AC_1254 (
+    .clk(clk),
+    .en(CD52),
+    .trans(SDA9),
+    .out(r_1254)
+);
+ac AC_1253 (
+    .clk(clk),
+    .en(CA42),
+    .trans(CIA9),
+    .out(r_1253)
+);
+ff A5_1250 (
+    .clk(clk),
+    .set_l(s_1251 | s_1252),
+    .rst_l(r_1254 | r_1253),
+    .set_p(1'b0),
+    .rst_p(CRA9),
+    .tog_p(1'b0),
+    .q(CA51),
+    .q_n(CA52)
+);
+
+wire s_1261, s_1262, r_1264, r_1263;
+ac AC_1261 (
+    .clk(clk),
+    .en(CA31),
+    .trans(CIA9),
+    .out(s_1261)
+);
+ac AC_1262 (
+    .clk(clk),
+    .en(CD41),
+    .trans(SDA9),
+    .out(s_1262)
+);
+ac AC_1264 (
+    .clk(clk),
+    .en(CD42),
+    .trans(SDA9),
+    .out(r_1264)
+);
+ac AC_1263 (
+    .clk(clk),
+    .en(CA32),
+    .trans(CIA9),
+    .out(r_1263)
+);
+ff A4_1260 (
+    .clk(clk),
+    .set_l(s_1261 | s_1262),
+    .rst_l(r_1264 | r_1263),
+    .set_p(1'b0),
+    .rst_p(CRA9),
+    .tog_p(1'b0),
+    .q(CA41),
+    .q_n(CA42)
+);
+
+wire s_1271, s_1272, r_1274, r_1273;
+ac AC_1271 (
+    .clk(clk),
+    .en(CA21),
+    .trans(CIA9),
+    .out(s_1271)
+);
+ac AC_1272 (
+    .clk(clk),
+    .en(CD31),
+    .trans(SDA9),
+    .out(s_1272)
+);
+ac AC_1274 (
+    .clk(clk),
+    .en(CD32),
+    .trans(SDA9),
+    .out(r_1274)
+);
+ac AC_1273 (
+    .clk(clk),
+    .en(CA22),
+    .trans(CIA9),
+    .out(r_1273)
+);
+ff A3_1270 (
+    .clk(clk),
+    .set_l(s_1271 | s_1272),
+    .rst_l(r_1274 | r_1273),
+    .set_p(1'b0),
+    .rst_p(CRA9),
+    .tog_p(1'b0),
+    .q(CA31),
+    .q_n(CA32)
+);
+
+wire s_1281, s_1282, r_1284, r_1283;
+ac AC_1281 (
+    .clk(clk),
+    .en(CA11),
+    .trans(CIA9),
+    .out(s_1281)
+);
+ac AC_1282 (
+    .clk(clk),
+    .en(CD21),
+    .trans(SDA9),
+    .out(s_1282)
+);
+ac AC_1284 (
+    .clk(clk),
+    .en(CD22),
+    .trans(SDA9),
+    .out(r_1284)
+);
+ac AC_1283 (
+    .clk(clk),
+    .en(CA12),
+    .trans(CIA9),
+    .out(r_1283)
+);
+ff A2_1280 (
+    .clk(clk),
+    .set_l(s_1281 | s_1282),
+    .rst_l(r_1284 | r_1283),
+    .set_p(1'b0),
+    .rst_p(CRA9),
+    .tog_p(1'b0),
+    .q(CA21),
+    .q_n(CA22)
+);
+
+wire s_1291, s_1293, s_1292, r_1295, r_1296, r_1294, r_1297;
+ac AC_1291 (
+    .clk(clk),
+    .en(ASA13),
+    .trans(CRA9),
+    .out(s_1291)
+);
+ac AC_1293 (
+    .clk(clk),
+    .en(CA52),
+    .trans(CIA9),
+    .out(s_1293)
+);
+ac AC_1292 (
+    .clk(clk),
+    .en(CD11),
+    .trans(SDA9),
+    .out(s_1292)
+);
+ac AC_1295 (
+    .clk(clk),
+    .en(CD12),
+    .trans(SDA9),
+    .out(r_1295)
+);
+ac AC_1296 (
+    .clk(clk),
+    .en(CA51),
+    .trans(CIA9),
+    .out(r_1296)
+);
+ac AC_1294 (
+    .clk(clk),
+    .en(ARA13),
+    .trans(CRA9),
+    .out(r_1294)
+);
+ac AC_1297 (
+    .clk(clk),
+    .en(TC13),
+    .trans(CA21),
+    .out(r_1297)
+);
+ff A1_1290 (
+    .clk(clk),
+    .set_l(s_1291 | s_1293 | s_1292),
+    .rst_l(r_1295 | r_1296 | r_1294 | r_1297),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CA11),
+    .q_n(CA12)
+);
+
+assign CA94 = CA52 | CA41;
+
+endmodule
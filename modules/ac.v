@@ -1,6 +1,8 @@
 // Friden EC-130 AC gate model
 // Kyle Owen - 22 June 2022
 
+`include "clock.vh"
+
 module ac (
     input clk,
     input en, // resistor input
@@ -8,10 +10,20 @@ module ac (
     output out
 );
 
+`ifdef FAULT_INJECT
+// the charge and a stuck-at output can be forced by the fault
+// campaign (sim/fault.cpp); bit 1 of stuck holds the output at bit 0
+reg [3:0] _cnt /*verilator public_flat_rw*/;
+/* verilator lint_off UNDRIVEN */
+reg [1:0] stuck /*verilator public_flat_rw*/;
+/* verilator lint_on UNDRIVEN */
+initial stuck = 2'b00;
+`else
 reg [3:0] _cnt;
+`endif
 
 // count thresholds arbitrarily chosen until they work...
-always @(posedge clk) begin
+always @(`CLK_EDGE) begin
     // if enable is high and transfer input is low...
     if (en && !trans) begin
         if (_cnt < 9) begin
@@ -27,6 +39,10 @@ end
 
 // output is high when capacitor is sufficiently charged
 // and transfer input is high
+`ifdef FAULT_INJECT
+assign out = stuck[1] ? stuck[0] : (trans && (_cnt > 3));
+`else
 assign out = (trans && (_cnt > 3));
+`endif
 
 endmodule
@@ -0,0 +1,46 @@
+// Friden EC-130 AC gate model, packed into one bank of N gates
+//
+// same behaviour as N separate ac instances, but the counters are kept
+// as four bit planes so each update is a handful of N-wide logic
+// operations instead of N separate 4-bit compares and adds; built by
+// tools/pack_banks, see `make PACKED=1`
+
+`include "clock.vh"
+
+module ac_bank #(
+    parameter N = 1
+) (
+    input clk,
+    input [N-1:0] en, // resistor inputs
+    input [N-1:0] trans, // capacitor inputs
+    output [N-1:0] charged // counter > 3; out is trans && charged
+);
+
+// counter bit planes: bit i of _c0.._c3 is the counter of gate i
+reg [N-1:0] _c0;
+reg [N-1:0] _c1;
+reg [N-1:0] _c2;
+reg [N-1:0] _c3;
+
+// charging, and the counter below 9 / above 0
+wire [N-1:0] up = en & ~trans;
+wire [N-1:0] lt9 = ~_c3 | ~(_c2 | _c1 | _c0);
+wire [N-1:0] gt0 = _c3 | _c2 | _c1 | _c0;
+
+// ripple the +1/-1 through the bit planes: bit k flips if all lower
+// bits were 1 when counting up, or all 0 when counting down
+wire [N-1:0] t0 = (up & lt9) | (~up & gt0);
+wire [N-1:0] t1 = t0 & ~(_c0 ^ up);
+wire [N-1:0] t2 = t1 & ~(_c1 ^ up);
+wire [N-1:0] t3 = t2 & ~(_c2 ^ up);
+
+always @(`CLK_EDGE) begin
+    _c0 <= _c0 ^ t0;
+    _c1 <= _c1 ^ t1;
+    _c2 <= _c2 ^ t2;
+    _c3 <= _c3 ^ t3;
+end
+
+assign charged = _c3 | _c2;
+
+endmodule
@@ -0,0 +1,245 @@
+// Friden EC-130 B counter
+//
+// the B digit counter of the 4-counter machines (ec130_4cnt, ec132)
+
+`include "clock.vh"
+
+module b_counter (
+    input clk,
+    input CA51,
+    input SAB9,
+    input CD51,
+    input SDB9,
+    input CD52,
+    input CA52,
+    input CA41,
+    input CD41,
+    input CD42,
+    input CA42,
+    input CA31,
+    input CD31,
+    input CD32,
+    input CA32,
+    input TFD1,
+    input CA21,
+    input CD21,
+    input CD22,
+    input CA22,
+    input TC13,
+    input CA11,
+    input CD11,
+    input CD12,
+    input CA12,
+    output CB51,
+    output CB52,
+    output CB41,
+    output CB42,
+    output CB31,
+    output CB32,
+    output CB22,
+    output CB21,
+    output CB11,
+    output CB12
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+`ifdef FOUR_COUNTERS
+wire s_1351, s_1352, r_1354, r_1353;
+ac AC_1351 (
+    .clk(clk),
+    .en(CA51),
+    .trans(SAB9),
+    .out(s_1351)
+);
+ac AC_1352 (
+    .clk(clk),
+    .en(CD51),
+    .trans(SDB9),
+    .out(s_1352)
+);
+ac AC_1354 (
+    .clk(clk),
+    .en(CD52),
+    .trans(SDB9),
+    .out(r_1354)
+);
+ac AC_1353 (
+    .clk(clk),
+    .en(CA52),
+    .trans(SAB9),
+    .out(r_1353)
+);
+ff B5_1350 (
+    .clk(clk),
+    .set_l(s_1351 | s_1352),
+    .rst_l(r_1354 | r_1353),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CB51),
+    .q_n(CB52)
+);
+
+wire s_1361, s_1362, r_1364, r_1363;
+ac AC_1361 (
+    .clk(clk),
+    .en(CA41),
+    .trans(SAB9),
+    .out(s_1361)
+);
+ac AC_1362 (
+    .clk(clk),
+    .en(CD41),
+    .trans(SDB9),
+    .out(s_1362)
+);
+ac AC_1364 (
+    .clk(clk),
+    .en(CD42),
+    .trans(SDB9),
+    .out(r_1364)
+);
+ac AC_1363 (
+    .clk(clk),
+    .en(CA42),
+    .trans(SAB9),
+    .out(r_1363)
+);
+ff B4_1360 (
+    .clk(clk),
+    .set_l(s_1361 | s_1362),
+    .rst_l(r_1364 | r_1363),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CB41),
+    .q_n(CB42)
+);
+
+wire s_1371, s_1372, r_1374, r_1373;
+ac AC_1371 (
+    .clk(clk),
+    .en(CA31),
+    .trans(SAB9),
+    .out(s_1371)
+);
+ac AC_1372 (
+    .clk(clk),
+    .en(CD31),
+    .trans(SDB9),
+    .out(s_1372)
+);
+ac AC_1374 (
+    .clk(clk),
+    .en(CD32),
+    .trans(SDB9),
+    .out(r_1374)
+);
+ac AC_1373 (
+    .clk(clk),
+    .en(CA32),
+    .trans(SAB9),
+    .out(r_1373)
+);
+ff B3_1370 (
+    .clk(clk),
+    .set_l(s_1371 | s_1372),
+    .rst_l(r_1374 | r_1373),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CB31),
+    .q_n(CB32)
+);
+
+wire o_194 = CB22 | TFD1;
+
+wire s_1381, s_1382, r_1384, r_1383, r_1385;
+ac AC_1381 (
+    .clk(clk),
+    .en(CA21),
+    .trans(SAB9),
+    .out(s_1381)
+);
+ac AC_1382 (
+    .clk(clk),
+    .en(CD21),
+    .trans(SDB9),
+    .out(s_1382)
+);
+ac AC_1384 (
+    .clk(clk),
+    .en(CD22),
+    .trans(SDB9),
+    .out(r_1384)
+);
+ac AC_1383 (
+    .clk(clk),
+    .en(CA22),
+    .trans(SAB9),
+    .out(r_1383)
+);
+ac AC_1385 (
+    .clk(clk),
+    .en(TC13),
+    .trans(o_194),
+    .out(r_1385)
+);
+ff B2_1380 (
+    .clk(clk),
+    .set_l(s_1381 | s_1382),
+    .rst_l(r_1384 | r_1383 | r_1385),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CB21),
+    .q_n(CB22)
+);
+
+wire s_1391, s_1392, r_1394, r_1393, r_1395;
+ac AC_1391 (
+    .clk(clk),
+    .en(CA11),
+    .trans(SAB9),
+    .out(s_1391)
+);
+ac AC_1392 (
+    .clk(clk),
+    .en(CD11),
+    .trans(SDB9),
+    .out(s_1392)
+);
+ac AC_1394 (
+    .clk(clk),
+    .en(CD12),
+    .trans(SDB9),
+    .out(r_1394)
+);
+ac AC_1393 (
+    .clk(clk),
+    .en(CA12),
+    .trans(SAB9),
+    .out(r_1393)
+);
+ac AC_1395 (
+    .clk(clk),
+    .en(CD12),
+    .trans(SDB9),
+    .out(r_1395)
+);
+ff B1_1390 (
+    .clk(clk),
+    .set_l(s_1391 | s_1392),
+    .rst_l(r_1394 | r_1393 | r_1395),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CB11),
+    .q_n(CB12)
+);
+`endif
+
+endmodule
@@ -0,0 +1,419 @@
+// Friden EC-130 C counter
+//
+// the C digit counter, and C1C4, which writes into the delay line; the
+// 4-counter machines (FOUR_COUNTERS) step it differently
+
+`include "clock.vh"
+
+// for the logic that only the 4-counter EC-130 has
+`ifdef FOUR_COUNTERS
+`ifndef EC132
+`define EC130_4CNT
+`endif
+`endif
+
+module c_counter (
+    input clk,
+    input CA51,
+    input SAC9,
+    input CA41,
+    input CA31,
+    input CA21,
+    input CA11,
+    input TFB2,
+    input TFC2,
+    input TFD2,
+    output CC11,
+    output CC51,
+    output CC41,
+    output CC31,
+    output CC21,
+`ifdef FOUR_COUNTERS
+    input CB51,
+    input SBC9,
+    input CB41,
+    input CB31,
+    input CB21,
+    input CB11,
+    input TCLK2,
+`else
+    input CD51,
+    input SDC9,
+    input CD41,
+    input CD31,
+    input CD21,
+    input CD22,
+    input CD11,
+    input TCLK3,
+`endif
+`ifdef EC130_4CNT
+    input CB52,
+    input CA52,
+    input CB42,
+    input CA42,
+    input CB32,
+    input CA32,
+    input CB22,
+    input CB12,
+    input CA12,
+    input TFB1,
+    input TFC1,
+    input TFD1,
+`endif
+`ifndef EC132
+    input CA22,
+`endif
+    output C1C4
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+`ifdef EC130_4CNT
+wire s_1403, s_1402, s_1401, r_1404, r_1405, r_1406;
+`else
+wire s_1403, s_1402, s_1401, r_1406;
+`endif
+ac AC_1403 (
+    .clk(clk),
+    .en(CC12),
+    .trans(C1C9),
+    .out(s_1403)
+);
+ac AC_1402 (
+    .clk(clk),
+    .en(CA51),
+    .trans(SAC9),
+    .out(s_1402)
+);
+ac AC_1401 (
+    .clk(clk),
+`ifndef FOUR_COUNTERS
+    .en(CD51),
+    .trans(SDC9),
+`else
+    .en(CB51),
+    .trans(SBC9),
+`endif
+    .out(s_1401)
+);
+`ifdef EC130_4CNT
+ac AC_1404 (
+    .clk(clk),
+    .en(CB52),
+    .trans(SBC9),
+    .out(r_1404)
+);
+ac AC_1405 (
+    .clk(clk),
+    .en(CA52),
+    .trans(SAC9),
+    .out(r_1405)
+);
+`endif
+ac AC_1406 (
+    .clk(clk),
+    .en(CC11),
+    .trans(C1C9),
+    .out(r_1406)
+);
+wire CC52;
+ff C5_1400 (
+    .clk(clk),
+    .set_l(s_1403 | s_1402 | s_1401),
+`ifdef EC130_4CNT
+    .rst_l(r_1404 | r_1405 | r_1406),
+`else
+    .rst_l(r_1406),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CC51),
+    .q_n(CC52)
+);
+
+`ifdef EC130_4CNT
+wire s_1413, s_1412, s_1411, r_1414, r_1415, r_1416;
+`else
+wire s_1413, s_1412, s_1411, r_1416;
+`endif
+ac AC_1413 (
+    .clk(clk),
+    .en(CC51),
+    .trans(C1C9),
+    .out(s_1413)
+);
+ac AC_1412 (
+    .clk(clk),
+    .en(CA41),
+    .trans(SAC9),
+    .out(s_1412)
+);
+ac AC_1411 (
+    .clk(clk),
+`ifndef FOUR_COUNTERS
+    .en(CD41),
+    .trans(SDC9),
+`else
+    .en(CB41),
+    .trans(SBC9),
+`endif
+    .out(s_1411)
+);
+`ifdef EC130_4CNT
+ac AC_1414 (
+    .clk(clk),
+    .en(CB42),
+    .trans(SBC9),
+    .out(r_1414)
+);
+ac AC_1415 (
+    .clk(clk),
+    .en(CA42),
+    .trans(SAC9),
+    .out(r_1415)
+);
+`endif
+ac AC_1416 (
+    .clk(clk),
+    .en(CC52),
+    .trans(C1C9),
+    .out(r_1416)
+);
+wire CC42;
+ff C4_1410 (
+    .clk(clk),
+    .set_l(s_1413 | s_1412 | s_1411),
+`ifdef EC130_4CNT
+    .rst_l(r_1414 | r_1415 | r_1416),
+`else
+    .rst_l(r_1416),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CC41),
+    .q_n(CC42)
+);
+
+`ifdef EC130_4CNT
+wire s_1423, s_1422, s_1421, r_1424, r_1425, r_1426;
+`else
+wire s_1423, s_1422, s_1421, r_1426;
+`endif
+ac AC_1423 (
+    .clk(clk),
+    .en(CC41),
+    .trans(C1C9),
+    .out(s_1423)
+);
+ac AC_1422 (
+    .clk(clk),
+    .en(CA31),
+    .trans(SAC9),
+    .out(s_1422)
+);
+ac AC_1421 (
+    .clk(clk),
+`ifndef FOUR_COUNTERS
+    .en(CD31),
+    .trans(SDC9),
+`else
+    .en(CB31),
+    .trans(SBC9),
+`endif
+    .out(s_1421)
+);
+`ifdef EC130_4CNT
+ac AC_1424 (
+    .clk(clk),
+    .en(CB32),
+    .trans(SBC9),
+    .out(r_1424)
+);
+ac AC_1425 (
+    .clk(clk),
+    .en(CA32),
+    .trans(SAC9),
+    .out(r_1425)
+);
+`endif
+ac AC_1426 (
+    .clk(clk),
+    .en(CC42),
+    .trans(C1C9),
+    .out(r_1426)
+);
+wire CC32;
+ff C3_1420 (
+    .clk(clk),
+    .set_l(s_1423 | s_1422 | s_1421),
+`ifdef EC130_4CNT
+    .rst_l(r_1424 | r_1425 | r_1426),
+`else
+    .rst_l(r_1426),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CC31),
+    .q_n(CC32)
+);
+
+`ifndef EC132
+wire s_1433, s_1432, s_1431, r_1434, r_1435, r_1436;
+`else
+wire s_1433, s_1432, s_1431, r_1436;
+`endif
+ac AC_1433 (
+    .clk(clk),
+    .en(CC31),
+    .trans(C1C9),
+    .out(s_1433)
+);
+ac AC_1432 (
+    .clk(clk),
+    .en(CA21),
+    .trans(SAC9),
+    .out(s_1432)
+);
+`ifndef FOUR_COUNTERS
+ac AC_1431 (
+    .clk(clk),
+    .en(CD21),
+    .trans(SDC9),
+    .out(s_1431)
+);
+ac AC_1434 (
+    .clk(clk),
+    .en(CD22),
+    .trans(SDC9),
+    .out(r_1434)
+);
+`else
+ac AC_1431 (
+    .clk(clk),
+    .en(CB21),
+    .trans(SBC9),
+    .out(s_1431)
+);
+`endif
+`ifdef EC130_4CNT
+ac AC_1434 (
+    .clk(clk),
+    .en(CB22),
+    .trans(SBC9),
+    .out(r_1434)
+);
+`endif
+`ifndef EC132
+ac AC_1435 (
+    .clk(clk),
+    .en(CA22),
+    .trans(SAC9),
+    .out(r_1435)
+);
+`endif
+ac AC_1436 (
+    .clk(clk),
+    .en(CC32),
+    .trans(C1C9),
+    .out(r_1436)
+);
+wire CC22;
+ff C2_1430 (
+    .clk(clk),
+    .set_l(s_1433 | s_1432 | s_1431),
+`ifndef EC132
+    .rst_l(r_1434 | r_1435 | r_1436),
+`else
+    .rst_l(r_1436),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CC21),
+    .q_n(CC22)
+);
+
+`ifdef EC130_4CNT
+wire s_1443, s_1442, s_1441, r_1444, r_1445, r_1446;
+`else
+wire s_1443, s_1442, s_1441, r_1446;
+`endif
+ac AC_1443 (
+    .clk(clk),
+    .en(CC21),
+    .trans(C1C9),
+    .out(s_1443)
+);
+ac AC_1442 (
+    .clk(clk),
+    .en(CA11),
+    .trans(SAC9),
+    .out(s_1442)
+);
+ac AC_1441 (
+    .clk(clk),
+`ifndef FOUR_COUNTERS
+    .en(CD11),
+    .trans(SDC9),
+`else
+    .en(CB11),
+    .trans(SBC9),
+`endif
+    .out(s_1441)
+);
+`ifdef EC130_4CNT
+ac AC_1444 (
+    .clk(clk),
+    .en(CB12),
+    .trans(SBC9),
+    .out(r_1444)
+);
+ac AC_1445 (
+    .clk(clk),
+    .en(CA12),
+    .trans(SAC9),
+    .out(r_1445)
+);
+`endif
+ac AC_1446 (
+    .clk(clk),
+    .en(CC22),
+    .trans(C1C9),
+    .out(r_1446)
+);
+wire CC12;
+ff C1_1440 (
+    .clk(clk),
+    .set_l(s_1443 | s_1442 | s_1441),
+`ifdef EC130_4CNT
+    .rst_l(r_1444 | r_1445 | r_1446),
+`else
+    .rst_l(r_1446),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CC11),
+    .q_n(CC12)
+);
+
+wire CCZ3 = !(CC51 | CC11);
+`ifdef EC130_4CNT
+wire TB013 = !(TFB1 | TFC1 | TFD1);
+`endif
+wire TBX3 = !(TFB2 | TFC2 | TFD2);
+`ifndef FOUR_COUNTERS
+assign C1C4 = !(CCZ3 | TBX3 | TCLK3);
+`elsif EC132
+assign C1C4 = !(CCZ3 | TBX3 | TCLK2);
+`else
+assign C1C4 = !(CCZ3 | TB013 | TBX3 | TCLK2);
+`endif
+wire C1C9 = !C1C4;
+
+endmodule
@@ -0,0 +1,17 @@
+// Friden EC-130 master clock edge
+//
+// every block on the master clock is written as always @(`CLK_EDGE).
+// With SINGLE_CLOCK, where top.v has no derived clocks left, both edges
+// of clk are master clocks: the host toggles it once a cycle, so each
+// eval() runs one clock instead of a rising and a falling half
+
+`ifndef CLOCK_VH
+`define CLOCK_VH
+
+`ifdef SINGLE_CLOCK
+`define CLK_EDGE posedge clk or negedge clk
+`else
+`define CLK_EDGE posedge clk
+`endif
+
+`endif
@@ -0,0 +1,290 @@
+// Friden EC-130 D counter
+//
+// the D digit counter; the 4-counter machines (FOUR_COUNTERS) only
+// differ in how it's stepped
+
+`include "clock.vh"
+
+module d_counter (
+    input clk,
+    input XB597,
+    input ME1L3,
+    input ACRY1,
+    input CRD9,
+    input CID9,
+    input CA51,
+    input SAD9,
+    input CA52,
+    input ACRY2,
+    input HOME1,
+    input XB487,
+    input CA41,
+    input CA42,
+    input XB377,
+    input CA31,
+    input CA32,
+    input XB267,
+    input CA21,
+    input CA22,
+    input XB157,
+    input CA11,
+    input CA12,
+    output CD12,
+    output CD11,
+    output CD51,
+    output CD52,
+    output CD41,
+    output CD42,
+    output CD31,
+    output CD32,
+    output CD21,
+    output CD22,
+    output CDZ3,
+`ifdef FOUR_COUNTERS
+    input CED55,
+`else
+    input MSU3,
+`endif
+    output CDZ4
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+wire s_1304, s_1303, s_1301, s_1302, r_1306, r_1305, r_1307, r_1308;
+ac AC_1304 (
+    .clk(clk),
+    .en(XB597),
+    .trans(ME1L3),
+    .out(s_1304)
+);
+ac AC_1303 (
+    .clk(clk),
+    .en(ACRY1),
+    .trans(CRD9),
+    .out(s_1303)
+);
+ac AC_1301 (
+    .clk(clk),
+    .en(CD12),
+    .trans(CID9),
+    .out(s_1301)
+);
+ac AC_1302 (
+    .clk(clk),
+    .en(CA51),
+    .trans(SAD9),
+    .out(s_1302)
+);
+ac AC_1306 (
+    .clk(clk),
+    .en(CA52),
+    .trans(SAD9),
+    .out(r_1306)
+);
+ac AC_1305 (
+    .clk(clk),
+    .en(CD11),
+    .trans(CID9),
+    .out(r_1305)
+);
+ac AC_1307 (
+    .clk(clk),
+    .en(ACRY2),
+    .trans(CRD9),
+    .out(r_1307)
+);
+ac AC_1308 (
+    .clk(clk),
+`ifndef FOUR_COUNTERS
+    .en(MSU3),
+`else
+    .en(CED55),
+`endif
+    .trans(HOME1),
+    .out(r_1308)
+);
+ff D5_1300 (
+    .clk(clk),
+    .set_l(s_1304 | s_1303 | s_1301 | s_1302),
+    .rst_l(r_1306 | r_1305 | r_1307 | r_1308),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(CD51),
+    .q_n(CD52)
+);
+
+wire s_1313, s_1311, s_1312, r_1315, r_1314;
+ac AC_1313 (
+    .clk(clk),
+    .en(XB487),
+    .trans(ME1L3),
+    .out(s_1313)
+);
+ac AC_1311 (
+    .clk(clk),
+    .en(CD51),
+    .trans(CID9),
+    .out(s_1311)
+);
+ac AC_1312 (
+    .clk(clk),
+    .en(CA41),
+    .trans(SAD9),
+    .out(s_1312)
+);
+ac AC_1315 (
+    .clk(clk),
+    .en(CA42),
+    .trans(SAD9),
+    .out(r_1315)
+);
+ac AC_1314 (
+    .clk(clk),
+    .en(CD52),
+    .trans(CID9),
+    .out(r_1314)
+);
+ff D4_1310 (
+    .clk(clk),
+    .set_l(s_1313 | s_1311 | s_1312),
+    .rst_l(r_1315 | r_1314),
+    .set_p(1'b0),
+    .rst_p(CRD9),
+    .tog_p(1'b0),
+    .q(CD41),
+    .q_n(CD42)
+);
+
+wire s_1323, s_1321, s_1322, r_1325, r_1324;
+ac AC_1323 (
+    .clk(clk),
+    .en(XB377),
+    .trans(ME1L3),
+    .out(s_1323)
+);
+ac AC_1321 (
+    .clk(clk),
+    .en(CD41),
+    .trans(CID9),
+    .out(s_1321)
+);
+ac AC_1322 (
+    .clk(clk),
+    .en(CA31),
+    .trans(SAD9),
+    .out(s_1322)
+);
+ac AC_1325 (
+    .clk(clk),
+    .en(CA32),
+    .trans(SAD9),
+    .out(r_1325)
+);
+ac AC_1324 (
+    .clk(clk),
+    .en(CD42),
+    .trans(CID9),
+    .out(r_1324)
+);
+ff D3_1320 (
+    .clk(clk),
+    .set_l(s_1323 | s_1321 | s_1322),
+    .rst_l(r_1325 | r_1324),
+    .set_p(1'b0),
+    .rst_p(CRD9),
+    .tog_p(1'b0),
+    .q(CD31),
+    .q_n(CD32)
+);
+
+wire s_1333, s_1331, s_1332, r_1335, r_1334;
+ac AC_1333 (
+    .clk(clk),
+    .en(XB267),
+    .trans(ME1L3),
+    .out(s_1333)
+);
+ac AC_1331 (
+    .clk(clk),
+    .en(CD31),
+    .trans(CID9),
+    .out(s_1331)
+);
+ac AC_1332 (
+    .clk(clk),
+    .en(CA21),
+    .trans(SAD9),
+    .out(s_1332)
+);
+ac AC_1335 (
+    .clk(clk),
+    .en(CA22),
+    .trans(SAD9),
+    .out(r_1335)
+);
+ac AC_1334 (
+    .clk(clk),
+    .en(CD32),
+    .trans(CID9),
+    .out(r_1334)
+);
+ff D2_1330 (
+    .clk(clk),
+    .set_l(s_1333 | s_1331 | s_1332),
+    .rst_l(r_1335 | r_1334),
+    .set_p(1'b0),
+    .rst_p(CRD9),
+    .tog_p(1'b0),
+    .q(CD21),
+    .q_n(CD22)
+);
+
+wire s_1343, s_1341, s_1342, r_1345, r_1344;
+ac AC_1343 (
+    .clk(clk),
+    .en(XB157),
+    .trans(ME1L3),
+    .out(s_1343)
+);
+ac AC_1341 (
+    .clk(clk),
+    .en(CD21),
+    .trans(CID9),
+    .out(s_1341)
+);
+ac AC_1342 (
+    .clk(clk),
+    .en(CA11),
+    .trans(SAD9),
+    .out(s_1342)
+);
+ac AC_1345 (
+    .clk(clk),
+    .en(CA12),
+    .trans(SAD9),
+    .out(r_1345)
+);
+ac AC_1344 (
+    .clk(clk),
+    .en(CD22),
+    .trans(CID9),
+    .out(r_1344)
+);
+ff D1_1340 (
+    .clk(clk),
+    .set_l(s_1343 | s_1341 | s_1342),
+    .rst_l(r_1345 | r_1344),
+    .set_p(1'b0),
+    .rst_p(CRD9),
+    .tog_p(1'b0),
+    .q(CD11),
+    .q_n(CD12)
+);
+
+assign CDZ3 = !(CD51 | CD11);
+assign CDZ4 = !CDZ3;
+
+endmodule
@@ -0,0 +1,61 @@
+// Friden EC-130 display
+//
+// only as much of the display logic as the calculation needs: the
+// YCPR4 (and on the 4-counter machines YCPR3) pulse the display scans
+// the registers with; ec130_gl drives its CRT from it in top.v
+
+`include "clock.vh"
+
+module display (
+    input TFE2,
+    input TFM1,
+    input TFE1,
+    input TFM2,
+    input TFF2,
+    input TFN1,
+    input TFF1,
+    input TFN2,
+    input TFG2,
+`ifdef FOUR_COUNTERS
+    input PSZ3,
+    output YCPR3,
+`endif
+    output YCPR4
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+`ifndef EC132
+// we're really cheating here, as the bare minimum of the display logic
+// is implemented to get the calculator to calculate
+//
+// maybe this will be expanded someday to drive some DACs for an oscilloscope?
+// could be fun!
+wire o_221 = TFE2 | TFM1;
+wire o_222 = TFE1 | TFM2;
+wire o_223 = TFF2 | TFN1;
+wire o_224 = TFF1 | TFN2;
+`endif
+`ifndef FOUR_COUNTERS
+assign YCPR4 = !(o_221 & o_222 & TFG2 & o_223 & o_224);
+`elsif EC132
+// we're really cheating here, as the bare minimum of the display logic
+// is implemented to get the calculator to calculate
+//
+// maybe this will be expanded someday to drive some DACs for an oscilloscope?
+// could be fun!
+wire o_252 = TFE2 | TFM1;
+wire o_253 = TFE1 | TFM2;
+wire o_254 = TFF2 | TFN1;
+wire o_255 = TFF1 | TFN2;
+assign YCPR4 = !(o_252 & o_253 & PSZ3 & TFG2 & o_254 & o_255);
+`else
+assign YCPR4 = !(o_221 & o_222 & PSZ3 & TFG2 & o_223 & o_224);
+`endif
+`ifdef FOUR_COUNTERS
+assign YCPR3 = !YCPR4;
+`endif
+
+endmodule
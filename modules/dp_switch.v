@@ -0,0 +1,343 @@
+// Friden EC-130 decimal point switch
+//
+// the DP switch decoding, the DP counter and the mult/div decimal point
+// control; EC132 renumbers the cards and adds the square root's
+
+`include "clock.vh"
+
+module dp_switch (
+    input clk,
+    input M1L4,
+    input HOME1,
+    input EMU1,
+    input EMU2,
+    input EDV1,
+    input key_dp,
+    input EROF9,
+    input ECFS1,
+    input AIRX3,
+    input ECF2,
+    input [3:0] sw_dp,
+    output DSZ6,
+    output DC81,
+    output DC41,
+    output DC21,
+    output DC11,
+    output DSZ3,
+    output EDPS1,
+    output EDPS2,
+    input PC41,
+`ifdef EC132
+    input ESQ1,
+    input DP0Q3,
+    input RCR03,
+    output EMDQ4,
+`else
+    output EMD4,
+`endif
+`ifdef FOUR_COUNTERS
+    input PC42,
+    input EKBD3,
+`else
+    input KBD3,
+`endif
+    output XD137
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+assign DSZ6 = DC81 | DC41 | DC21 | DC11;
+assign DSZ3 = !DSZ6;
+
+wire DIC5 = M1L4 | HOME1 | DSZ3;
+
+wire DEDS3 = !EMU1;
+wire DMUS3 = !EMU2;
+`ifndef EC132
+assign EMD4 = !(EMU1 | EDV1);
+`endif
+`ifndef FOUR_COUNTERS
+wire P4SD3 = EMD4 | PC41;
+`elsif EC132
+assign EMDQ4 = !(EMU1 | EDV1 | ESQ1);
+wire P4SD3 = !(EMDQ4 | PC42);
+`else
+wire P4SD3 = !(EMD4 | PC42);
+`endif
+
+`ifndef EC132
+wire s_1133, s_1132;
+ac AC_1133 (
+    .clk(clk),
+    .en(DSZ3),
+    .trans(P4SD3),
+    .out(s_1133)
+);
+`endif
+`ifndef FOUR_COUNTERS
+ac AC_1132 (
+    .clk(clk),
+    .en(key_dp),
+    .trans(KBD3),
+    .out(s_1132)
+);
+`elsif EC132
+wire s_1143, s_1142;
+ac AC_1143 (
+    .clk(clk),
+    .en(DSZ3),
+    .trans(P4SD3),
+    .out(s_1143)
+);
+ac AC_1142 (
+    .clk(clk),
+    .en(key_dp),
+    .trans(EKBD3),
+    .out(s_1142)
+);
+`else
+ac AC_1132 (
+    .clk(clk),
+    .en(key_dp),
+    .trans(EKBD3),
+    .out(s_1132)
+);
+`endif
+
+`ifndef EC132
+ff DPS_1130 (
+    .clk(clk),
+    .rst_l(EROF9),
+    .set_l(s_1133 | s_1132),
+    .set_p(ECFS1),
+    .rst_p(AIRX3 | ECF2),
+    .tog_p(1'b0),
+    .q(EDPS1),
+    .q_n(EDPS2)
+);
+`else
+wire AIRX3_p, RCR03_p, ECF2_p;
+ac AC_AIRX3 (
+    .clk(clk),
+    .en(1'b1),
+    .trans(AIRX3),
+    .out(AIRX3_p)
+);
+ac AC_RCR03 (
+    .clk(clk),
+    .en(1'b1),
+    .trans(RCR03),
+    .out(RCR03_p)
+);
+ac AC_ECF2 (
+    .clk(clk),
+    .en(1'b1),
+    .trans(ECF2),
+    .out(ECF2_p)
+);
+
+ff DPS_1140 (
+    .clk(clk),
+    .rst_l(EROF9 | AIRX3_p | RCR03_p | ECF2_p),
+    .set_l(s_1143 | s_1142),
+    .set_p(ECFS1),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(EDPS1),
+    .q_n(EDPS2)
+);
+`endif
+
+wire XD177, XD167, XD157, XD147;
+wire XD127, XD117, XD107;
+
+assign {XD147, XD157, XD167, XD177} = (sw_dp + 4'h3) & {DMUS3, DMUS3, DMUS3, DMUS3};
+assign {XD107, XD117, XD127, XD137} = (-sw_dp) & {DEDS3, DEDS3, DEDS3, DEDS3};
+
+`ifndef EC132
+wire s_1211;
+ac AC_1211 (
+    .clk(clk),
+    .en(XD137 | XD177),
+    .trans(EDPS1),
+    .out(s_1211)
+);
+`else
+wire s_1231;
+ac AC_1231 (
+    .clk(clk),
+    .en(XD137 | XD177),
+    .trans(EDPS1),
+    .out(s_1231)
+);
+`endif
+wire DC12;
+`ifndef EC132
+ff DPC1_1210 (
+`else
+ff DPC1_1230 (
+`endif
+    .clk(clk),
+    .rst_l(EROF9),
+`ifndef EC132
+    .set_l(s_1211),
+`else
+    .set_l(s_1231),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(DIC5),
+    .q(DC11),
+    .q_n(DC12)
+);
+
+`ifndef EC132
+wire s_1203, s_1201;
+ac AC_1203 (
+    .clk(clk),
+    .en(EDV1),
+    .trans(AIRX3),
+    .out(s_1203)
+);
+ac AC_1201 (
+    .clk(clk),
+    .en(XD127 | XD167),
+    .trans(EDPS1),
+    .out(s_1201)
+);
+`else
+wire s_1223, s_1222, s_1221;
+ac AC_1223 (
+    .clk(clk),
+    .en(EDV1),
+    .trans(AIRX3),
+    .out(s_1223)
+);
+ac AC_1222 (
+    .clk(clk),
+    .en(XD127 | XD167),
+    .trans(EDPS1),
+    .out(s_1222)
+);
+ac AC_1221 (
+    .clk(clk),
+    .en(DP0Q3),
+    .trans(RCR03),
+    .out(s_1221)
+);
+`endif
+wire DC22;
+`ifndef EC132
+ff DPC2_1200 (
+`else
+ff DPC2_1220 (
+`endif
+    .clk(clk),
+    .rst_l(EROF9),
+`ifndef EC132
+    .set_l(s_1203 | s_1201),
+`else
+    .set_l(s_1223 | s_1222 | s_1221),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(DC12),
+    .q(DC21),
+    .q_n(DC22)
+);
+
+`ifndef EC132
+wire s_1193, s_1191;
+ac AC_1193 (
+    .clk(clk),
+    .en(DMUS3),
+    .trans(AIRX3),
+    .out(s_1193)
+);
+ac AC_1191 (
+    .clk(clk),
+    .en(XD117 | XD157),
+    .trans(EDPS1),
+    .out(s_1191)
+);
+`else
+wire s_1213, s_1212, s_1211;
+ac AC_1213 (
+    .clk(clk),
+    .en(DMUS3),
+    .trans(AIRX3),
+    .out(s_1213)
+);
+ac AC_1212 (
+    .clk(clk),
+    .en(XD117 | XD157),
+    .trans(EDPS1),
+    .out(s_1212)
+);
+ac AC_1211 (
+    .clk(clk),
+    .en(XD137),
+    .trans(RCR03),
+    .out(s_1211)
+);
+`endif
+wire DC42;
+`ifndef EC132
+ff DPC4_1190 (
+`else
+ff DPC4_1210 (
+`endif
+    .clk(clk),
+    .rst_l(EROF9),
+`ifndef EC132
+    .set_l(s_1193 | s_1191),
+`else
+    .set_l(s_1213 | s_1212 | s_1211),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(DC22),
+    .q(DC41),
+    .q_n(DC42)
+);
+
+`ifndef EC132
+wire s_1181;
+ac AC_1181 (
+    .clk(clk),
+    .en(XD107 | XD147),
+    .trans(EDPS1),
+    .out(s_1181)
+);
+`else
+wire s_1201;
+ac AC_1201 (
+    .clk(clk),
+    .en(XD107 | XD147),
+    .trans(EDPS1),
+    .out(s_1201)
+);
+`endif
+wire DC82;
+`ifndef EC132
+ff DPC8_1180 (
+`else
+ff DPC8_1200 (
+`endif
+    .clk(clk),
+    .rst_l(EROF9),
+`ifndef EC132
+    .set_l(s_1181),
+`else
+    .set_l(s_1201),
+`endif
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(DC42),
+    .q(DC81),
+    .q_n(DC82)
+);
+
+endmodule
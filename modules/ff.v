@@ -1,6 +1,8 @@
 // Friden EC-130 flip-flop model
 // Kyle Owen - 22 June 2022
 
+`include "clock.vh"
+
 module ff (
     input clk,
     input rst_l,
@@ -17,8 +19,20 @@ reg prev_set_p;
 reg prev_tog_p;
 
 reg q_int;
+
+`ifdef FAULT_INJECT
+// stuck-at faults for the fault campaign (sim/fault.cpp): while bit 1
+// is set, both outputs are held as if q were bit 0
+/* verilator lint_off UNDRIVEN */
+reg [1:0] stuck /*verilator public_flat_rw*/;
+/* verilator lint_on UNDRIVEN */
+initial stuck = 2'b00;
+assign q = stuck[1] ? stuck[0] : q_int;
+assign q_n = stuck[1] ? !stuck[0] : !q_int;
+`else
 assign q = q_int;
 assign q_n = !q_int;
+`endif
 
 // completely synchronous design to make synthesis easier
 //
@@ -28,7 +42,7 @@ assign q_n = !q_int;
 // not seem to have any ill effects in the design of the
 // EC-130
 
-always @(posedge clk) begin
+always @(`CLK_EDGE) begin
     prev_rst_p <= rst_p;
     prev_set_p <= set_p;
     prev_tog_p <= tog_p;
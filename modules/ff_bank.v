@@ -0,0 +1,46 @@
+// Friden EC-130 flip-flop model, packed into one bank of N flip-flops
+//
+// same behaviour as N separate ff instances, with the edge detectors
+// and states kept as N-wide vectors and updated together; built by
+// tools/pack_banks, see `make PACKED=1`
+
+`include "clock.vh"
+
+module ff_bank #(
+    parameter N = 1
+) (
+    input clk,
+    input [N-1:0] rst_l,
+    input [N-1:0] set_l,
+    input [N-1:0] tog_p,
+    input [N-1:0] rst_p,
+    input [N-1:0] set_p,
+    output [N-1:0] q
+);
+
+reg [N-1:0] prev_rst_p;
+reg [N-1:0] prev_set_p;
+reg [N-1:0] prev_tog_p;
+
+reg [N-1:0] q_int;
+assign q = q_int;
+
+wire [N-1:0] rise_rst = ~prev_rst_p & rst_p;
+wire [N-1:0] rise_set = ~prev_set_p & set_p;
+wire [N-1:0] rise_tog = ~prev_tog_p & tog_p;
+
+// same priority as ff: rst_l, set_l, then the rst_p, set_p and tog_p
+// edges; at most one of clr, set and tog is high for each flip-flop
+wire [N-1:0] clr = rst_l | (~set_l & rise_rst);
+wire [N-1:0] set = ~rst_l & (set_l | (~rise_rst & rise_set));
+wire [N-1:0] tog = ~rst_l & ~set_l & ~rise_rst & ~rise_set & rise_tog;
+
+always @(`CLK_EDGE) begin
+    prev_rst_p <= rst_p;
+    prev_set_p <= set_p;
+    prev_tog_p <= tog_p;
+
+    q_int <= ((q_int ^ tog) & ~clr) | set;
+end
+
+endmodule
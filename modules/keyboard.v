@@ -0,0 +1,711 @@
+// Friden EC-130 input and start
+//
+// START, the keyboard counter and the key decoding, and the flip-flops
+// the keys set, from ENTRY and MULT up to COM_FUN and the overflow lamp;
+// the 3-counter machine encodes the entry keys on three flip-flops
+// (EEN1..EEN4), where FOUR_COUNTERS (ec130_4cnt, ec132) has one each
+// for CHANGE SIGN, SHIFT DOWN, STORE, RECALL, REPEAT and ADD/SUB, and
+// EC132 adds CLEAR DISPLAY and SQUARE ROOT and renumbers some cards
+//
+// a key is taken after it has been held for KEYBOARD_DELAY clocks
+
+`include "clock.vh"
+
+module keyboard #(
+    parameter KEYBOARD_DELAY = 100
+) (
+    input clk,
+    input key_clr_all,
+    input key_0,
+    input key_1,
+    input key_2,
+    input key_3,
+    input key_4,
+    input key_5,
+    input key_6,
+    input key_7,
+    input key_8,
+    input key_9,
+    input key_chg_sign,
+    input key_repeat,
+    input key_div,
+    input key_enter,
+    input key_mult,
+    input key_sub,
+    input key_add,
+    input key_store,
+    input key_recall,
+    input key_clr_ent,
+    input key_dp,
+    input DBSL3,
+    input HOME1,
+    input PC41,
+    input PC21,
+    input ACOF1,
+    input key_of_lock,
+    input CDZ4,
+    input MAIS3,
+    input TC14,
+    output ESTA1,
+    output ESTA3,
+    output XB597,
+    output XB487,
+    output XB377,
+    output XB267,
+    output XB157,
+    output kbd_ack,
+    output ERF3,
+    output EMU1,
+    output EMU2,
+    output EDV1,
+    output EDV2,
+    output EROF9,
+    output ECD1,
+    output ECD2,
+    output ECF1,
+    output ECFS1,
+    output ECFS2,
+    output AOFL1,
+    output ECF2,
+    output ECFD4,
+    output lamp_overflow,
+`ifdef EC132
+    input key_clr_disp,
+    input key_sqrt,
+    input PS153,
+    input PC81,
+    output ECY1,
+    output ECY2,
+    output ESQ1,
+    output ESQ2,
+`else
+    input PS73,
+`endif
+`ifdef FOUR_COUNTERS
+    input RSLO5,
+    input MA1L3,
+    output EKBD3,
+    output ECS1,
+    output ECS2,
+    output EAS1,
+    output ESTO1,
+    output ESD1,
+    output ESD2,
+    output ESTO2,
+    output ERC1,
+    output ERC2,
+    output ERP1,
+    output ERP2,
+    output EAS2,
+`else
+    input RSLO3,
+    output KBD3,
+    output EEN41,
+    output EEN42,
+    output EEN21,
+    output EEN22,
+    output EEN11,
+    output EEN12,
+`endif
+    output kbd_lock
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+wire ESTA2;
+ff START_1010 (
+    .clk(clk),
+    .rst_l(1'b0),
+    .set_l(key_clr_all),
+    .set_p(1'b0),
+`ifndef FOUR_COUNTERS
+    .rst_p(KBD3),
+`else
+    .rst_p(EKBD3),
+`endif
+    .tog_p(1'b0),
+    .q(ESTA1),
+    .q_n(ESTA2)
+);
+assign ESTA3 = !ESTA2;
+
+`ifdef EC132
+// CLEAR DISPLAY
+ff CLR_DISP_1640 (
+    .clk(clk),
+    .rst_l(1'b0),
+    .set_l(key_clr_disp),
+    .set_p(1'b0),
+    .rst_p(EKBD3),
+    .tog_p(1'b0),
+    .q(ECY1),
+    .q_n(ECY2)
+);
+
+`endif
+// keyboard decoding
+wire sw_com_dig = key_0 | key_1 | key_2 | key_3 | key_4 | key_5 | key_6 | key_7 | key_8 | key_9;
+`ifndef EC132
+wire sw_com_fun = key_chg_sign | key_repeat | key_div | key_enter | key_mult | key_sub |
+                  key_add | key_store | key_recall;
+`else
+wire sw_com_fun = key_chg_sign | key_repeat | key_div | key_enter | key_mult | key_sub |
+                  key_add | key_store | key_recall | key_sqrt;
+`endif
+
+wire [4:0] XB_keys = {
+    key_5 | key_6 | key_7 | key_8 | key_9,
+    key_4 | key_5 | key_6 | key_7 | key_8,
+    key_3 | key_4 | key_5 | key_6 | key_7,
+    key_2 | key_3 | key_4 | key_5 | key_6,
+    key_1 | key_2 | key_3 | key_4 | key_5
+};
+
+`ifdef SINGLE_CLOCK
+// latched on clk instead; the keys only change between clocks, so on
+// the clock a digit goes down the new value comes straight from the
+// keys, just as it would have from the latch
+reg sw_com_dig_prev;
+reg [4:0] XB_latch;
+wire [4:0] XB = sw_com_dig && !sw_com_dig_prev ? XB_keys : XB_latch;
+always @(`CLK_EDGE) begin
+    sw_com_dig_prev <= sw_com_dig;
+    if (sw_com_dig && !sw_com_dig_prev)
+        XB_latch <= XB_keys;
+end
+`else
+reg [4:0] XB;
+always @(posedge sw_com_dig) begin
+    XB <= XB_keys;
+end
+`endif
+
+assign XB597 = XB[4];
+assign XB487 = XB[3];
+assign XB377 = XB[2];
+assign XB267 = XB[1];
+assign XB157 = XB[0];
+
+// originally, this would be a 6 ms delay for debouncing
+// the keyboard reed switches, but any value should work
+// since bouncing contacts is not a problem here
+reg [6:0] kbd_cnt;
+always @(`CLK_EDGE) begin
+    if (key_clr_ent | key_dp | sw_com_dig | sw_com_fun) begin
+        if (kbd_cnt < KEYBOARD_DELAY-1)
+            kbd_cnt <= kbd_cnt + 1;
+    end
+    else
+        kbd_cnt <= 0;
+end
+
+`ifndef FOUR_COUNTERS
+assign KBD3 = (kbd_cnt == KEYBOARD_DELAY-1);
+assign kbd_ack = KBD3;
+`else
+assign EKBD3 = (kbd_cnt == KEYBOARD_DELAY-1);
+assign kbd_ack = EKBD3;
+`endif
+
+`ifndef FOUR_COUNTERS
+wire o_322 = key_add | key_sub | key_store;
+wire o_323 = key_store | key_chg_sign | key_repeat;
+wire o_324 = key_repeat | key_recall | key_add | key_sub;
+`else
+wire s_1051;
+ac AC_1051 (
+    .clk(clk),
+    .en(key_chg_sign),
+    .trans(EKBD3),
+    .out(s_1051)
+);
+ff CHANGE_SIGN_1050 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1051),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ECS1),
+    .q_n(ECS2)
+);
+`endif
+
+`ifndef FOUR_COUNTERS
+wire s_1662, s_1663;
+ac AC_1662 (
+    .clk(clk),
+    .en(key_clr_ent),
+    .trans(KBD3),
+    .out(s_1662)
+);
+ac AC_1663 (
+    .clk(clk),
+    .en(o_322),
+    .trans(KBD3),
+    .out(s_1663)
+);
+ff EEN4_1660 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1662 | s_1663),
+    .set_p(AOFL2),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(EEN41),
+    .q_n(EEN42)
+);
+    
+wire s_1671;
+ac AC_1671 (
+    .clk(clk),
+    .en(o_323),
+    .trans(KBD3),
+    .out(s_1671)
+);
+ff EEN2_1670 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1671),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(EEN21),
+    .q_n(EEN22)
+);
+`else
+wire XCE7 = key_clr_ent;
+wire s_1032, aofl2_ac, eas1_ac;
+ac AC_1032 (
+    .clk(clk),
+    .en(XCE7),
+    .trans(EKBD3),
+    .out(s_1032)
+);
+ac AC_AOFL2 (
+    .clk(clk),
+    .en(1'b1),
+    .trans(AOFL2),
+    .out(aofl2_ac)
+);
+ac AC_EAS1 (
+    .clk(clk),
+    .en(1'b1),
+    .trans(EAS1),
+    .out(eas1_ac)
+);
+ff SHIFT_DOWN_1030 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1032 | aofl2_ac | eas1_ac),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(ESTO1),
+    .q(ESD1),
+    .q_n(ESD2)
+);
+`endif
+
+`ifndef FOUR_COUNTERS
+wire s_1681;
+ac AC_1681 (
+    .clk(clk),
+    .en(o_324),
+    .trans(KBD3),
+    .out(s_1681)
+);
+ff EEN1_1680 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1681),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(EEN11),
+    .q_n(EEN12)
+);
+`else
+wire s_1041;
+ac AC_1041 (
+    .clk(clk),
+    .en(key_store),
+    .trans(EKBD3),
+    .out(s_1041)
+);
+ff STORE_1040 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1041),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ESTO1),
+    .q_n(ESTO2)
+);
+
+wire s_1071;
+ac AC_1071 (
+    .clk(clk),
+    .en(key_recall),
+    .trans(EKBD3),
+    .out(s_1071)
+);
+ff RECALL_1070 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1071),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ERC1),
+    .q_n(ERC2)
+);
+
+wire s_1061;
+ac AC_1061 (
+    .clk(clk),
+    .en(key_repeat),
+    .trans(EKBD3),
+    .out(s_1061)
+);
+ff REPEAT_1060 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1061),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ERP1),
+    .q_n(ERP2)
+);
+`endif
+
+wire s_1091;
+ac AC_1091 (
+    .clk(clk),
+    .en(key_mult),
+`ifndef FOUR_COUNTERS
+    .trans(KBD3),
+`else
+    .trans(EKBD3),
+`endif
+    .out(s_1091)
+);
+ff MULT_1090 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1091),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(EMU1),
+    .q_n(EMU2)
+);
+
+wire s_1081;
+ac AC_1081 (
+    .clk(clk),
+    .en(key_div),
+`ifndef FOUR_COUNTERS
+    .trans(KBD3),
+`else
+    .trans(EKBD3),
+`endif
+    .out(s_1081)
+);
+ff DIV_1080 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1081),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(EDV1),
+    .q_n(EDV2)
+);
+
+`ifdef EC132
+wire s_1121;
+ac AC_1121 (
+    .clk(clk),
+    .en(key_sqrt),
+    .trans(EKBD3),
+    .out(s_1121)
+);
+ff SQRT_1120 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1121),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ESQ1),
+    .q_n(ESQ2)
+);
+
+`endif
+wire s_1112, s_1111;
+ac AC_1112 (
+    .clk(clk),
+    .en(key_dp),
+    .trans(DBSL3),
+    .out(s_1112)
+);
+ac AC_1111 (
+    .clk(clk),
+    .en(sw_com_dig),
+`ifndef FOUR_COUNTERS
+    .trans(KBD3),
+`else
+    .trans(EKBD3),
+`endif
+    .out(s_1111)
+);
+ff COM_DIG_1110 (
+    .clk(clk),
+    .rst_l(r_1104 | EROF9),
+    .set_l(s_1112 | s_1111),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ECD1),
+    .q_n(ECD2)
+);
+
+ff CFS_1120 (
+    .clk(clk),
+    .rst_l(1'b0),
+    .set_l(EROF9),
+    .set_p(ECF1),
+    .rst_p(ECD2),
+    .tog_p(1'b0),
+    .q(ECFS1),
+    .q_n(ECFS2)
+);
+
+wire s_1102, r_1104, r_1103;
+ac AC_1102 (
+    .clk(clk),
+    .en(sw_com_fun),
+`ifndef FOUR_COUNTERS
+    .trans(KBD3),
+`else
+    .trans(EKBD3),
+`endif
+    .out(s_1102)
+);
+`ifndef EC132
+ac AC_1104 (
+    .clk(clk),
+    .en(PS73),
+    .trans(HOME1),
+    .out(r_1104)
+);
+`endif
+`ifndef FOUR_COUNTERS
+wire o_029 = PC41 | PC21;
+ac AC_1103 (
+    .clk(clk),
+    .en(AOFL1),
+    .trans(o_029),
+    .out(r_1103)
+);
+ff COM_FUN_1100 (
+    .clk(clk),
+    .rst_l(r_1104 | r_1103 | EROF9),
+    .set_l(s_1102),
+    .set_p(EEN41),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ECF1),
+    .q_n(ECF2)
+);
+`elsif EC132
+ac AC_1104 (
+    .clk(clk),
+    .en(PS153),
+    .trans(HOME1),
+    .out(r_1104)
+);
+ac AC_1103 (
+    .clk(clk),
+    .en(MOFL3), 
+    .trans(HOME1),
+    .out(r_1103)
+);
+`else
+ac AC_1103 (
+    .clk(clk),
+    .en(AOFL3),
+    .trans(HOME1),
+    .out(r_1103)
+);
+`endif
+`ifdef FOUR_COUNTERS
+ff COM_FUN_1100 (
+    .clk(clk),
+    .rst_l(r_1104 | r_1103 | EROF9),
+    .set_l(s_1102),
+    .set_p(ESD1),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(ECF1),
+    .q_n(ECF2)
+);
+`endif
+
+`ifndef FOUR_COUNTERS
+assign ECFD4 = !(ECD1 | ACOF1 | ECF1);
+`else
+wire s_1021;
+ac AC_1021 (
+    .clk(clk),
+    .en(key_add | key_sub),
+    .trans(EKBD3),
+    .out(s_1021)
+);
+ff ADD_SUB_1020 (
+    .clk(clk),
+    .rst_l(ERF3),
+    .set_l(s_1021),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(EAS1),
+    .q_n(EAS2)
+);
+
+assign ECFD4 = !(ECD1 | ECF1);
+`endif
+
+`ifndef EC132
+assign EROF9 = key_of_lock | ESTA3;
+`else
+assign EROF9 = key_of_lock | ECY1 | ESTA3;
+`endif
+wire ECFD4_p;
+ac AC_ECFD4 (
+    .clk(clk),
+    .en(1'b1),
+    .trans(ECFD4),
+    .out(ECFD4_p)
+);
+assign ERF3 = EROF9 | ECFD4_p;
+
+`ifndef FOUR_COUNTERS
+wire s_1224, s_1221, s_1222, r_1223;
+ac AC_1224 (
+    .clk(clk),
+    .en(CDZ4),
+    .trans(ECD2),
+    .out(s_1224)
+);
+`elsif EC132
+`else
+wire s_1221, s_1222, r_1223;
+`endif
+`ifndef EC132
+ac AC_1221 (
+    .clk(clk),
+    .en(MAIS3),
+    .trans(ACOF1),
+    .out(s_1221)
+);
+`endif
+`ifndef FOUR_COUNTERS
+ac AC_1222 (
+    .clk(clk),
+    .en(CDZ4),
+    .trans(RSLO3),
+    .out(s_1222)
+);
+ac AC_1223 (
+    .clk(clk),
+    .en(key_clr_ent),
+    .trans(TC14),
+    .out(r_1223)
+);
+`elsif EC132
+wire s_1241, s_1242, r_1243;
+ac AC_1241 (
+    .clk(clk),
+    .en(MAIS3),
+    .trans(ACOF1),
+    .out(s_1241)
+);
+ac AC_1242 (
+    .clk(clk),
+    .en(CDZ4),
+    .trans(RSLO5),
+    .out(s_1242)
+);
+ac AC_1243 (
+    .clk(clk),
+    .en(XCE7), // error in logic diagram? different than EC-130; sticking with EC-130
+    .trans(TC14),
+    .out(r_1243)
+);
+`else
+ac AC_1222 (
+    .clk(clk),
+    .en(CDZ4),
+    .trans(RSLO5),
+    .out(s_1222)
+);
+ac AC_1223 (
+    .clk(clk),
+    .en(XCE7),
+    .trans(TC14),
+    .out(r_1223)
+);
+`endif
+wire AOFL2;
+`ifndef FOUR_COUNTERS
+ff OVERFLOW_1220 (
+    .clk(clk),
+    .rst_l(r_1223 | EROF9),
+    .set_l(s_1224 | s_1221 | s_1222),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(AOFL1),
+    .q_n(AOFL2)
+);
+
+assign lamp_overflow = !AOFL2;
+assign kbd_lock = (AOFL1 | ECF1) & !key_clr_ent;
+`elsif EC132
+ff OVERFLOW_1240 (
+    .clk(clk),
+    .rst_l(r_1243 | EROF9),
+    .set_l(s_1241 | s_1242),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(AOFL1),
+    .q_n(AOFL2)
+);
+wire AOFL3 = !AOFL2;
+assign lamp_overflow = AOFL3;
+wire MOFL3 = !(PC81 | PC41 | PC21 | MA1L3 | AOFL2);
+assign kbd_lock = !(!(MOFL3 | ECF1) | key_clr_ent);
+`else
+ff OVERFLOW_1220 (
+    .clk(clk),
+    .rst_l(r_1223 | EROF9),
+    .set_l(s_1221 | s_1222),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(1'b0),
+    .q(AOFL1),
+    .q_n(AOFL2)
+);
+wire MOFL3 = !AOFL2;
+assign lamp_overflow = MOFL3;
+wire AOFL3 = !(PC21 | PC41 | MA1L3 | AOFL2);
+assign kbd_lock = !(!(AOFL3 | ECF1) | key_clr_ent);
+`endif
+
+endmodule
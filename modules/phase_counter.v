@@ -0,0 +1,235 @@
+// Friden EC-130 phase counter
+//
+// the phase counter that sequences mult and div, and its PS decodes;
+// EC132 (with FOUR_COUNTERS) has a fourth flip-flop for the square
+// root, and renumbers the cards
+
+`include "clock.vh"
+
+module phase_counter (
+    input clk,
+    input MMDL3,
+    input HOME1,
+    input ECFD4,
+    input MAIM3,
+    input MA1L3,
+    output PC21,
+    output PC22,
+    output PC41,
+    output PC42,
+    output PC12,
+`ifdef EC132
+    input ESQ2,
+    input DSZ3,
+    input M2LM3,
+    input MSDS3,
+    input EMDQ4,
+    input ESQ1,
+    input ACOF2,
+    output PS144,
+    output PC81,
+    output PC82,
+    output PS153,
+    output PS154,
+`else
+    input EMD4,
+    output PS64,
+    output PS73,
+    output PS74,
+`endif
+`ifdef FOUR_COUNTERS
+    input MIAD3,
+    input ACOF1,
+    output PSZ3,
+`else
+    input MSU3,
+`endif
+    output PC11
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+`ifndef EC132
+wire s_1151, r_1154;
+ac AC_1151 (
+    .clk(clk),
+    .en(EMD4),
+    .trans(PC21),
+    .out(s_1151)
+);
+ac AC_1154 (
+    .clk(clk),
+    .en(MMDL3),
+    .trans(HOME1),
+    .out(r_1154)
+);
+ff PC4_1150 (
+    .clk(clk),
+    .set_l(s_1151),
+    .rst_l(r_1154 | ECFD4),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(PC22),
+    .q(PC41),
+    .q_n(PC42)
+);
+`else
+wire PJQ33 = !(ESQ2 | DSZ3 | PS144);
+wire PE4F5 = M2LM3 | MSDS3 | PS33;
+`endif
+
+`ifndef EC132
+ff PC2_1160 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(ECFD4),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(PC12),
+    .q(PC21),
+    .q_n(PC22)
+);
+`else
+wire s_1161, r_1163;
+ac AC_1161 (
+    .clk(clk),
+    .en(ESQ2),
+    .trans(PC21),
+    .out(s_1161)
+);
+ac AC_1163 (
+    .clk(clk),
+    .en(PJQ33),
+    .trans(HOME1),
+    .out(r_1163)
+);
+ff PC8_1160 (
+    .clk(clk),
+    .set_l(s_1161),
+    .rst_l(r_1163 | ECFD4),
+    .set_p(PC42),
+    .rst_p(1'b0),
+    .tog_p(PC42),
+    .q(PC81),
+    .q_n(PC82)
+);
+`endif
+
+`ifndef FOUR_COUNTERS
+wire s_1171;
+ac AC_1171 (
+    .clk(clk),
+    .en(MSU3),
+    .trans(HOME1),
+    .out(s_1171)
+);
+`elsif EC132
+wire s_1171, s_1172, s_1173, r_1175;
+ac AC_1171 (
+    .clk(clk),
+    .en(EMDQ4),
+    .trans(PC21),
+    .out(s_1171)
+);
+ac AC_1172 (
+    .clk(clk),
+    .en(ESQ1),
+    .trans(ACOF2),
+    .out(s_1172)
+);
+ac AC_1173 (
+    .clk(clk),
+    .en(PE4F5),
+    .trans(PC22),
+    .out(s_1173)
+);
+ac AC_1175 (
+    .clk(clk),
+    .en(MMDL3),
+    .trans(HOME1),
+    .out(r_1175)
+);
+ff PC4_1170 (
+    .clk(clk),
+    .set_l(s_1171 | s_1172 | s_1173),
+    .rst_l(r_1163 | r_1175 | ECFD4),
+    .set_p(1'b0),
+    .rst_p(PC22),
+    .tog_p(1'b0),
+    .q(PC41),
+    .q_n(PC42)
+);
+
+ff PC2_1180 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(ECFD4),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(PC12),
+    .q(PC21),
+    .q_n(PC22)
+);
+
+`endif
+`ifdef FOUR_COUNTERS
+wire P1C5 = MAIM3 | MIAD3 | MA1L3 | HOME1;
+`endif
+
+`ifndef FOUR_COUNTERS
+wire P1C5 = MSU3 | MAIM3 | MA1L3 | HOME1;
+`elsif EC132
+ff PC1_1190 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(ECFD4),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(P1C5),
+    .q(PC11),
+    .q_n(PC12)
+);
+`else
+ff PC1_1170 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(ECFD4),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(P1C5),
+    .q(PC11),
+    .q_n(PC12)
+);
+`endif
+
+`ifndef FOUR_COUNTERS
+ff PC1_1170 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(ECFD4),
+    .set_p(s_1171),
+    .rst_p(1'b0),
+    .tog_p(P1C5),
+    .q(PC11),
+    .q_n(PC12)
+);
+
+`elsif EC132
+`else
+assign PSZ3 = !(ACOF1 | PC41 | PC21 | PC11);
+`endif
+`ifndef EC132
+assign PS64 = PC42 | PC22 | PC11;
+assign PS73 = !(PC42 | PC22 | PC12);
+assign PS74 = !PS73;
+`else
+assign PSZ3 = !(ACOF1 | PC81 | PC41 | PC21 | PC11);
+wire PS33 = !(PC81 | PC41 | PC22 | PC12);
+assign PS144 = PC82 | PC42 | PC22 | PC11;
+assign PS153 = !(PC82 | PC42 | PC22 | PC12);
+assign PS154 = !PS153;
+`endif
+
+endmodule
@@ -0,0 +1,487 @@
+// Friden EC-130 carry circuits, register and shift control
+//
+// the carry and overflow flip-flops, the delay line read and recirculate
+// gating and the counter shift controls; FOUR_COUNTERS has the 4-counter
+// machines' register control, and EC132 adds the square root's
+
+`include "clock.vh"
+
+module shift_control (
+    input clk,
+    input ASC1,
+    input TC14,
+    input TR04,
+    input EMU2,
+    input TC24,
+    input TR14,
+    input PC41,
+    input PC22,
+    input TR03,
+    input MSU4,
+    input CA94,
+    input MAD4,
+    input TCX5,
+    input TB154,
+    input XRDL4,
+    input TC03,
+    input TFG1,
+    input EROF9,
+    input HOME1,
+    input PC11,
+    input TR13,
+    input TFE2,
+    input TFF1,
+    input M1L4,
+    input ECD2,
+    input ECFS2,
+    input EDPS2,
+    output ACOF2,
+    output ACRY2,
+    output ACOF1,
+    output ASA13,
+    output ARA13,
+    output ACRY1,
+    output CIA9,
+    output CRA9,
+    output SAC9,
+    output AIRX3,
+    output SDA9,
+    output SAD9,
+    output CRD9,
+`ifdef FOUR_COUNTERS
+    input ECS2,
+    input MIAD4,
+    input ESTO2,
+    input ESD2,
+    input TC153,
+    input ERC2,
+    input ERP2,
+    input M2L4,
+    input MMDL3,
+    input TC154,
+    input YCPR3,
+    input ARDS3,
+    input CDZ3,
+    output SBC9,
+    output SAB9,
+    output SDB9,
+    output CED55,
+    output RSLO5,
+`else
+    input EEN41,
+    input EEN22,
+    input EEN11,
+    input EDV2,
+    input PC42,
+    input TC04,
+    input EEN42,
+    input TFH2,
+    input TFJ2,
+    input TFK2,
+    input TFL2,
+    input MSU3,
+    input PS73,
+    input YCPR4,
+    input EEN12,
+    input EEN21,
+    output RSLO3,
+    output SDC9,
+`endif
+`ifdef EC132
+    input PS144,
+    input ESQ2,
+    input PC82,
+    input ECY2,
+    input ESQ1,
+    input PS154,
+    input EMDQ4,
+    input TFF2,
+    input PC81,
+    input ML1Q3,
+    output RCR03,
+`else
+    input PS64,
+    input EMD4,
+    input PS74,
+`endif
+    input PC21,
+    input PC12,
+    input TFG2,
+    input DSZ3,
+    output reg CID9
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+wire RIAC6 = ASC1 | ACOF2 | TC14 | TR04;
+`ifndef FOUR_COUNTERS
+wire RIAS6 = EEN41 | EEN22 | EEN11 | PS64 | TC14 | TR04;
+`elsif EC132
+wire RIAS6 = ECS2 | PS144 | TC14 | TR04;
+`else
+wire RIAS6 = ECS2 | PS64 | TC14 | TR04;
+`endif
+wire RIMC6 = EMU2 | ACOF2 | TC24 | TR14;
+wire RIAM6 = EMU2 | ACOF2 | ACRY2 | TR14;
+`ifndef FOUR_COUNTERS
+wire RIAD6 = EDV2 | ACOF1 | TC24 | TR14 | PC42 | PC21 | PC12;
+`else
+wire RIAD6 = MIAD4 | TC24 | TR14;
+`endif
+`ifndef EC132
+assign ASA13 = !(RIAC6 & RIAS6 & RIMC6 & RIAM6 & RIAD6);
+`else
+wire RIAQ6 = ESQ2 | PC82 | PC41 | PC22 | PC12 | TC24 | TFG2 | TR03 | ACOF1;
+assign ASA13 = !(RIAC6 & RIAS6 & RIMC6 & RIAM6 & RIAD6 & RIAQ6);
+`endif
+assign ARA13 = !ASA13;
+wire AERM3 = !(EMU2 | ARA13);
+wire AERS3 = !(MSU4 | CA94);
+wire AESA3 = !(AERS3 | CA94);
+wire ARCA3 = !(MAD4 | TCX5 | TR04 | TB154 | AERC4);
+// AERC4 has a nasty feedback path, so clock it
+//wire AERC4 = !(ACRY1 | ARCA3);
+reg AERC4;
+always @(`CLK_EDGE) begin
+    AERC4 <= !(ACRY1 | ARCA3);
+end
+`ifndef EC132
+wire MAIR3 = !XRDL4;
+assign CIA9 = ARCA3 | MAIR3;
+`else
+wire RCY3 = !(ECY2 | TC03 | TFG1);
+wire MAIR3 = !(RCR03 | XRDL4 | RCY3);
+wire AIRQ3 = !(ESQ2 | PS144 | TC24 | TR04 | TB154);
+assign CIA9 = ARCA3 | MAIR3 | AIRQ3;
+`endif
+
+`ifndef EC132
+wire s_1232, r_1234, r_1235, r_1236;
+ac AC_1232 (
+    .clk(clk),
+    .en(AESA3),
+    .trans(CIA9),
+    .out(s_1232)
+);
+ac AC_1234 (
+    .clk(clk),
+    .en(AERS3),
+    .trans(CIA9),
+    .out(r_1234)
+);
+ac AC_1235 (
+    .clk(clk),
+    .en(CA94),
+    .trans(ARCA3),
+    .out(r_1235)
+);
+ac AC_1236 (
+    .clk(clk),
+    .en(AERM3),
+    .trans(CRA9),
+    .out(r_1236)
+);
+`endif
+`ifndef EC132
+ff CARRY_1230 (
+    .clk(clk),
+    .set_l(s_1232),
+`ifndef FOUR_COUNTERS
+    .rst_l(r_1234 | r_1235 | r_1236 | RSLO3 | EROF9),
+`else
+    .rst_l(r_1234 | r_1235 | r_1236 | EROF9),
+`endif
+    .set_p(AIDS3),
+    .rst_p(HOME1),
+    .tog_p(1'b0),
+    .q(ACRY1),
+    .q_n(ACRY2)
+);
+`endif
+`ifndef EC132
+wire s_1241;
+wire o_160 = ACOF1 | HOME1;
+ac AC_1241 (
+    .clk(clk),
+    .en(ACRY1),
+    .trans(o_160),
+    .out(s_1241)
+);
+`endif
+`ifndef FOUR_COUNTERS
+ff CARRY_OF_1240 (
+    .clk(clk),
+    .set_l(s_1241),
+    .rst_l(EROF9), //1242??? error in schematic?
+    .set_p(1'b0),
+    .rst_p(HOME1),
+    .tog_p(1'b0),
+    .q(ACOF1),
+    .q_n(ACOF2)
+);
+`elsif EC132
+wire s_1452, r_1454, r_1455, r_1456;
+ac AC_1452 (
+    .clk(clk),
+    .en(AESA3),
+    .trans(CIA9),
+    .out(s_1452)
+);
+ac AC_1454 (
+    .clk(clk),
+    .en(AERS3),
+    .trans(CIA9),
+    .out(r_1454)
+);
+ac AC_1455 (
+    .clk(clk),
+    .en(CA94),
+    .trans(ARCA3),
+    .out(r_1455)
+);
+ac AC_1456 (
+    .clk(clk),
+    .en(AERM3),
+    .trans(CRA9),
+    .out(r_1456)
+);
+wire ASCQ3 = !(PC82 | PC41 | PC21 | PC11 | TC14 | TR04);
+ff CARRY_1450 (
+    .clk(clk),
+    .set_l(s_1452 | ASCQ3),
+    .rst_l(r_1454 | r_1455 | r_1456 | EROF9),
+    .set_p(AIDS3),
+    .rst_p(HOME1),
+    .tog_p(1'b0),
+    .q(ACRY1),
+    .q_n(ACRY2)
+);
+wire s_1461;
+wire o_190 = ACOF1 | HOME1;
+ac AC_1461 (
+    .clk(clk),
+    .en(ACRY1),
+    .trans(o_190),
+    .out(s_1461)
+);
+ff CARRY_OF_1460 (
+    .clk(clk),
+    .set_l(s_1461),
+    .rst_l(EROF9), 
+    .set_p(1'b0),
+    .rst_p(HOME1),
+    .tog_p(1'b0),
+    .q(ACOF1),
+    .q_n(ACOF2)
+);
+`else
+ff CARRY_OF_1240 (
+    .clk(clk),
+    .set_l(s_1241),
+    .rst_l(EROF9), 
+    .set_p(1'b0),
+    .rst_p(HOME1),
+    .tog_p(1'b0),
+    .q(ACOF1),
+    .q_n(ACOF2)
+);
+`endif
+
+`ifndef FOUR_COUNTERS
+wire o_306 = TR13 | PC41 | PC22 | PC11;
+wire o_308 = EMD4 | TC04 | PS74;
+wire o_302 = EMD4 | TFG2 | PS74;
+wire o_310 = EEN42 | TC04 | PS64;
+wire o_304 = EEN42 | TFG2 | PS64;
+wire o_312 = EEN42 | EEN22 | TR03 | PS74;
+wire o_048 = TFE2 | TFF1 | TCX5 | EMU2 | PC41 | PC22 | PC12;
+wire o_039 = TFE2 | TFF1 | TCX5 | EDV2 | ACOF2 | DSZ3;
+wire o_097 = TCX5 | TR14 | RSLO3 | M1L4;
+wire o_099 = TC03 | TFG1 | ECD2 | ECFS2 | PS64;
+wire RSUL3 = !(o_306 & o_308 & o_302 & o_310 & o_304 & o_312 & o_048 & o_039 & o_097 & o_099);
+`elsif EC132
+wire RTR13 = !(ESQ1 | TR14 | PC41 | PC22 | PC11);
+wire RSDS6 = ESTO2 | PS154 | TR04;
+wire RSD6 = ESD2 | PS144 | TFG1;
+wire RDMD6 = ESQ1 | EMDQ4 | PS154 | TFG1;
+wire RSDQ6 = ESQ2 | TFG1 | TFF2 | PS154;
+wire RESD3 = !(RSDS6 & RSD6 & RDMD6 & RSDQ6);
+wire SEAC4 = !(RTR13 | RESD3);
+wire o_500 = SEAC4 | TC03;
+wire SEBC4 = !o_500;
+assign SAC9 = !(o_500 | TC03 | TC153 | TB154);
+`else
+wire o_050 = TR14 | PC41 | PC22 | PC11;
+wire o_083 = ESTO2 | PS74 | TR04;
+wire o_084 = ESD2 | PS64 | TFG1;
+wire o_085 = EMD4 | PS74 | TFG1;
+wire RESD3 = !(o_050 & o_083 & o_084 & o_085);
+wire SEAC4 = (!RESD3) | TC03;
+wire SEBC4 = !SEAC4;
+assign SAC9 = !(SEAC4 | TC153 | TB154);
+`endif
+`ifdef FOUR_COUNTERS
+assign SBC9 = !(SEBC4 | TB154);
+`endif
+
+`ifndef FOUR_COUNTERS
+wire RCM3 = !(ACOF2 | TCX5 | TR14 | ASC1);
+`elsif EC132
+wire RURC6 = ERC2 | PS144 | TR03;
+wire RURP6 = ERP2 | PS144;
+wire RURR3 = !(RURC6 & RURP6);
+`else
+wire o_089 = ERC2 | PS64 | TR03;
+wire o_090 = ERP2 | PS64;
+wire RURR3 = !(o_089 & o_090);
+`endif
+`ifdef FOUR_COUNTERS
+
+`endif
+`ifdef EC132
+wire ROLQ6 = ESQ2 | DSZ3 | PS144 | TCX5 | TR04;
+wire RSUQ6 = TFG1 | PC81 | PC41 | PC22 | PC11;
+wire RS1L6 = M1L4 | TCX5 | TR14;
+wire RS2L6 = M2L4 | TCX5 | TFE2 | TFF1;
+wire RUDE6 = ECD2 | ECFS2 | PS144 | TFG1;
+wire R01Q6 = ESQ2 | PS154 | TR04;
+wire R10Q6 = ESQ2 | PS154 | TR14;
+wire RSUL3 = !(ROLQ6 & RSUQ6 & RS1L6 & RS2L6 & RUDE6 & R01Q6 & R10Q6);
+`elsif FOUR_COUNTERS
+wire o_097 = M1L4 | TCX5 | TR14;
+wire o_098 = M2L4 | TCX5 | TFE2 | TFF1;
+wire o_099 = ECD2 | ECFS2 | PS64 | TFG1;
+wire RSUL3 = !(o_097 & o_098 & o_099);
+`endif
+`ifdef FOUR_COUNTERS
+
+`endif
+`ifdef EC132
+wire RRCU6 = ERC2 | PS144 | TFG1;
+wire RRPU6 = ERP2 | PS144 | TFG1 | TR13;
+wire RRRU3 = !(RRCU6 & RRPU6);
+`elsif FOUR_COUNTERS
+wire o_088 = ERC2 | PS64 | TFG1;
+wire o_091 = ERP2 | PS64 | TFG1 | TR13;
+wire RRRU3 = !(o_088 & o_091);
+`endif
+`ifdef FOUR_COUNTERS
+
+wire RCM3 = !(ASC1 | ACOF2 | TCX5 | TR14);
+`endif
+wire AIRS3 = !(MSU4 | TCX5 | TR04);
+`ifndef FOUR_COUNTERS
+assign AIRX3 = !(TC14 | TR14 | PC41 | PC22 | PC11);
+wire AIRA3 = !(TR04 | TCX5 | MAD4);
+assign RSLO3 = !(TFH2 | TFJ2 | TFK2 | TFL2 | TFG1 | EDPS2 | MSU3 | PS73 | PC12);
+wire o_102 = ECD2 | ECFS2 | TR04 | PS64;
+wire o_303 = EMD4 | TR14 | PS74;
+wire o_305 = EEN42 | TR14 | PS64;
+wire o_050 = TR14 | PC41 | PC22 | PC11;
+wire RERD3 = !(o_102 & o_303 & o_305 & o_050);
+wire o_031 = YCPR4 | PC41 | PC21 | PC11;
+wire o_090 = EEN22 | EEN12 | PS64;
+wire o_089 = EEN41 | EEN21 | EEN12 | PS64 | TR03;
+wire RURR3 = !(o_031 & o_090 & o_089);
+wire o_091 = EEN22 | EEN12 | TFG1 | TR13 | TC03 | PS64;
+wire o_088 = EEN41 | EEN21 | EEN12 | TFG1 | TC03 | PS64;
+wire RRRU3 = !(o_091 & o_088);
+wire SEAD4 = !(RURR3 | RSUL3);
+wire SEDC4 = !(RSUL3 | RRRU3 | RCM3);
+wire SEAC4 = !SEDC4;
+wire i_135 = !(TFH2 | TFJ2 | TFK2 | TR14 | TFL2 | MAD4 | EMU2);
+wire i_133 = !(RCM3 | AIRS3);
+wire AIDS3 = !(XRDL4 | i_133);
+wire CERD4 = !(RCM3 | RSLO3 | RERD3 | MSU3);
+`elsif EC132
+assign AIRX3 = !(ESQ1 | PC41 | PC22 | PC11 | TC14 | TR14);
+`else
+assign AIRX3 = !(PC41 | PC22 | PC11 | TC14 | TR14);
+`endif
+`ifdef FOUR_COUNTERS
+wire AIRA3 = !(MAD4 | TCX5 | TR04);
+`endif
+`ifdef EC132
+wire RERD3 = !(ECD2 | ECFS2 | PS144 | TR04);
+wire R10F3 = !(ML1Q3 | MMDL3 | M1L4 | TC154 | HOME1);// typo? M1LQ3 or ML1Q3?
+wire R20F3 = !(ESQ1 | M2L4 | EDPS2 | TC154 | HOME1);
+assign RCR03 = !(TR04 | PC81 | PC41 | PC22 | PC11);
+`elsif FOUR_COUNTERS
+wire RERD3 = !(ECD2 | ECFS2 | PS64 | TR04);
+wire R10F3 = !(MMDL3 | M1L4 | TC154 | HOME1);
+wire R20F3 = !(M2L4 | EDPS2 | TC154 | HOME1);
+`endif
+
+`ifndef FOUR_COUNTERS
+assign SDA9 = !(TB154 | TCX5 | MSU4 | TR04);
+assign SAD9 = !(SEAD4 | TB154);
+assign SAC9 = !(TB154 | SEAC4);
+assign SDC9 = !(SEDC4 | TB154);
+`else
+assign SDA9 = !(MSU4 | TCX5 | TR04 | TB154);
+`endif
+
+`ifndef FOUR_COUNTERS
+// CID9 can emit a glitch when the timing chain ripple carries, so
+// add a glitch filter for CID9
+wire CID9_pre = i_135 | AIDS3;
+`else
+wire SEAD4 = !(RURR3 | YCPR3 | RSUL3);
+assign SAD9 = !(TB154 | SEAD4);
+
+`endif
+`ifdef EC132
+wire SEDB4 = !(RSUL3 | SEBC4 | RRRU3 | RCM3);
+wire o_600 = SEDB4 | TC03;
+wire SEAB4 = !o_600;
+`elsif FOUR_COUNTERS
+wire SEDB4 = (!(RSUL3 | SEBC4 | RRRU3 | RCM3)) | TC03;
+wire SEAB4 = !SEDB4;
+`endif
+`ifdef FOUR_COUNTERS
+assign SAB9 = !(TB154 | SEAB4);
+`endif
+`ifdef EC132
+assign SDB9 = !(o_600 | TC03 | TB154);
+`elsif FOUR_COUNTERS
+assign SDB9 = !(SEDB4 | TB154);
+`endif
+`ifdef FOUR_COUNTERS
+
+wire REID4 = !(RCM3 | AIRS3);
+assign CRA9 = !(AIRS3 | AIRX3 | AIRA3 | TB154);
+assign CED55 = RSLO5 | ARDS3;
+assign RSLO5 = R10F3 | R20F3;
+`endif
+`ifdef EC132
+wire CERD4 = !(ARDS3 | RCM3 | RERD3 | RSLO5 | RCR03);
+`elsif FOUR_COUNTERS
+wire CERD4 = !(ARDS3 | RCM3 | RERD3 | RSLO5);
+`endif
+`ifdef FOUR_COUNTERS
+assign CRD9 = !(TB154 | CERD4);
+
+wire AIDM3 = !(EMU2 | MAD4 | CDZ3 | TC154 | TR14);
+wire AIDS3 = !(XRDL4 | REID4);
+
+// CID9 can emit a glitch when the timing chain ripple carries, so
+// add a glitch filter for CID9
+wire CID9_pre = AIDM3 | AIDS3;
+`endif
+reg [1:0] CID9_filt;
+always @(`CLK_EDGE) begin
+    CID9_filt <= {CID9_filt[0], CID9_pre};
+    if (CID9_filt == 2'b11)
+        CID9 <= 1'b1;
+    if (CID9_filt == 2'b0)
+        CID9 <= 1'b0;
+end
+`ifndef FOUR_COUNTERS
+
+assign CRA9 = !(AIRS3 | AIRX3 | AIRA3 | TB154);
+assign CRD9 = !(TB154 | CERD4);
+`endif
+
+endmodule
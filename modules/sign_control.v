@@ -0,0 +1,232 @@
+// Friden EC-130 sign control
+//
+// the SIGN_CONT flip-flop and the add, subtract and multiply line
+// gating around it; the 4-counter machines (FOUR_COUNTERS) gate them
+// from their own entry flip-flops, and EC132 adds the square root's
+
+`include "clock.vh"
+
+module sign_control (
+    input clk,
+    input TFF1,
+    input TC14,
+    input XRDL4,
+    input key_sub,
+    input DSZ6,
+    input EDPS2,
+    input ECFS2,
+    input DSZ3,
+    input ECD2,
+    input PC41,
+    input PC21,
+    input PC12,
+    input ECF2,
+    input PC42,
+    input EMU2,
+    input EDV2,
+    input CDZ3,
+    input ACOF1,
+    input ACOF2,
+    output ASC1,
+    output DBSL3,
+    output MMDL3,
+    output ME1L3,
+    output MA1L3,
+    output M1L4,
+    output MAIM3,
+    output MAIS3,
+    output MAD4,
+`ifdef FOUR_COUNTERS
+    input EAS2,
+    input EAS1,
+    input HOME1,
+    input PC22,
+    input PC11,
+    output M2LM3,
+    output MIAD3,
+    output M2L4,
+    output MIAD4,
+    output MSDS3,
+    output ARDS3,
+`else
+    input EEN12,
+    input EEN42,
+    input KBD3,
+    input ERF3,
+    output MSU3,
+`endif
+`ifdef EC132
+    input PS144,
+    input PC81,
+    input PS154,
+    input ESQ1,
+    input EMDQ4,
+    input ESQ2,
+    input PC82,
+    output ML1Q3,
+    output ML2Q3,
+`else
+    input PS64,
+    input EMD4,
+    input PS74,
+`endif
+    output MSU4
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+`ifndef FOUR_COUNTERS
+wire i_008 = !(EEN12 | EEN42 | PS64 | TFF1 | TC14 | XRDL4);
+wire r_1143;
+ac AC_1143 (
+    .clk(clk),
+    .en(key_sub),
+    .trans(KBD3),
+    .out(r_1143)
+);
+`elsif EC132
+wire RSCT3 = !(PS144 | TC14 | EAS2 | TFF1 | XRDL4);
+wire r_1154;
+ac AC_1154 (
+    .clk(clk),
+    .en(key_sub),
+    .trans(EAS1),
+    .out(r_1154)
+);
+`else
+wire RSCT3 = !(PS64 | TC14 | EAS2 | TFF1 | XRDL4);
+wire r_1144;
+ac AC_1144 (
+    .clk(clk),
+    .en(key_sub),
+    .trans(EAS1),
+    .out(r_1144)
+);
+`endif
+wire ASC2;
+`ifndef FOUR_COUNTERS
+ff SIGN_CONT_1140 (
+    .clk(clk),
+    .rst_l(r_1143),
+    .set_l(ERF3),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(i_008),
+    .q(ASC1),
+    .q_n(ASC2)
+);
+`elsif EC132
+ff SIGN_CONT_1150 (
+    .clk(clk),
+    .rst_l(r_1154),
+    .set_l(1'b0),
+    .set_p(HOME1 | EAS1),
+    .rst_p(1'b0),
+    .tog_p(RSCT3),
+    .q(ASC1),
+    .q_n(ASC2)
+);
+`else
+ff SIGN_CONT_1140 (
+    .clk(clk),
+    .rst_l(r_1144),
+    .set_l(1'b0),
+    .set_p(HOME1 | EAS1),
+    .rst_p(1'b0),
+    .tog_p(RSCT3),
+    .q(ASC1),
+    .q_n(ASC2)
+);
+`endif
+
+wire DBDE3 = !(DSZ6 | EDPS2);
+assign DBSL3 = !(EDPS2 | ECFS2);
+
+`ifndef FOUR_COUNTERS
+assign MMDL3 = !(PS64 | DSZ3 | EMD4);
+`elsif EC132
+`else
+assign ME1L3 = !(PS74 | DBSL3 | DBDE3 | ECD2);
+`endif
+`ifndef EC132
+assign MA1L3 = !(PC41 | PC21 | PC12 | ECF2 | DSZ3);
+`endif
+`ifndef FOUR_COUNTERS
+assign ME1L3 = !(PS74 | ECD2 | DBDE3 | DBSL3);
+assign M1L4 = !(MMDL3 | MA1L3 | ME1L3);
+`elsif EC132
+assign ML1Q3 = !(PC81 | PC42 | PC12); // typo? M1LQ3 or ML1Q3?
+assign ME1L3 = !(PS154 | DBSL3 | DBDE3 | ECD2);
+assign MA1L3 = !(PC81 | PC41 | PC21 | PC12 | ECF2 | DSZ3);
+assign MMDL3 = !(ESQ1 | DSZ3 | PS144 | EMDQ4);
+`else
+assign MMDL3 = !(DSZ3 | PS64 | EMD4);
+`endif
+`ifdef FOUR_COUNTERS
+assign M2LM3 = !(EMU2 | PC41 | PC22 | PC12);
+`endif
+`ifdef EC132
+assign ML2Q3 = !(PC81 | PC42 | PC11);
+`endif
+`ifdef FOUR_COUNTERS
+wire MAID3 = !(DSZ3 | EDV2 | PC42 | PC21 | PC12);
+`endif
+`ifdef EC132
+wire MAIQ3 = !(ESQ2 | PC82 | PC42 | PC11);
+`endif
+`ifdef FOUR_COUNTERS
+assign MAIM3 = !(EMU2 | CDZ3 | PC42 | PC21 | PC12);
+`endif
+`ifdef EC132
+assign MAIS3 = !(EAS2 | PS154 | ASC2);
+`elsif FOUR_COUNTERS
+assign MAIS3 = !(EAS2 | PS74 | ASC2);
+`endif
+`ifdef FOUR_COUNTERS
+assign MIAD3 = !(ACOF1 | PC42 | PC21 | PC11 | EDV2);
+wire MSID6 = EDV2 | PC41 | PC22 | PC12;
+`endif
+`ifdef EC132
+wire MISQ6 = ESQ2 | PC82 | PC41 | PC11;
+wire MSIS6 = PS154 | ASC1;
+`elsif FOUR_COUNTERS
+wire MSIS6 = PS74 | ASC1;
+`endif
+
+`ifndef FOUR_COUNTERS
+wire o_311 = ACOF2 | EDV2;
+wire o_021 = EEN42 | EEN12 | ASC2 | PS74;
+assign MAIS3 = !(o_311 & o_021);
+assign MAIM3 = !(CDZ3 | EMU2 | PC42 | PC21);
+wire o_043 = ACOF2 | EMU2;
+wire o_018 = MAIS3 | MAIM3;
+assign MAD4 = !(o_043 & o_018);
+wire o_023 = ACOF1 | ASC1 | PS74;
+wire o_045 = ACOF1 | EDV2 | PC42 | PC21;
+assign MSU3 = !(o_023 & o_045);
+assign MSU4 = !MSU3;
+`elsif EC132
+assign M1L4 = !(ML1Q3 | ME1L3 | MA1L3 | MMDL3);
+assign M2L4 = !(M2LM3 | ML2Q3 | MAID3);
+assign MAD4 = !(ACOF2 & (MAID3 | MAIQ3 | MAIM3 | MAIS3));
+`else
+assign M1L4 = !(ME1L3 | MA1L3 | MMDL3);
+assign M2L4 = !(M2LM3 | MAID3);
+assign MAD4 = !(ACOF2 & (MAID3 | MAIM3 | MAIS3));
+`endif
+`ifdef FOUR_COUNTERS
+assign MIAD4 = !MIAD3;
+`endif
+`ifdef EC132
+assign MSDS3 = !(MSID6 & MISQ6 & MSIS6);
+`elsif FOUR_COUNTERS
+assign MSDS3 = !(MSID6 & MSIS6);
+`endif
+`ifdef FOUR_COUNTERS
+assign MSU4 = !(MIAD3 | MSDS3);
+assign ARDS3 = !MSU4;
+`endif
+
+endmodule
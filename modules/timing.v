@@ -0,0 +1,157 @@
+// Friden EC-130 timing generator
+//
+// the HOME flip-flop and the TFA..TFN (and TFP) timing chain, with all
+// stages held in one vector instead of an ff instance each, so the
+// whole chain is updated with a few word operations per clock
+//
+// it is not a plain binary counter: each stage of the real chain
+// toggles one master clock after the edge of the stage before it, and
+// the rest of the machine sees that ripple (hence the CID9 filter in
+// top.v), so the stages keep the same edge detection as modules/ff.v
+// and the outputs are identical to the discrete chain clock for clock
+//
+// COUNTERS selects the chain: 3 for the EC-130 with three digit
+// counters, 4 for the later one (ec130_4cnt, ec132), where M is set by
+// an AC gate and reset by TFL2, and the extra TFP stage follows TFL2
+
+`include "clock.vh"
+
+module timing #(
+    parameter COUNTERS = 3
+) (
+    input clk,
+    input TOSC4,
+    input CIA9,
+    input ESTA3,
+    output HOME1,
+    output HOME2,
+    output TCLK3,
+    output TFA1,
+    output TFA2,
+    output TFB1,
+    output TFB2,
+    output TFC1,
+    output TFC2,
+    output TFD1,
+    output TFD2,
+    output TFE1,
+    output TFE2,
+    output TFF1,
+    output TFF2,
+    output TFG1,
+    output TFG2,
+    output TFH1,
+    output TFH2,
+    output TFJ1,
+    output TFJ2,
+    output TFK1,
+    output TFK2,
+    output TFL1,
+    output TFL2,
+    output TFM1,
+    output TFM2,
+    output TFN1,
+    output TFN2,
+    output TFP1,
+    output TFP2
+);
+
+// stages A to N in bits 0 to 12
+reg [12:0] tf;
+reg home;
+
+// previous value of each edge triggered input, as in modules/ff.v
+reg [12:0] prev_tog;
+reg prev_set_f;
+reg prev_rst_g;
+reg prev_rst_home;
+reg prev_set_home;
+
+assign HOME1 = home;
+assign HOME2 = !home;
+assign TCLK3 = !(TOSC4 || home);
+
+// what each stage toggles on: the master clock for A, TFG1 for H and
+// the inverted output of the stage before for the others
+wire [12:0] tog_in = {~tf[11:7], tf[6], ~tf[5:0], TCLK3};
+
+// M only toggles in the three counter chain
+localparam [12:0] TOG_MASK = COUNTERS == 4 ? 13'h17ff : 13'h1fff;
+wire [12:0] toggled = tf ^ (tog_in & ~prev_tog & TOG_MASK);
+
+// F is set by TFG1, G reset by HOME2
+wire set_f = tf[6] && !prev_set_f;
+wire rst_g = !home && !prev_rst_g;
+
+// M (and P) in the four counter chain
+wire set_m;
+wire rst_m;
+
+generate
+if (COUNTERS == 4) begin : four
+    reg prev_rst_m;
+    reg prev_set_p;
+    reg prev_rst_p;
+    reg p;
+
+    ac AC_M (
+        .clk(clk),
+        .en(!tf[11]),
+        .trans(!tf[10]),
+        .out(set_m)
+    );
+
+    assign rst_m = !tf[10] && !prev_rst_m;
+    assign TFP1 = p;
+    assign TFP2 = !p;
+
+    always @(`CLK_EDGE) begin
+        prev_rst_m <= !tf[10];
+        prev_set_p <= !tf[10];
+        prev_rst_p <= !tf[12];
+
+        if (set_m)
+            p <= 1'b1;
+        else if (!prev_rst_p && !tf[12])
+            p <= 1'b0;
+        else if (!prev_set_p && !tf[10])
+            p <= 1'b1;
+    end
+end
+else begin : three
+    assign set_m = 1'b0;
+    assign rst_m = 1'b0;
+    assign TFP1 = 1'b0;
+    assign TFP2 = 1'b1;
+end
+endgenerate
+
+always @(`CLK_EDGE) begin
+    prev_tog <= tog_in;
+    prev_set_f <= tf[6];
+    prev_rst_g <= !home;
+    prev_rst_home <= CIA9;
+    prev_set_home <= !tf[10];
+
+    // A and B are held set while HOME is; set and reset have priority
+    // over toggling, as in modules/ff.v
+    tf <= {toggled[12],
+           set_m || (toggled[11] && !rst_m),
+           toggled[10:7],
+           toggled[6] && !rst_g,
+           toggled[5] || set_f,
+           toggled[4:2],
+           toggled[1:0] | {2{home}}};
+
+    if (ESTA3)
+        home <= 1'b0;
+    else if (!prev_rst_home && CIA9)
+        home <= 1'b0;
+    else if (!prev_set_home && !tf[10])
+        home <= 1'b1;
+end
+
+assign {TFN1, TFM1, TFL1, TFK1, TFJ1, TFH1, TFG1, TFF1, TFE1, TFD1, TFC1, TFB1, TFA1} = tf;
+assign {TFN2, TFM2, TFL2, TFK2, TFJ2, TFH2, TFG2, TFF2, TFE2, TFD2, TFC2, TFB2, TFA2} = ~tf;
+
+endmodule
@@ -0,0 +1,507 @@
+// Friden EC-130 master oscillator and timing chain
+//
+// HOME and the TFA..TFN chain, either as modules/timing.v (TIMING_GEN)
+// or as the discrete flip-flops, and the TR, TC and TB decodes of it;
+// FOUR_COUNTERS (ec130_4cnt, ec132) has the 4-counter chain, and EC132
+// renumbers its cards and adds the square root's decodes
+
+`include "clock.vh"
+
+module timing_chain (
+    input clk,
+    input clk_div_8,
+    input CIA9,
+    input ESTA3,
+    input EDV1,
+    output HOME1,
+    output TFA1,
+    output TFA2,
+    output TFB1,
+    output TFB2,
+    output TFC1,
+    output TFC2,
+    output TFD1,
+    output TFD2,
+    output TFE1,
+    output TFE2,
+    output TFF1,
+    output TFF2,
+    output TFG1,
+    output TFG2,
+    output TFH1,
+    output TFH2,
+    output TFJ1,
+    output TFJ2,
+    output TFK1,
+    output TFK2,
+    output TFL1,
+    output TFL2,
+    output TFM1,
+    output TFM2,
+    output TFN1,
+    output TFN2,
+    output TB154,
+    output TR03,
+    output TR04,
+    output TR13,
+    output TR14,
+    output TC03,
+    output TC13,
+    output TC14,
+    output TC23,
+    output TC24,
+`ifdef EC132
+    input ESQ2,
+    input XD137,
+    input ML2Q3,
+    output DP0Q3,
+`endif
+`ifdef FOUR_COUNTERS
+    output TCLK2,
+    output TC153,
+    output TC154,
+`else
+    output TCLK3,
+    output TC04,
+`endif
+    output TCX5
+);
+/*verilator hier_block*/
+
+// get rid of annoying unused warnings
+/* verilator lint_off UNUSED */
+
+wire TOSC4 = clk_div_8;
+
+`ifdef TIMING_GEN
+// the same chain as one vectorized module, see ../modules/timing.v
+wire HOME2;
+wire TFP1, TFP2;
+
+`ifndef FOUR_COUNTERS
+timing #(.COUNTERS(3)) t (
+`else
+timing #(.COUNTERS(4)) t (
+`endif
+    .clk(clk),
+    .TOSC4(TOSC4),
+    .CIA9(CIA9),
+    .ESTA3(ESTA3),
+    .HOME1(HOME1),
+    .HOME2(HOME2),
+`ifndef FOUR_COUNTERS
+    .TCLK3(TCLK3),
+`else
+    .TCLK3(TCLK2),
+`endif
+    .TFA1(TFA1),
+    .TFA2(TFA2),
+    .TFB1(TFB1),
+    .TFB2(TFB2),
+    .TFC1(TFC1),
+    .TFC2(TFC2),
+    .TFD1(TFD1),
+    .TFD2(TFD2),
+    .TFE1(TFE1),
+    .TFE2(TFE2),
+    .TFF1(TFF1),
+    .TFF2(TFF2),
+    .TFG1(TFG1),
+    .TFG2(TFG2),
+    .TFH1(TFH1),
+    .TFH2(TFH2),
+    .TFJ1(TFJ1),
+    .TFJ2(TFJ2),
+    .TFK1(TFK1),
+    .TFK2(TFK2),
+    .TFL1(TFL1),
+    .TFL2(TFL2),
+    .TFM1(TFM1),
+    .TFM2(TFM2),
+    .TFN1(TFN1),
+    .TFN2(TFN2),
+    .TFP1(TFP1),
+    .TFP2(TFP2)
+);
+`else
+wire HOME2;
+ff HOME_1450 (
+    .clk(clk),
+    .rst_l(ESTA3),
+    .set_l(1'b0),
+    .rst_p(CIA9),
+    .set_p(TFL2),
+    .tog_p(1'b0),
+    .q(HOME1),
+    .q_n(HOME2)
+);
+
+`ifndef FOUR_COUNTERS
+assign TCLK3 = !(TOSC4 || HOME1);
+`else
+wire TOSC3 = !(TOSC4 | HOME1);
+`endif
+wire HOME3 = !HOME2;
+
+`ifndef FOUR_COUNTERS
+ff A_1470 (
+    .clk(clk),
+    .set_l(HOME3),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TCLK3),
+    .q(TFA1),
+    .q_n(TFA2)
+);
+`elsif EC132
+// remove CLOCK divider to mimic timing of 3-counter version
+/*
+wire TCLK1, TCLK2;
+ff CLOCK_1480 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TOSC3),
+    .q(TCLK1),
+    .q_n(TCLK2)
+);
+*/
+`else
+// remove CLOCK divider to mimic timing of 3-counter version
+/*
+wire TCLK1, TCLK2;
+ff CLOCK_1460 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TOSC3),
+    .q(TCLK1),
+    .q_n(TCLK2)
+);
+*/
+`endif
+`ifdef FOUR_COUNTERS
+
+assign TCLK2 = TOSC3;
+
+`endif
+`ifdef FOUR_COUNTERS
+`ifndef EC132
+ff A_1470 (
+`else
+ff A_1490 (
+`endif
+    .clk(clk),
+    .set_l(HOME3),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TCLK2),
+    .q(TFA1),
+    .q_n(TFA2)
+);
+`endif
+
+`ifndef EC132
+ff B_1480 (
+`else
+ff B_1500 (
+`endif
+    .clk(clk),
+    .set_l(HOME3),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFA2),
+    .q(TFB1),
+    .q_n(TFB2)
+);
+
+`ifndef EC132
+ff C_1490 (
+`else
+ff C_1510 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFB2),
+    .q(TFC1),
+    .q_n(TFC2)
+);
+
+`ifndef EC132
+ff D_1500 (
+`else
+ff D_1520 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFC2),
+    .q(TFD1),
+    .q_n(TFD2)
+);
+
+`ifndef EC132
+ff E_1510 (
+`else
+ff E_1530 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFD2),
+    .q(TFE1),
+    .q_n(TFE2)
+);
+
+`ifndef EC132
+ff F_1520 (
+`else
+ff F_1540 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .rst_p(1'b0),
+`ifndef FOUR_COUNTERS
+    .set_p(TFG1),
+`else
+    .set_p(TFG3),
+`endif
+    .tog_p(TFE2),
+    .q(TFF1),
+    .q_n(TFF2)
+);
+
+`ifndef EC132
+ff G_1530 (
+`else
+ff G_1550 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(HOME2),
+    .tog_p(TFF2),
+    .q(TFG1),
+    .q_n(TFG2)
+);
+`ifdef FOUR_COUNTERS
+wire TFG3 = !TFG2;
+`endif
+
+`ifndef EC132
+ff H_1540 (
+`else
+ff H_1560 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+`ifndef FOUR_COUNTERS
+    .tog_p(TFG1),
+`else
+    .tog_p(TFG3),
+`endif
+    .q(TFH1),
+    .q_n(TFH2)
+);
+
+`ifndef FOUR_COUNTERS
+ff J_1540 (
+`elsif EC132
+ff J_1570 (
+`else
+ff J_1550 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFH2),
+    .q(TFJ1),
+    .q_n(TFJ2)
+);
+
+`ifndef FOUR_COUNTERS
+ff K_1540 (
+`elsif EC132
+ff K_1580 (
+`else
+ff K_1560 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFJ2),
+    .q(TFK1),
+    .q_n(TFK2)
+);
+
+`ifndef FOUR_COUNTERS
+ff L_1540 (
+`elsif EC132
+ff L_1590 (
+`else
+ff L_1570 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFK2),
+    .q(TFL1),
+    .q_n(TFL2)
+);
+
+`ifndef FOUR_COUNTERS
+ff M_1540 (
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFL2),
+    .q(TFM1),
+    .q_n(TFM2)
+);
+`elsif EC132
+wire s_1601;
+ac AC_1601 (
+    .clk(clk),
+    .en(TFM2),
+    .trans(TFL2),
+    .out(s_1601)
+);
+ff M_1600 (
+    .clk(clk),
+    .set_l(s_1601),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(TFL2),
+    .tog_p(1'b0),
+    .q(TFM1),
+    .q_n(TFM2)
+);
+`else
+wire s_1581;
+ac AC_1581 (
+    .clk(clk),
+    .en(TFM2),
+    .trans(TFL2),
+    .out(s_1581)
+);
+ff M_1580 (
+    .clk(clk),
+    .set_l(s_1581),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(TFL2),
+    .tog_p(1'b0),
+    .q(TFM1),
+    .q_n(TFM2)
+);
+`endif
+
+`ifndef FOUR_COUNTERS
+ff N_1540 (
+`elsif EC132
+ff N_1610 (
+`else
+ff N_1590 (
+`endif
+    .clk(clk),
+    .set_l(1'b0),
+    .rst_l(1'b0),
+    .set_p(1'b0),
+    .rst_p(1'b0),
+    .tog_p(TFM2),
+    .q(TFN1),
+    .q_n(TFN2)
+);
+`ifdef FOUR_COUNTERS
+
+wire TFP1, TFP2;
+`endif
+`ifdef FOUR_COUNTERS
+`ifndef EC132
+ff P_1590 (
+`else
+ff P_1620 (
+`endif
+    .clk(clk),
+`ifndef EC132
+    .set_l(s_1581),
+`else
+    .set_l(s_1601),
+`endif
+    .rst_l(1'b0),
+    .set_p(TFL2),
+    .rst_p(TFN2),
+    .tog_p(1'b0),
+    .q(TFP1),
+    .q_n(TFP2)
+);
+`endif
+`endif
+
+assign TB154 = TFA2 | TFB2 | TFC2 | TFD2;
+
+assign TR03 = !(TFE2 | TFG2);
+assign TR04 = !TR03;
+
+assign TR13 = !(TFE1 | TFF1 | TFG1);
+assign TR14 = !TR13;
+
+assign TC03 = !(TFH1 | TFJ1 | TFK1 | TFL1);
+`ifndef FOUR_COUNTERS
+assign TC04 = !TC03;
+`endif
+
+assign TC13 = !(TFH2 | TFJ1 | TFK1 | TFL1);
+assign TC14 = !TC13;
+
+assign TC23 = !(TFH1 | TFJ2 | TFK1 | TFL1);
+assign TC24 = !TC23;
+
+`ifndef FOUR_COUNTERS
+assign TCX5 = !(TFJ1 | TFK1 | TFL1) | !(TFH2 | TFJ2 | TFK2 | TFL2 | EDV1);
+`else
+assign TC153 = !(TFH2 | TFJ2 | TFK2 | TFL2);
+assign TC154 = !TC153;
+`endif
+`ifdef EC132
+assign DP0Q3 = !(ESQ2 | XD137);
+wire MS2Q3 = !(ESQ2 | ML2Q3);
+`endif
+`ifdef FOUR_COUNTERS
+wire TC013 = !(TFJ1 | TFK1 | TFL1);
+`endif
+`ifdef EC132
+wire MRL4 = !(DP0Q3 | MS2Q3 | EDV1 | TC154);
+assign TCX5 =  TC013 | MRL4;
+`elsif FOUR_COUNTERS
+assign TCX5 =  TC013 | !(EDV1 | TC154);
+`endif
+
+endmodule
@@ -0,0 +1,251 @@
+// Friden simulator batch mode
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <verilated.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "batch.h"
+#include "snapshot.h"
+#include "dl.h"
+#include "engine.h"
+#include "fault.h"
+#include "opcache.h"
+#include "explore.h"
+
+#if VM_COVERAGE
+#include "verilated_cov.h"
+
+// toggle counts are written out and cleared after every operation,
+// so they can be broken down by operation type
+static void toggle_dump(const char *name, int n) {
+    char filename[256];
+    snprintf(filename, sizeof(filename), "logs/toggle_%s_%d.dat", name, n);
+#if defined(VERILATOR_VERSION_INTEGER) && VERILATOR_VERSION_INTEGER >= 4200000
+    Verilated::threadContextp()->coveragep()->write(filename);
+    Verilated::threadContextp()->coveragep()->zero();
+#else
+    VerilatedCov::write(filename);
+    VerilatedCov::zero();
+#endif
+}
+#endif
+
+// loads "r:value]" straight into the delay line
+static int batch_load(sim_t *s, const char *arg, const char *name) {
+    const char *colon = strchr(arg, ':');
+    const char *end = strchr(arg, ']');
+    if (!colon || !end || colon > end) {
+        fprintf(stderr, "bad register load in operation %s\n", name);
+        return 1;
+    }
+
+    std::string reg(arg, colon - arg);
+    std::string value(colon + 1, end - colon - 1);
+    int r = dl_reg_from_name(reg.c_str());
+    if (r < 0) {
+        fprintf(stderr, "unknown register %s in operation %s\n", reg.c_str(), name);
+        return 1;
+    }
+
+    // the functional engine just takes the value
+    if (s->engine) {
+        uint8_t digits[16];
+        if (dl_parse(value.c_str(), s->top->sw_dp, digits))
+            return 1;
+        engine_write(s->engine, s->top, r, digits);
+        return 0;
+    }
+
+    if (dl_write(s, r, value.c_str())) {
+        fprintf(stderr, "can't load %s into register %s in operation %s\n",
+                value.c_str(), reg.c_str(), name);
+        return 1;
+    }
+    return 0;
+}
+
+// press to kbd_ack and press to release times of every key batch_main()
+// pressed on its own model, for the summary
+static sim_t *key_sim;
+static std::vector<uint64_t> key_acks, key_releases;
+static uint64_t key_no_acks;
+
+// prints the minimum, median and maximum of v
+static void print_key_times(const char *what, std::vector<uint64_t> &v) {
+    if (v.empty())
+        return;
+    std::sort(v.begin(), v.end());
+    printf("       press to %s: %lu min, %lu median, %lu max cycles\n",
+           what, v.front(), v[v.size() / 2], v.back());
+}
+
+int batch_run(sim_t *s, const batch_op &op) {
+    for (const char *k = op.keys; *k; k++) {
+        // [r:value] loads a register directly, e.g. [1:12.5]
+        if (*k == '[') {
+            if (batch_load(s, k + 1, op.name))
+                return 1;
+            k = strchr(k, ']');
+            continue;
+        }
+        if (!sim_press(s, *k)) {
+            fprintf(stderr, "unknown key '%c' in operation %s\n", *k, op.name);
+            return 1;
+        }
+        if (s == key_sim) {
+            if (s->press_ack)
+                key_acks.push_back(s->press_ack);
+            else
+                key_no_acks++;
+            key_releases.push_back(s->press_release);
+        }
+        // with adaptive holds, only the end of an operation needs
+        // the registers to have settled
+        int64_t t = s->keyhold == KEYHOLD_ADAPTIVE && k[1] ?
+            sim_wait_ready(s, OP_TIMEOUT) : sim_wait_idle(s, OP_TIMEOUT);
+        if (t < 0) {
+            printf("%-10s hung after %c at cycle %lu\n", op.name, *k, s->cycle);
+            sim_print_regs(stdout, s->top);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// compares the decoded registers of the two models
+static int batch_same_regs(Vtop *a, Vtop *b) {
+    return !memcmp(&a->reg_s[0], &b->reg_s[0], 16) &&
+           !memcmp(&a->reg_0[0], &b->reg_0[0], 16) &&
+           !memcmp(&a->reg_1[0], &b->reg_1[0], 16) &&
+           !memcmp(&a->reg_2[0], &b->reg_2[0], 16) &&
+           !memcmp(&a->reg_3[0], &b->reg_3[0], 16) &&
+           !memcmp(&a->reg_4[0], &b->reg_4[0], 16) &&
+           a->lamp_overflow == b->lamp_overflow;
+}
+
+int batch_main(Vtop *top, VerilatedVcdC *tfp) {
+    sim_t s;
+    sim_init(&s, top);
+    s.tfp = tfp;
+    s.keyhold = sim_keyhold_arg(KEYHOLD_ADAPTIVE);
+
+    // the functional engine, in place of the model or alongside it
+    int engine = engine_arg();
+    sim_t f;
+    Vtop *f_top = nullptr;
+    if (engine == ENGINE_FUNC)
+        s.engine = engine_new(top);
+    else if (engine == ENGINE_CHECK) {
+        f_top = new Vtop;
+        f_top->sw_dp = top->sw_dp;
+        key_release_all(f_top);
+        f_top->clk = 0;
+        sim_init(&f, f_top);
+        f.engine = engine_new(f_top);
+        f.keyhold = s.keyhold;
+    }
+    int mismatches = 0;
+
+    // with +explore+<depth>, key sequences are searched rather than run
+    if (explore_arg())
+        return explore_main(&s);
+
+    // with +faults+<n>, every operation is first run n times with faults
+    int faults = fault_arg();
+    if (faults > 0 && fault_start(&s))
+        return 1;
+
+    // with +opcache+<entries>, operations seen before are restored
+    if (opcache_start())
+        return 1;
+
+    // split +keys+ into operations
+    std::vector<std::string> script;
+    std::vector<batch_op> ops;
+    const char *keys = sim_plusarg("keys");
+    if (keys) {
+        const char *p = keys;
+        while (*p) {
+            size_t len = strcspn(p, ",");
+            script.push_back(std::string(p, len));
+            p += len;
+            if (*p)
+                p++;
+        }
+        for (size_t i = 0; i < script.size(); i++)
+            ops.push_back({"script", script[i].c_str()});
+    }
+    else {
+        for (int i = 0; batch_workload[i].name; i++)
+            ops.push_back(batch_workload[i]);
+    }
+
+    key_sim = &s;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t n = 0; n < ops.size(); n++) {
+        if (faults > 0 && fault_campaign(&s, ops[n], faults))
+            return 1;
+
+        uint64_t t_op = s.cycle;
+        int hit = 0;
+        if (opcache_on ? opcache_run(&s, ops[n], &hit) : batch_run(&s, ops[n]))
+            return 1;
+
+        printf("%-10s %12lu cycles%s%s\n", ops[n].name, s.cycle - t_op,
+               top->lamp_overflow ? "  OVERFLOW" : "", hit ? "  (cached)" : "");
+        sim_print_regs(stdout, top);
+
+        if (f_top) {
+            uint64_t t_f = f.cycle;
+            int status = batch_run(&f, ops[n]);
+            int64_t diff = (int64_t)(f.cycle - t_f) - (int64_t)(s.cycle - t_op);
+            if (status || !batch_same_regs(top, f_top)) {
+                mismatches++;
+                printf("check: %s differs, the functional engine has\n", ops[n].name);
+                sim_print_regs(stdout, f_top);
+            }
+            else
+                printf("check: %s matches, %+ld cycles in the functional engine\n",
+                       ops[n].name, diff);
+        }
+
+#if VM_COVERAGE
+        toggle_dump(ops[n].name, n);
+#endif
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("total: %lu cycles in %.2f s (%.1f kcycles/s)\n",
+           s.cycle, secs, secs > 0 ? s.cycle / secs / 1000.0 : 0.0);
+    printf("keys:  %lu pressed (%s holds), %lu cycles per key overall\n",
+           s.keys, s.keyhold == KEYHOLD_ADAPTIVE ? "adaptive" : "fixed",
+           s.keys ? s.cycle / s.keys : 0);
+    print_key_times("kbd_ack", key_acks);
+    print_key_times("release", key_releases);
+    if (key_no_acks)
+        printf("       %lu keys never acked\n", key_no_acks);
+
+    if (f_top)
+        printf("check: %d of %zu operations differ\n", mismatches, ops.size());
+    if (faults > 0)
+        fault_summary();
+    if (opcache_on)
+        opcache_summary();
+
+    // keep the final state, e.g. as a power-on image
+    const char *save = sim_plusarg("save");
+    if (save && !s.engine && snapshot_save(top, save)) {
+        fprintf(stderr, "can't write snapshot %s\n", save);
+        return 1;
+    }
+
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+// Friden simulator batch mode
+// runs key sequences headlessly, for profiling and scripted tests
+
+#ifndef BATCH_H
+#define BATCH_H
+
+class Vtop;
+class VerilatedVcdC;
+struct sim_t;
+
+// an operation is a key sequence, each key being pressed and then
+// waited on until the machine is idle again
+struct batch_op {
+    const char *name; // operation type, e.g. "mult"
+    const char *keys; // key characters, as in keys.h
+};
+
+// presses the keys of an operation (and does its register loads), then
+// waits until the machine is idle; returns 1 on a key or load that
+// can't be done, or -1 if the machine hangs
+int batch_run(sim_t *s, const batch_op &op);
+
+// the standard workload for a simulator, terminated by {NULL, NULL}
+// each simulator defines its own in workload.cpp
+extern const batch_op batch_workload[];
+
+// runs the operations given with +keys+<ops>, or the standard workload
+// if there are none; ops are separated by commas, e.g. +keys+c,12=,3*
+// [r:value] in an operation loads a register (s or 0 to 4) directly
+// through the delay line instead of keying it in, e.g. [1:12.5][2:3]*
+// keys are held adaptively unless +keyhold+fixed is given (see sim.h)
+// with +save+<file>, the final state is written out as a snapshot
+// with +faults+<n>, each operation is also run n times with a fault
+// injected first (see fault.h)
+// returns the process exit status
+int batch_main(Vtop *top, VerilatedVcdC *tfp);
+
+#endif
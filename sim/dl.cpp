@@ -0,0 +1,260 @@
+// Friden simulator direct delay line access
+//
+// digits are stored in the delay line as runs of pulses, one cell per
+// register digit, so a digit's value is the number of pulses in its
+// cell. The registers are interleaved digit by digit: each digit time
+// holds a cell for each register in turn, in the order of the decoded
+// outputs, and the layout is fixed by the timing chain, so it is
+// worked out here from where the first cell sits in each model (see
+// ports_dl_origin) rather than measured.
+//
+// The layout only holds at the start of a HOME pulse, so every access
+// first runs the model up to the next one.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <verilated.h>
+#include "verilated_vpi.h"
+#include "Vtop.h"
+#include "sim.h"
+#include "dltrace.h"
+#include "ports.h"
+#include "dl.h"
+
+// decoded digits per register
+#define DL_DIGITS 16
+
+// cycles to keep going after a recirculation, so the decoded outputs
+// have caught up with the last digits in it
+#define DL_MARGIN 512
+
+// the layout: each cell is DL_CELL bits, the first DL_CELL_USED of
+// which can hold pulses, and a digit time is a cell for each register;
+// digits 0 and 15 are left out, as they hold neither digits nor the
+// sign and the cells of some of them run round the end of the line
+#define DL_CELL 16
+#define DL_CELL_USED 15
+#define DL_DIGIT_TIME (DL_CELL * DL_REGS)
+
+// cell bit the machine starts a digit's run of pulses at
+#define DL_PULSE_FIRST 2
+
+static vpiHandle dl_h = NULL;
+static int dl_len = 0;
+// delay line bit for each digit, bit of its cell (in the order they are
+// read) and register
+static int dl_bit[DL_DIGITS][DL_CELL_USED][DL_REGS];
+
+int dl_reg_from_name(const char *name) {
+    if (!strcmp(name, "s"))
+        return DL_REG_S;
+    if (strlen(name) == 1 && name[0] >= '0' && name[0] <= '4')
+        return DL_REG_0 + name[0] - '0';
+    return -1;
+}
+
+static int dl_open() {
+    if (dl_h)
+        return 0;
+    dl_h = vpi_handle_by_name((PLI_BYTE8 *)"TOP.top._dl", NULL);
+    if (!dl_h)
+        dl_h = vpi_handle_by_name((PLI_BYTE8 *)"top._dl", NULL);
+    if (!dl_h) {
+        fprintf(stderr, "delay line isn't visible; build with --vpi and _dl public_flat_rw\n");
+        return -1;
+    }
+    dl_len = vpi_get(vpiSize, dl_h);
+
+    int first = ports_dl_origin - DL_DIGIT_TIME;
+    int last = ports_dl_origin - (DL_DIGITS - 2) * DL_DIGIT_TIME - (DL_REGS - 1) * DL_CELL - (DL_CELL_USED - 1);
+    if (first >= dl_len || last < 0) {
+        fprintf(stderr, "the delay line is %d bits, too short for the %s layout\n",
+                dl_len, ports_model);
+        dl_h = NULL;
+        return -1;
+    }
+    for (int d = 1; d < DL_DIGITS - 1; d++)
+        for (int b = 0; b < DL_CELL_USED; b++)
+            for (int r = 0; r < DL_REGS; r++)
+                dl_bit[d][b][r] = ports_dl_origin - d * DL_DIGIT_TIME - r * DL_CELL - b;
+    return 0;
+}
+
+static void dl_get(std::vector<uint8_t> &bits) {
+    s_vpi_value v;
+    v.format = vpiVectorVal;
+    vpi_get_value(dl_h, &v);
+
+    bits.resize(dl_len);
+    for (int p = 0; p < dl_len; p++)
+        bits[p] = (v.value.vector[p / 32].aval >> (p % 32)) & 1;
+}
+
+static void dl_put(const std::vector<uint8_t> &bits) {
+    std::vector<s_vpi_vecval> vec((dl_len + 31) / 32);
+    for (auto &w : vec) {
+        w.aval = 0;
+        w.bval = 0;
+    }
+    for (int p = 0; p < dl_len; p++)
+        if (bits[p])
+            vec[p / 32].aval |= 1U << (p % 32);
+
+    s_vpi_value v;
+    v.format = vpiVectorVal;
+    v.value.vector = vec.data();
+    vpi_put_value(dl_h, &v, NULL, vpiNoDelay);
+}
+
+// runs up to the start of the next HOME pulse; returns -1 if START is
+// holding HOME off, after CLEAR ALL until the next key
+static int dl_align(sim_t *s) {
+    if (s->top->ff_start) {
+        fprintf(stderr, "the machine is clearing (START is set until the next key), so the delay line has no layout\n");
+        return -1;
+    }
+    uint64_t homes = s->homes;
+    while (s->homes == homes)
+        sim_cycle(s);
+    return 0;
+}
+
+// runs for a full recirculation, so every digit has been decoded once
+static int dl_pass(sim_t *s) {
+    if (dl_align(s))
+        return -1;
+    for (int i = 0; i < DL_MARGIN; i++)
+        sim_cycle(s);
+    return 0;
+}
+
+// pulses for digit d in a cell, as a mask of its bits
+static uint32_t dl_digit_mask(int d) {
+    return ((1U << d) - 1) << DL_PULSE_FIRST;
+}
+
+int dl_parse(const char *value, int dp, uint8_t *digits) {
+    const char *p = value;
+    int neg = 0;
+    if (*p == '-') {
+        neg = 1;
+        p++;
+    }
+
+    const char *dot = strchr(p, '.');
+    int n_int = dot ? dot - p : strlen(p);
+    int n_frac = dot ? strlen(dot + 1) : 0;
+    if (n_int + dp > DL_DIGITS - 3 || n_frac > dp) {
+        fprintf(stderr, "%s doesn't fit with the decimal point at %d\n", value, dp);
+        return -1;
+    }
+
+    memset(digits, 0, DL_DIGITS);
+    digits[1] = neg;
+    for (int i = 0; i < n_int; i++) {
+        if (p[i] < '0' || p[i] > '9')
+            goto bad;
+        digits[dp + 1 + n_int - i] = p[i] - '0';
+    }
+    for (int i = 0; i < n_frac; i++) {
+        if (dot[1 + i] < '0' || dot[1 + i] > '9')
+            goto bad;
+        digits[dp + 1 - i] = dot[1 + i] - '0';
+    }
+    return 0;
+
+bad:
+    fprintf(stderr, "%s isn't a number\n", value);
+    return -1;
+}
+
+int dl_write(sim_t *s, int reg, const char *value) {
+    uint8_t digits[DL_DIGITS];
+    if (dl_open() || dl_parse(value, s->top->sw_dp, digits))
+        return -1;
+
+    // CLEAR ENTRY ends a CLEAR ALL, as keying the value in would
+    if (s->top->ff_start && !sim_press(s, '\b'))
+        return -1;
+    if (sim_wait_idle(s, OP_TIMEOUT) < 0 || dl_align(s))
+        return -1;
+
+    std::vector<uint8_t> bits;
+    dl_get(bits);
+    for (int i = 1; i < DL_DIGITS - 1; i++) {
+        uint32_t mask = dl_digit_mask(digits[i]);
+        for (int b = 0; b < DL_CELL_USED; b++)
+            bits[dl_bit[i][b][reg]] = (mask >> b) & 1;
+    }
+    dl_put(bits);
+    if (dltrace_on)
+        dltrace_load(s);
+
+    // let the machine decode it, and check it did so correctly
+    if (dl_pass(s))
+        return -1;
+    uint8_t *out = sim_reg(s->top, reg);
+    for (int i = 1; i < DL_DIGITS - 1; i++) {
+        if (out[i] != digits[i]) {
+            fprintf(stderr, "register %d digit %d reads back as %d after writing %d\n",
+                    reg, i, out[i], digits[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int dl_read(sim_t *s, int reg, char *buf, size_t len) {
+    if (dl_open() || dl_align(s))
+        return -1;
+    std::vector<uint8_t> bits;
+    dl_get(bits);
+
+    uint8_t digits[DL_DIGITS];
+    for (int i = 1; i < DL_DIGITS - 1; i++) {
+        digits[i] = 0;
+        for (int b = 0; b < DL_CELL_USED; b++)
+            digits[i] += bits[dl_bit[i][b][reg]];
+    }
+
+    // same form dl_write takes, without leading zeros
+    int dp = s->top->sw_dp;
+    char tmp[DL_DIGITS + 4];
+    char *p = tmp;
+    if (digits[1])
+        *p++ = '-';
+    int lead = 1;
+    for (int i = DL_DIGITS - 2; i >= 2; i--) {
+        if (lead && digits[i] == 0 && i > dp + 2)
+            continue;
+        lead = 0;
+        *p++ = '0' + digits[i];
+        if (i == dp + 2 && dp > 0)
+            *p++ = '.';
+    }
+    *p = '\0';
+
+    if (strlen(tmp) + 1 > len)
+        return -1;
+    strcpy(buf, tmp);
+    return 0;
+}
+
+int dl_length() {
+    if (dl_open())
+        return -1;
+    return dl_len;
+}
+
+int dl_flip(int pos, int len) {
+    if (dl_open())
+        return -1;
+    std::vector<uint8_t> bits;
+    dl_get(bits);
+    for (int i = 0; i < len; i++)
+        bits[(pos + i) % dl_len] ^= 1;
+    dl_put(bits);
+    return 0;
+}
@@ -0,0 +1,53 @@
+// Friden simulator direct delay line access
+// loads and reads back register values straight in the delay line,
+// without going through the keyboard
+//
+// needs a model verilated with --vpi, with _dl marked
+// public_flat_rw in top.v
+
+#ifndef DL_H
+#define DL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sim.h"
+
+// registers, in the same order as the decoded outputs
+enum {
+    DL_REG_S,
+    DL_REG_0,
+    DL_REG_1,
+    DL_REG_2,
+    DL_REG_3,
+    DL_REG_4,
+    DL_REGS
+};
+
+// register from its name: "s" or "0" to "4"; -1 if there's no such one
+int dl_reg_from_name(const char *name);
+
+// writes a value such as "-1234.5678" into a register, with the decimal
+// point where the DP switch has it, then waits until the machine has
+// picked it up and checks the decoded register; right after CLEAR ALL,
+// CLEAR ENTRY is pressed first, as START keeps the registers clear
+// until the next key
+// returns -1 if the value doesn't fit or didn't read back correctly
+int dl_write(sim_t *s, int reg, const char *value);
+
+// "-1234.5678" -> digits 2 to 14 and the sign in digit 1 (as 1 when
+// negative) of a 16 digit register, with the decimal point after digit
+// dp + 2; returns -1 if value isn't a number or doesn't fit
+int dl_parse(const char *value, int dp, uint8_t *digits);
+
+// reads a register back from the delay line into buf, in the same form
+// returns -1 if buf is too small
+int dl_read(sim_t *s, int reg, char *buf, size_t len);
+
+// number of bits in the delay line, or -1 if it isn't visible
+int dl_length();
+
+// flips len bits of the delay line from bit pos on (wrapping around at
+// the end), as a fault would; returns -1 if it isn't visible
+int dl_flip(int pos, int len);
+
+#endif
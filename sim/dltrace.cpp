@@ -0,0 +1,344 @@
+// Friden simulator delay line trace
+//
+// the writer keeps the last stored state (registers, control word and
+// inputs) and only writes what differs from it. Keyframes are written
+// with snapshot_save() to <trace>.<cycle>.vlt; a replay restores the
+// last one before the window, then feeds the model the recorded inputs
+// cycle by cycle, which reproduces the run exactly as the model has no
+// other inputs. The one thing that breaks that is the host changing the
+// model directly, so each time it does (dltrace_load()) the new state is
+// written to <trace>.<cycle>.load.vlt and restored by the replay; the
+// writer checks the cycle count runs on by one each cycle in between.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <verilated.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "snapshot.h"
+#include "ports.h"
+#include "dltrace_format.h"
+#include "dltrace.h"
+
+int dltrace_on = 0;
+
+static FILE *out;
+static std::string name;
+static sim_t *traced;
+static uint64_t last; // cycle of the last record
+static uint64_t seen; // the traced model's cycle count as of the last call
+static uint64_t sample_at;
+static uint64_t homes;
+static uint64_t keyframe_every;
+static uint64_t recirculations;
+static uint8_t regs[DLT_REGS_N][16];
+static uint64_t control;
+static int key, sw_dp;
+
+int dltrace_start(const char *filename) {
+    if (!filename || !*filename || dltrace_on)
+        return 0;
+
+    out = fopen(filename, "wb");
+    if (!out) {
+        perror(filename);
+        return -1;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    name = filename;
+    traced = nullptr;
+
+    const char *arg = sim_plusarg("dltrace_keyframes");
+    keyframe_every = arg ? strtoull(arg, NULL, 0) : DLTRACE_KEYFRAMES;
+
+    dltrace_on = 1;
+    atexit(dltrace_stop);
+    return 0;
+}
+
+static void put_record(int tag, uint64_t cycle) {
+    putc(tag, out);
+    dlt_put_varint(out, cycle - last);
+    last = cycle;
+}
+
+void dltrace_stop() {
+    if (!dltrace_on)
+        return;
+    if (traced)
+        put_record(DLT_END, seen);
+    fclose(out);
+    out = nullptr;
+    dltrace_on = 0;
+}
+
+static void put_regs(sim_t *s, int all) {
+    uint8_t mask = 0;
+    for (int i = 0; i < DLT_REGS_N; i++)
+        if (all || memcmp(regs[i], sim_reg(s->top, i), 16))
+            mask |= 1 << i;
+    if (!mask)
+        return;
+
+    put_record(DLT_REGS, s->cycle);
+    putc(mask, out);
+    for (int i = 0; i < DLT_REGS_N; i++) {
+        if (!(mask & (1 << i)))
+            continue;
+        memcpy(regs[i], sim_reg(s->top, i), 16);
+        uint8_t packed[DLT_REG_BYTES] = {0};
+        for (int d = 0; d < 16; d++)
+            packed[d / 2] |= (regs[i][d] & 0xf) << (4 * (d & 1));
+        fwrite(packed, sizeof(packed), 1, out);
+    }
+}
+
+// writes a keyframe (tag DLT_KEYFRAME) or a load (DLT_LOAD) record, and
+// the snapshot it names; returns -1 if there's none
+static int put_keyframe(sim_t *s, int tag = DLT_KEYFRAME) {
+    if (s->engine)
+        return -1;
+    char file[512];
+    snprintf(file, sizeof(file), "%s.%lu%s.vlt", name.c_str(), s->cycle,
+             tag == DLT_LOAD ? ".load" : "");
+    if (snapshot_save(s->top, file)) {
+        fprintf(stderr, "can't write keyframe %s\n", file);
+        return -1;
+    }
+    // the trace names it relative to itself
+    const char *base = strrchr(file, '/');
+    base = base ? base + 1 : file;
+    size_t len = strlen(base);
+    put_record(tag, s->cycle);
+    putc((int)len, out);
+    fwrite(base, 1, len, out);
+    return 0;
+}
+
+void dltrace_load(sim_t *s) {
+    if (!dltrace_on || s != traced)
+        return;
+    if (put_keyframe(s, DLT_LOAD)) {
+        fprintf(stderr, "dltrace: can't keep the model's state as of cycle %lu, so the trace ends there\n",
+                seen);
+        dltrace_stop();
+        return;
+    }
+    seen = s->cycle;
+}
+
+static uint64_t control_word(Vtop *top) {
+    shm_view_t v;
+    v.ffs = 0;
+    v.ffs_present = 0;
+    ports_read(top, &v);
+    return v.ffs |
+        (top->kbd_lock ? DLT_CTL_KBD_LOCK : 0) |
+        (top->kbd_ack ? DLT_CTL_KBD_ACK : 0) |
+        (top->lamp_overflow ? DLT_CTL_OVERFLOW : 0) |
+        (uint64_t)(top->phase & 0xf) << DLT_CTL_PHASE_SHIFT;
+}
+
+void dltrace_cycle(sim_t *s) {
+    Vtop *top = s->top;
+
+    if (!traced) {
+        traced = s;
+        dlt_header_t h;
+        memset(&h, 0, sizeof(h));
+        h.magic = DLT_MAGIC;
+        h.version = DLT_VERSION;
+        snprintf(h.model, sizeof(h.model), "%s", ports_model);
+        shm_view_t v;
+        v.ffs = 0;
+        v.ffs_present = 0;
+        ports_read(top, &v);
+        h.ffs_present = v.ffs_present;
+        h.start = s->cycle - 1;
+        fwrite(&h, sizeof(h), 1, out);
+        last = h.start;
+
+        key = key_down(top);
+        sw_dp = top->sw_dp;
+        put_record(DLT_INPUTS, s->cycle - 1);
+        putc(key, out);
+        putc(sw_dp, out);
+        put_keyframe(s);
+        control = control_word(top);
+        put_record(DLT_CONTROL, s->cycle);
+        dlt_put_varint(out, control);
+        put_regs(s, 1);
+        homes = s->homes;
+        sample_at = 0;
+        recirculations = 0;
+        seen = s->cycle;
+        return;
+    }
+    if (s != traced)
+        return;
+
+    // anything else that moved the cycle count, such as a checkpoint
+    // restored, would make the replay run cycles that never were
+    if (s->cycle != seen + 1) {
+        fprintf(stderr, "dltrace: the model went from cycle %lu to %lu other than by running it, so the trace ends at %lu\n",
+                seen, s->cycle, seen);
+        dltrace_stop();
+        return;
+    }
+    seen = s->cycle;
+
+    // the inputs the cycle just run had
+    int k = key_down(top);
+    if (k != key || top->sw_dp != sw_dp) {
+        key = k;
+        sw_dp = top->sw_dp;
+        put_record(DLT_INPUTS, s->cycle - 1);
+        putc(key, out);
+        putc(sw_dp, out);
+    }
+
+    uint64_t c = control_word(top);
+    if (c != control) {
+        control = c;
+        put_record(DLT_CONTROL, s->cycle);
+        dlt_put_varint(out, control);
+    }
+
+    if (s->homes != homes) {
+        homes = s->homes;
+        sample_at = s->cycle + DLT_MARGIN;
+    }
+    if (s->cycle == sample_at) {
+        put_regs(s, 0);
+        if (keyframe_every && ++recirculations % keyframe_every == 0)
+            put_keyframe(s);
+    }
+}
+
+// restores the snapshot a keyframe or load record names, and the inputs
+// recorded as of then
+static int replay_keyframe(Vtop *top, const std::string &dir, const dlt_record_t &r) {
+    std::string keyframe = dir + r.keyframe;
+    if (snapshot_restore(top, keyframe.c_str())) {
+        fprintf(stderr, "can't read keyframe %s\n", keyframe.c_str());
+        return -1;
+    }
+    key_release_all(top);
+    if (r.key)
+        key_press(top, r.key);
+    top->sw_dp = r.sw_dp;
+    return 0;
+}
+
+int dltrace_replay(Vtop *top, VerilatedVcdC *tfp, const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        perror(filename);
+        return 1;
+    }
+    dlt_header_t h;
+    if (dlt_read_header(f, &h)) {
+        fprintf(stderr, "%s isn't a delay line trace of this version\n", filename);
+        fclose(f);
+        return 1;
+    }
+    if (strcmp(h.model, ports_model))
+        fprintf(stderr, "%s was traced on %s, not %s\n", filename, h.model, ports_model);
+
+    uint64_t from = 0, to = UINT64_MAX;
+    const char *window = sim_plusarg("window");
+    if (window && sscanf(window, "%lu:%lu", &from, &to) < 1) {
+        fprintf(stderr, "bad +window+%s, expected <from>:<to>\n", window);
+        fclose(f);
+        return 1;
+    }
+
+    std::string dir = filename;
+    size_t slash = dir.rfind('/');
+    dir = slash == std::string::npos ? "" : dir.substr(0, slash + 1);
+
+    // find the last keyframe at or before the window (or the first one,
+    // if the window starts before it), and the inputs and registers as
+    // of then
+    dlt_record_t r, at;
+    memset(&r, 0, sizeof(r));
+    memset(&at, 0, sizeof(at));
+    r.cycle = h.start;
+    long pos = -1;
+    int status;
+    while (!(status = dlt_read_record(f, &r))) {
+        if ((r.tag == DLT_KEYFRAME || r.tag == DLT_LOAD) && (r.cycle <= from || pos < 0)) {
+            at = r;
+            pos = ftell(f);
+        }
+        if (r.cycle > from && pos >= 0)
+            break;
+    }
+    if (pos < 0) {
+        fprintf(stderr, "%s has no keyframes\n", filename);
+        fclose(f);
+        return 1;
+    }
+
+    if (replay_keyframe(top, dir, at)) {
+        fclose(f);
+        return 1;
+    }
+
+    sim_t s;
+    sim_init(&s, top);
+    s.cycle = at.cycle;
+    fseek(f, pos, SEEK_SET);
+    r = at;
+    printf("replaying %s from cycle %lu (keyframe %s)\n", filename, s.cycle, at.keyframe);
+
+    int mismatches = 0;
+    status = dlt_read_record(f, &r);
+    while (s.cycle < to) {
+        // everything recorded as of this cycle, and the next load, which
+        // may have moved the cycle count on without running the model
+        while (!status && (r.cycle == s.cycle || (r.tag == DLT_LOAD && r.cycle < to))) {
+            if (r.tag == DLT_LOAD) {
+                if (replay_keyframe(top, dir, r)) {
+                    fclose(f);
+                    return 1;
+                }
+                s.cycle = r.cycle;
+                s.home_prev = top->ff_home;
+            }
+            else if (r.tag == DLT_INPUTS) {
+                key_release_all(top);
+                if (r.key)
+                    key_press(top, r.key);
+                top->sw_dp = r.sw_dp;
+            }
+            else if (r.tag == DLT_REGS) {
+                for (int i = 0; i < DLT_REGS_N; i++) {
+                    if (memcmp(r.regs[i], sim_reg(top, i), 16)) {
+                        if (!mismatches++) {
+                            printf("registers differ from the trace at cycle %lu\n", s.cycle);
+                            sim_print_regs(stdout, top);
+                        }
+                        break;
+                    }
+                }
+            }
+            status = dlt_read_record(f, &r);
+        }
+        if (status)
+            break;
+
+        if (s.cycle >= from)
+            s.tfp = tfp;
+        sim_cycle(&s);
+    }
+    fclose(f);
+
+    if (status < 0)
+        fprintf(stderr, "%s is cut short at cycle %lu\n", filename, r.cycle);
+    printf("replayed to cycle %lu, %d recirculations differ from the trace\n", s.cycle, mismatches);
+    return status < 0 || mismatches ? 1 : 0;
+}
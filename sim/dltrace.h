@@ -0,0 +1,53 @@
+// Friden simulator delay line trace
+// traces a run at the level of the registers rather than the gates: the
+// decoded registers once per recirculation (only those that changed),
+// the control flip-flops, lamps and phase whenever they change, and the
+// keys and DP switch; the layout is in dltrace_format.h
+//
+// snapshots of the model (keyframes) are written next to the trace, so
+// any window of it can be run again with gate level tracing; so is one
+// whenever the model is changed other than by running it, which the
+// replay takes up from. A cycle count that goes back, or on without the
+// model being run, ends the trace there rather than record a run that
+// can't be replayed
+
+#ifndef DLTRACE_H
+#define DLTRACE_H
+
+#include "sim.h"
+
+class VerilatedVcdC;
+
+// recirculations between keyframes, unless given by
+// +dltrace_keyframes+<n>; there's always one at the start
+#define DLTRACE_KEYFRAMES 1000
+
+// set while a trace is being written
+extern int dltrace_on;
+
+// starts tracing to filename (from +dltrace+<file>); does nothing if
+// filename is NULL; the first model to run a cycle is the one traced
+// returns -1 if the file can't be created
+int dltrace_start(const char *filename);
+
+// ends the trace and closes it; called at exit
+void dltrace_stop();
+
+// called every cycle
+void dltrace_cycle(sim_t *s);
+
+// called after s's model was changed other than by running it: a
+// register written into the delay line, or a snapshot restored (with
+// s->cycle moved on to match, if need be); writes a keyframe for the
+// replay to restore, or ends the trace if it can't
+void dltrace_load(sim_t *s);
+
+// runs a traced run again on top from the keyframe before the window
+// given by +window+<from>:<to> (in cycles; the whole trace by default),
+// with the keys and DP switch it recorded, dumping the window to tfp if
+// given; the registers are checked against the trace on the way
+// returns the process exit status: 1 if the trace can't be read or the
+// registers differ from it
+int dltrace_replay(Vtop *top, VerilatedVcdC *tfp, const char *filename);
+
+#endif
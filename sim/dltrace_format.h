@@ -0,0 +1,159 @@
+// Friden simulator delay line trace format
+// the file layout written by +dltrace+<file> (dltrace.h), and a small
+// reader for it; like shm_view.h, this needs nothing from Verilator, so
+// tools can include it on their own (see tools/dltrace_dump.cpp)
+//
+// a trace is a header followed by records, each a tag byte and the
+// number of cycles since the previous record as a varint:
+//   DLT_REGS     the decoded registers that changed since they were
+//                last stored: a byte with a bit per register (s, 0 to
+//                4), then 8 bytes per register set in it, digits 0 to
+//                15 as nibbles, low nibble first (the sign is digit 1)
+//   DLT_CONTROL  the control word (DLT_CTL_*) as a varint
+//   DLT_INPUTS   the key held down (as in keys.h, 0 if none) and the DP
+//                switch, as of the cycle of the record
+//   DLT_KEYFRAME a length byte and the name of a snapshot file of the
+//                model state as of the cycle of the record
+//   DLT_LOAD     the same, written when the model was changed other
+//                than by running it (a register loaded, a snapshot
+//                restored), which a replay restores when it gets there;
+//                no cycles were run from the record before it
+//   DLT_END      the end of the trace
+// registers are sampled once per delay line recirculation,
+// DLT_MARGIN cycles after HOME; the control word and the inputs are
+// recorded on every cycle they change
+
+#ifndef DLTRACE_FORMAT_H
+#define DLTRACE_FORMAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "shm_view.h"
+
+#define DLT_MAGIC 0x544c4446 // "FDLT"
+#define DLT_VERSION 2
+
+// cycles after HOME at which the registers are sampled, so the decoded
+// outputs have caught up with the whole recirculation
+#define DLT_MARGIN 512
+
+#define DLT_REGS_N 6
+#define DLT_REG_BYTES 8
+
+enum {
+    DLT_REGS = 'R',
+    DLT_CONTROL = 'C',
+    DLT_INPUTS = 'K',
+    DLT_KEYFRAME = 'S',
+    DLT_LOAD = 'L',
+    DLT_END = 'E'
+};
+
+// control word: the control flip-flops as shm_view_t::ffs bits, then
+#define DLT_CTL_KBD_LOCK (1ull << 32)
+#define DLT_CTL_KBD_ACK (1ull << 33)
+#define DLT_CTL_OVERFLOW (1ull << 34)
+#define DLT_CTL_PHASE_SHIFT 36 // 4 bits
+
+struct dlt_header_t {
+    uint32_t magic;
+    uint32_t version;
+    char model[16]; // e.g. "ec130"
+    uint32_t ffs_present; // control flip-flops the model has
+    uint32_t reserved;
+    uint64_t start; // cycle of the first record
+};
+
+struct dlt_record_t {
+    int tag;
+    uint64_t cycle;
+    uint8_t mask; // DLT_REGS: registers stored
+    uint8_t regs[DLT_REGS_N][16]; // DLT_REGS: digits, as decoded
+    uint64_t control; // DLT_CONTROL
+    int key, sw_dp; // DLT_INPUTS
+    char keyframe[256]; // DLT_KEYFRAME, DLT_LOAD
+};
+
+static inline void dlt_put_varint(FILE *f, uint64_t v) {
+    while (v >= 0x80) {
+        putc((int)(v & 0x7f) | 0x80, f);
+        v >>= 7;
+    }
+    putc((int)v, f);
+}
+
+static inline int dlt_get_varint(FILE *f, uint64_t *v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = getc(f);
+        if (c == EOF)
+            return -1;
+        *v |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return 0;
+    }
+    return -1;
+}
+
+// reads the header; returns -1 if f isn't a trace of this version
+static inline int dlt_read_header(FILE *f, dlt_header_t *h) {
+    if (fread(h, sizeof(*h), 1, f) != 1)
+        return -1;
+    return h->magic == DLT_MAGIC && h->version == DLT_VERSION ? 0 : -1;
+}
+
+// reads the next record into r, which holds the previous one (zeroed
+// before the first), so r->regs always has every register's latest
+// digits; returns 1 at the end of the trace, -1 if it's cut short
+static inline int dlt_read_record(FILE *f, dlt_record_t *r) {
+    int tag = getc(f);
+    uint64_t delta;
+    if (tag == EOF || dlt_get_varint(f, &delta))
+        return -1;
+    r->tag = tag;
+    r->cycle += delta;
+
+    switch (tag) {
+        case DLT_REGS: {
+            int mask = getc(f);
+            if (mask == EOF)
+                return -1;
+            r->mask = mask;
+            for (int i = 0; i < DLT_REGS_N; i++) {
+                if (!(mask & (1 << i)))
+                    continue;
+                uint8_t packed[DLT_REG_BYTES];
+                if (fread(packed, sizeof(packed), 1, f) != 1)
+                    return -1;
+                for (int d = 0; d < 16; d++)
+                    r->regs[i][d] = (packed[d / 2] >> (4 * (d & 1))) & 0xf;
+            }
+            return 0;
+        }
+        case DLT_CONTROL:
+            return dlt_get_varint(f, &r->control);
+        case DLT_INPUTS: {
+            int key = getc(f), dp = getc(f);
+            if (dp == EOF)
+                return -1;
+            r->key = key;
+            r->sw_dp = dp;
+            return 0;
+        }
+        case DLT_KEYFRAME:
+        case DLT_LOAD: {
+            int len = getc(f);
+            if (len == EOF || fread(r->keyframe, 1, len, f) != (size_t)len)
+                return -1;
+            r->keyframe[len] = '\0';
+            return 0;
+        }
+        case DLT_END:
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+#endif
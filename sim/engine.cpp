@@ -0,0 +1,370 @@
+// Friden simulator functional engine
+//
+// the registers are held as signed numbers of 13 digits, scaled by the
+// DP switch like the digits on the delay line. The stack works as on
+// the EC-130: ENTER pushes register 1 up into 2, 3 and 4; a new entry
+// after an operation pushes the result up first; the arithmetic keys
+// combine register 2 with register 1, leave the result in register 1
+// and drop 3 and 4 down. STORE and RECALL copy register 1 to and from
+// the storage register, and REPEAT applies the last operation again
+// with the same operand.
+//
+// Keys are acknowledged KEYBOARD_DELAY cycles after they go down, as
+// with the keyboard counter in top.v, and each operation then keeps
+// the machine busy for a number of word times before its result shows.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <verilated.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "dl.h"
+#include "engine.h"
+
+// same as in top.v
+#define ENGINE_KEYBOARD_DELAY 100
+#define ENGINE_DL_LENGTH 1800
+
+// a word time is one recirculation, 8 master clocks per delay line bit
+#define ENGINE_WORD (ENGINE_DL_LENGTH * 8)
+
+// HOME stays up for the first digit time of every word
+#define ENGINE_HOME 128
+
+#define ENGINE_DIGITS 13
+#define ENGINE_LIMIT 10000000000000LL // 10^13
+
+struct engine_t {
+    uint64_t cycle;
+    int clk_prev;
+
+    int64_t reg[DL_REGS];
+    int overflow;
+    int start;
+
+    // keyboard
+    int kbd_cnt;
+    int key_prev;
+
+    // entry into register 1
+    int entering;
+    int entered_dp;
+    int frac_digits;
+    int lift;
+
+    // the operation in progress and the word times it has left
+    int op;
+    uint64_t words;
+
+    // for REPEAT
+    int last_op;
+    int64_t last_operand;
+};
+
+int engine_arg() {
+    const char *mode = sim_plusarg("engine");
+    if (!mode || !strcmp(mode, "gate"))
+        return ENGINE_GATE;
+    if (!strcmp(mode, "func"))
+        return ENGINE_FUNC;
+    if (!strcmp(mode, "check"))
+        return ENGINE_CHECK;
+    fprintf(stderr, "unknown +engine+%s, using the gate model\n", mode);
+    return ENGINE_GATE;
+}
+
+static int64_t ipow10(int n) {
+    int64_t p = 1;
+    while (n-- > 0)
+        p *= 10;
+    return p;
+}
+
+static int digit_sum(int64_t x) {
+    int sum = 0;
+    for (x = llabs(x); x; x /= 10)
+        sum += x % 10;
+    return sum;
+}
+
+// word times an operation takes: one to read the key, then roughly one
+// per add or subtract and per digit shift of the counting algorithms
+static uint64_t op_words(engine_t *e, int op, int64_t operand) {
+    switch (op) {
+        case '+':
+        case '-':
+            return 2;
+        case '*':
+            return 2 + digit_sum(operand) + ENGINE_DIGITS;
+        case '/': {
+            int64_t y = e->reg[DL_REG_2];
+            int64_t q = operand ? y / operand : 0;
+            return 2 + digit_sum(q) + 2 * ENGINE_DIGITS;
+        }
+        case 'q':
+            return 2 + 2 * digit_sum(operand) + 2 * ENGINE_DIGITS;
+        case 'r':
+            return op_words(e, e->last_op ? e->last_op : '+', e->last_operand);
+        default:
+            return 1;
+    }
+}
+
+static void push(engine_t *e) {
+    e->reg[DL_REG_4] = e->reg[DL_REG_3];
+    e->reg[DL_REG_3] = e->reg[DL_REG_2];
+    e->reg[DL_REG_2] = e->reg[DL_REG_1];
+}
+
+static void set_result(engine_t *e, int reg, __int128 r) {
+    if (r >= ENGINE_LIMIT || r <= -ENGINE_LIMIT) {
+        e->overflow = 1;
+        r %= ENGINE_LIMIT;
+    }
+    e->reg[reg] = (int64_t)r;
+}
+
+// y op x into register 1; returns -1 on division by zero
+static int combine(engine_t *e, int op, __int128 y, int64_t x, int dp) {
+    __int128 r = 0;
+
+    switch (op) {
+        case '+': r = y + x; break;
+        case '-': r = y - x; break;
+        case '*': r = y * x / ipow10(dp); break;
+        case '/':
+            if (!x) {
+                e->overflow = 1;
+                return -1;
+            }
+            r = y * ipow10(dp) / x;
+            break;
+    }
+
+    set_result(e, DL_REG_1, r);
+    return 0;
+}
+
+static void arith(engine_t *e, int op, int64_t x, int dp) {
+    if (combine(e, op, e->reg[DL_REG_2], x, dp))
+        return;
+    e->reg[DL_REG_2] = e->reg[DL_REG_3];
+    e->reg[DL_REG_3] = e->reg[DL_REG_4];
+    e->last_op = op;
+    e->last_operand = x;
+}
+
+static void sqrt_reg(engine_t *e, int dp) {
+    if (e->reg[DL_REG_1] < 0) {
+        e->overflow = 1;
+        return;
+    }
+    // integer square root of x * 10^dp, so the result has dp places
+    __int128 n = (__int128)e->reg[DL_REG_1] * ipow10(dp);
+    __int128 r = 0, bit = (__int128)1 << 90;
+    while (bit > n)
+        bit >>= 2;
+    while (bit) {
+        if (n >= r + bit) {
+            n -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+            r >>= 1;
+        bit >>= 2;
+    }
+    e->reg[DL_REG_1] = (int64_t)r;
+}
+
+static void entry(engine_t *e, int c, int dp) {
+    if (!e->entering) {
+        if (e->lift)
+            push(e);
+        e->reg[DL_REG_1] = 0;
+        e->entering = 1;
+        e->entered_dp = 0;
+        e->frac_digits = 0;
+        e->lift = 0;
+    }
+
+    if (c == '.') {
+        e->entered_dp = 1;
+        return;
+    }
+
+    int64_t d = c - '0';
+    int64_t x = e->reg[DL_REG_1];
+    if (!e->entered_dp) {
+        // digits beyond the register are ignored
+        int64_t i = x / ipow10(dp) * 10 + d;
+        if (i < ipow10(ENGINE_DIGITS - dp))
+            e->reg[DL_REG_1] = i * ipow10(dp) + x % ipow10(dp);
+    }
+    else if (e->frac_digits < dp) {
+        e->frac_digits++;
+        e->reg[DL_REG_1] = x + d * ipow10(dp - e->frac_digits);
+    }
+}
+
+// what a key does once the word times it takes are up
+static void execute(engine_t *e, int op, int dp) {
+    switch (op) {
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case '.':
+            entry(e, op, dp);
+            return;
+        case '\n':
+            push(e);
+            e->lift = 0;
+            break;
+        case '\b':
+            e->reg[DL_REG_1] = 0;
+            e->lift = 0;
+            break;
+        case 's':
+            e->reg[DL_REG_1] = -e->reg[DL_REG_1];
+            return;
+        case 't':
+            e->reg[DL_REG_S] = e->reg[DL_REG_1];
+            e->lift = 1;
+            break;
+        case 'e':
+            if (e->lift || e->entering)
+                push(e);
+            e->reg[DL_REG_1] = e->reg[DL_REG_S];
+            e->lift = 1;
+            break;
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+            arith(e, op, e->reg[DL_REG_1], dp);
+            e->lift = 1;
+            break;
+        case 'r':
+            if (e->last_op)
+                combine(e, e->last_op, e->reg[DL_REG_1], e->last_operand, dp);
+            e->lift = 1;
+            break;
+        case 'q':
+            sqrt_reg(e, dp);
+            e->lift = 1;
+            break;
+    }
+    e->entering = 0;
+}
+
+static void clear(engine_t *e, int all) {
+    for (int r = 0; r < DL_REGS; r++)
+        if (all || r != DL_REG_S)
+            e->reg[r] = 0;
+    e->overflow = 0;
+    e->entering = 0;
+    e->lift = 0;
+    e->op = 0;
+    e->words = 0;
+    e->last_op = 0;
+    e->last_operand = 0;
+}
+
+static void output_reg(uint8_t *out, int64_t x) {
+    memset(out, 0, 16);
+    out[1] = x < 0;
+    x = llabs(x);
+    for (int i = 2; i < 2 + ENGINE_DIGITS; i++, x /= 10)
+        out[i] = x % 10;
+}
+
+static void outputs(engine_t *e, Vtop *top) {
+    output_reg(&top->reg_s[0], e->reg[DL_REG_S]);
+    output_reg(&top->reg_0[0], e->reg[DL_REG_0]);
+    output_reg(&top->reg_1[0], e->reg[DL_REG_1]);
+    output_reg(&top->reg_2[0], e->reg[DL_REG_2]);
+    output_reg(&top->reg_3[0], e->reg[DL_REG_3]);
+    output_reg(&top->reg_4[0], e->reg[DL_REG_4]);
+
+    int busy = e->op != 0;
+    int fun = busy && !strchr("0123456789.", e->op);
+    top->ff_com_dig = busy && !fun;
+    top->ff_com_fun = fun;
+    top->ff_mult = e->op == '*';
+    top->ff_div = e->op == '/';
+    top->ff_start = e->start;
+    top->lamp_overflow = e->overflow;
+    top->kbd_lock = e->overflow || (fun && strchr("*/qr", e->op));
+    top->kbd_ack = e->kbd_cnt == ENGINE_KEYBOARD_DELAY - 1;
+    top->ff_home = e->cycle % ENGINE_WORD < ENGINE_HOME;
+}
+
+engine_t *engine_new(Vtop *top) {
+    engine_t *e = (engine_t *)calloc(1, sizeof(engine_t));
+    outputs(e, top);
+    return e;
+}
+
+void engine_delete(engine_t *e) {
+    free(e);
+}
+
+uint64_t engine_cycles(engine_t *e) {
+    return e->cycle;
+}
+
+void engine_eval(engine_t *e, Vtop *top) {
+    int rise = top->clk && !e->clk_prev;
+    e->clk_prev = top->clk;
+    if (!rise)
+        return;
+
+    e->cycle++;
+    int key = key_down(top);
+    int dp = top->sw_dp;
+
+    // CLEAR ALL, CLEAR DISPLAY and OVERFLOW LOCK act while held
+    if (key == 'c') {
+        clear(e, 1);
+        e->start = 1;
+    }
+    else if (key == 'd')
+        clear(e, 0);
+    else if (key == 'o')
+        e->overflow = 0;
+
+    // the keyboard counter acknowledges the other keys
+    int counted = key && !strchr("cdo", key);
+    if (counted) {
+        if (e->kbd_cnt < ENGINE_KEYBOARD_DELAY - 1)
+            e->kbd_cnt++;
+    }
+    else
+        e->kbd_cnt = 0;
+
+    int locked = e->overflow || (e->op && strchr("*/qr", e->op));
+    if (counted && e->kbd_cnt == ENGINE_KEYBOARD_DELAY - 1 && key != e->key_prev && !locked && !e->op) {
+        e->start = 0;
+        e->op = key;
+        e->words = op_words(e, key, e->reg[DL_REG_1]);
+    }
+    e->key_prev = counted && e->kbd_cnt == ENGINE_KEYBOARD_DELAY - 1 ? key : 0;
+
+    // operations finish at word boundaries
+    if (e->op && e->cycle % ENGINE_WORD == 0 && --e->words == 0) {
+        execute(e, e->op, dp);
+        e->op = 0;
+    }
+
+    outputs(e, top);
+}
+
+void engine_write(engine_t *e, Vtop *top, int reg, const uint8_t *digits) {
+    int64_t x = 0;
+    for (int i = 2 + ENGINE_DIGITS - 1; i >= 2; i--)
+        x = x * 10 + digits[i];
+    e->reg[reg] = digits[1] ? -x : x;
+    e->entering = 0;
+    e->lift = 1;
+    outputs(e, top);
+}
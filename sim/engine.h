@@ -0,0 +1,42 @@
+// Friden simulator functional engine
+// a word-level model of the calculator, for workloads too big for the
+// gate model; it reads the key and sw_dp inputs of a Vtop and drives
+// its register and control outputs in place of Vtop::eval, so the rest
+// of the harness can't tell the two apart
+//
+// the registers are kept as numbers and each operation takes a whole
+// number of word times (delay line recirculations), so the results
+// should agree with the gate model, but its cycle counts are only an
+// estimate; run a batch with +engine+check to compare the two
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+
+class Vtop;
+struct engine_t;
+
+// which model the harness runs, from +engine+gate|func|check
+enum {
+    ENGINE_GATE, // the Verilated gate model (default)
+    ENGINE_FUNC, // the functional engine
+    ENGINE_CHECK // both, comparing them after every batch operation
+};
+
+int engine_arg();
+
+// a cleared, idle calculator driving top's outputs
+engine_t *engine_new(Vtop *top);
+void engine_delete(engine_t *e);
+
+// evaluates the engine on top's current inputs, like top->eval()
+void engine_eval(engine_t *e, Vtop *top);
+
+// sets a register (DL_REG_S to DL_REG_4) to the digits from dl_parse
+void engine_write(engine_t *e, Vtop *top, int reg, const uint8_t *digits);
+
+// cycles the engine has modelled so far
+uint64_t engine_cycles(engine_t *e);
+
+#endif
@@ -0,0 +1,468 @@
+// Friden simulator key sequence explorer
+//
+// every level of the search runs the same way: the parent splits the
+// states reached at the last level into slices, and forks a child for
+// each (up to +jobs+ at a time). A child inherits those states and the
+// hashes of every state seen so far, so it drops the states it reaches
+// that aren't new by itself, and sends back through a pipe only the
+// new ones and the hangs. The parent then takes the results slice by
+// slice, in order, so the sequence kept for a state reached more than
+// once is the first in key order whatever order the children finish in.
+//
+// A state is kept as its XOR with the cleared machine's, which is
+// mostly zeroes, as runs: a count of bytes that are the same, then a
+// count of bytes that differ, followed by them.
+//
+// The hash is only of what the machine holds, not of the whole model:
+// the states are taken when it's idle, and the hash is of the decoded
+// registers, the control flip-flops but HOME, the counters and the
+// lamps, so states that differ only in where the delay lines or the
+// timing chain happen to be are one. Hashes are 128 bits, so two states
+// being taken for one isn't a concern.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "shm_view.h"
+#include "ports.h"
+#include "batch.h"
+#include "snapshot.h"
+#include "shm.h"
+#include "dltrace.h"
+#include "lockstep.h"
+#include "metrics.h"
+#include "explore.h"
+
+// how a press ended
+enum {
+    EXPLORE_READY, // the machine was ready for the next key
+    EXPLORE_CLEARS, // it hung, but CLEAR ALL brought it back
+    EXPLORE_WEDGED // it hung, and CLEAR ALL didn't help
+};
+
+// what was still set when a press was given up on
+enum {
+    STUCK_LOCK = 1, // kbd_lock
+    STUCK_FUN = 2, // ff_com_fun
+    STUCK_DIG = 4, // ff_com_dig
+    STUCK_START = 8 // ff_start
+};
+
+// marks the end of a child's results
+#define EXPLORE_END 0xffffffffU
+
+struct explore_hash {
+    uint64_t h[2];
+    bool operator==(const explore_hash &o) const {
+        return h[0] == o.h[0] && h[1] == o.h[1];
+    }
+};
+
+struct explore_hash_fn {
+    size_t operator()(const explore_hash &x) const {
+        return x.h[0];
+    }
+};
+
+// a state reached, and how: the state the key was pressed in
+struct explore_node {
+    uint32_t parent;
+    uint8_t key;
+};
+
+// what a child sends back for a new state or a hang, followed by the
+// new state's runs; the last has node EXPLORE_END, and the child's
+// totals in hash
+struct explore_result {
+    uint32_t node;
+    uint8_t key;
+    uint8_t outcome;
+    uint8_t stuck;
+    uint32_t len;
+    explore_hash hash;
+};
+
+static std::vector<int> keys; // key characters, as in keys.h
+static int jobs;
+static uint64_t timeout;
+
+static std::string root; // the cleared machine
+static std::unordered_set<explore_hash, explore_hash_fn> visited;
+static std::vector<explore_node> nodes; // every state, root first
+
+// the states of the level being expanded, nodes first to first +
+// at.size() - 1, each starting at its offset into the arena
+static uint32_t first;
+static std::vector<size_t> at;
+static std::string arena;
+
+static uint64_t hangs, wedged;
+static uint64_t presses, cycles;
+
+int explore_arg() {
+    return sim_plusarg("explore") != NULL;
+}
+
+static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static explore_hash hash_state(const std::string &state) {
+    uint64_t a = 0x9e3779b97f4a7c15ULL ^ state.size(), b = 0xc2b2ae3d27d4eb4fULL;
+    size_t i = 0;
+    for (; i + 8 <= state.size(); i += 8) {
+        uint64_t w;
+        memcpy(&w, &state[i], 8);
+        a = (a ^ w) * 0xff51afd7ed558ccdULL;
+        a ^= a >> 32;
+        b = (b + w) * 0xc4ceb9fe1a85ec53ULL;
+        b ^= b >> 29;
+    }
+    uint64_t w = 0;
+    memcpy(&w, state.data() + i, state.size() - i);
+    return {{mix(a ^ w), mix(b + w) ^ a}};
+}
+
+// the hash of the machine's state as it is now
+static explore_hash hash_machine(Vtop *top) {
+    std::string state;
+    for (int i = 0; i < 6; i++)
+        state.append((const char *)sim_reg(top, i), 16);
+    shm_view_t v;
+    v.ffs = 0;
+    v.ffs_present = 0;
+    ports_read(top, &v);
+    v.ffs &= ~(1u << SHM_FF_HOME);
+    uint8_t rest[] = {(uint8_t)v.ffs, (uint8_t)(v.ffs >> 8), (uint8_t)(v.ffs >> 16),
+                      v.a_cnt, v.b_cnt, v.c_cnt, v.d_cnt, (uint8_t)top->dp_cnt,
+                      (uint8_t)top->phase, (uint8_t)top->kbd_lock,
+                      (uint8_t)top->lamp_overflow, (uint8_t)top->sw_dp};
+    state.append((const char *)rest, sizeof(rest));
+    return hash_state(state);
+}
+
+static void put_varint(std::string &out, uint64_t v) {
+    while (v >= 0x80) {
+        out += (char)(v | 0x80);
+        v >>= 7;
+    }
+    out += (char)v;
+}
+
+static uint64_t get_varint(const uint8_t *&p) {
+    uint64_t v = 0;
+    for (int shift = 0; ; shift += 7) {
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+}
+
+static uint8_t diff(const std::string &state, size_t i) {
+    return state[i] ^ (i < root.size() ? root[i] : 0);
+}
+
+// appends state to out as runs
+static void encode(const std::string &state, std::string &out) {
+    size_t n = state.size();
+    put_varint(out, n);
+    for (size_t i = 0; i < n; ) {
+        size_t same = i;
+        while (same < n && !diff(state, same))
+            same++;
+        // a single byte that's the same costs less left in the run
+        size_t end = same;
+        while (end < n && (diff(state, end) || (end + 1 < n && diff(state, end + 1))))
+            end++;
+        put_varint(out, same - i);
+        put_varint(out, end - same);
+        for (size_t j = same; j < end; j++)
+            out += (char)diff(state, j);
+        i = end;
+    }
+}
+
+static void decode(const uint8_t *p, std::string &state) {
+    size_t n = get_varint(p);
+    state.assign(root, 0, std::min(n, root.size()));
+    state.resize(n);
+    for (size_t i = 0; i < n; ) {
+        i += get_varint(p);
+        for (size_t len = get_varint(p); len; len--)
+            state[i++] ^= *p++;
+    }
+}
+
+// presses c and waits until the machine is idle again
+static int explore_press(sim_t *s, int c) {
+    return sim_press(s, c) && sim_wait_idle(s, timeout) >= 0 ? 0 : -1;
+}
+
+static void print_path(uint32_t node, int key) {
+    std::vector<int> path(1, keys[key]);
+    for (; node; node = nodes[node].parent)
+        path.push_back(keys[nodes[node].key]);
+    for (size_t i = path.size(); i--; )
+        printf("%s%s", key_name(path[i]), i ? ", " : "");
+}
+
+// a forked child is a copy of the simulator that mustn't write to any
+// of the parent's outputs, as in fault injection
+static void explore_child(sim_t *s, uint32_t from, uint32_t to, int fd) {
+    FILE *out = fdopen(fd, "w");
+    if (!out || !freopen("/dev/null", "w", stdout))
+        _exit(1);
+    s->tfp = nullptr;
+    shm_on = 0;
+    dltrace_on = 0;
+    lockstep_on = 0;
+    metrics_on = 0;
+
+    std::unordered_set<explore_hash, explore_hash_fn> mine;
+    std::string state, after, runs;
+    uint64_t pressed = 0, start = s->cycle;
+    for (uint32_t n = from; n < to; n++) {
+        decode((const uint8_t *)arena.data() + at[n - first], state);
+        for (size_t k = 0; k < keys.size(); k++) {
+            if (snapshot_restore_mem(s->top, state))
+                _exit(1);
+            s->home_prev = s->top->ff_home;
+            explore_result r = {n, (uint8_t)k, EXPLORE_READY, 0, 0, {{0, 0}}};
+            pressed++;
+            runs.clear();
+
+            if (explore_press(s, keys[k])) {
+                Vtop *top = s->top;
+                r.stuck = (top->kbd_lock ? STUCK_LOCK : 0) | (top->ff_com_fun ? STUCK_FUN : 0) |
+                          (top->ff_com_dig ? STUCK_DIG : 0) | (top->ff_start ? STUCK_START : 0);
+                r.outcome = explore_press(s, 'c') ? EXPLORE_WEDGED : EXPLORE_CLEARS;
+            }
+            else {
+                r.hash = hash_machine(s->top);
+                if (visited.count(r.hash) || !mine.insert(r.hash).second)
+                    continue;
+                if (snapshot_save_mem(s->top, after))
+                    _exit(1);
+                encode(after, runs);
+                r.len = runs.size();
+            }
+            if (fwrite(&r, sizeof(r), 1, out) != 1 || fwrite(runs.data(), 1, r.len, out) != r.len)
+                _exit(1);
+        }
+    }
+
+    explore_result end = {EXPLORE_END, 0, 0, 0, 0, {{pressed, s->cycle - start}}};
+    int status = fwrite(&end, sizeof(end), 1, out) == 1 && !fclose(out) ? 0 : 1;
+    snapshot_scratch_remove();
+    _exit(status);
+}
+
+// takes in the results of one slice, adding its new states to the next
+// level; returns -1 if they're cut short
+static int explore_merge(const std::string &results, std::vector<size_t> &next_at,
+                         std::string &next_arena) {
+    for (size_t i = 0; i + sizeof(explore_result) <= results.size(); ) {
+        explore_result r;
+        memcpy(&r, &results[i], sizeof(r));
+        i += sizeof(r);
+        if (r.node == EXPLORE_END) {
+            presses += r.hash.h[0];
+            cycles += r.hash.h[1];
+            return 0;
+        }
+        if (i + r.len > results.size())
+            break;
+
+        if (r.outcome != EXPLORE_READY) {
+            hangs++;
+            wedged += r.outcome == EXPLORE_WEDGED;
+            printf("hang: ");
+            print_path(r.node, r.key);
+            printf(" (stuck:%s%s%s%s; %s)\n", r.stuck & STUCK_LOCK ? " kbd_lock" : "",
+                   r.stuck & STUCK_FUN ? " com_fun" : "", r.stuck & STUCK_DIG ? " com_dig" : "",
+                   r.stuck & STUCK_START ? " start" : "",
+                   r.outcome == EXPLORE_WEDGED ? "wedged, even after CLEAR ALL" : "CLEAR ALL recovers");
+        }
+        else if (visited.insert(r.hash).second) {
+            nodes.push_back({r.node, r.key});
+            next_at.push_back(next_arena.size());
+            next_arena.append(results, i, r.len);
+        }
+        i += r.len;
+    }
+    return -1;
+}
+
+// expands every state of the level by every key
+static int explore_level(sim_t *s) {
+    uint32_t count = at.size();
+    size_t slices = std::min<size_t>(count, (size_t)jobs * 4);
+    auto slice_start = [&](size_t i) {
+        return first + (uint32_t)((uint64_t)count * i / slices);
+    };
+
+    struct running_t {
+        pid_t pid;
+        size_t slice;
+    };
+    std::map<int, running_t> running; // by pipe
+    std::vector<std::string> results(slices);
+    size_t next = 0;
+    int failed = 0;
+
+    fflush(stdout);
+    while (next < slices || !running.empty()) {
+        if (next < slices && (int)running.size() < jobs && !failed) {
+            int fds[2];
+            if (pipe(fds)) {
+                perror("explore: pipe");
+                failed = 1;
+                continue;
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("explore: fork");
+                close(fds[0]);
+                close(fds[1]);
+                failed = 1;
+                continue;
+            }
+            if (!pid) {
+                close(fds[0]);
+                explore_child(s, slice_start(next), slice_start(next + 1), fds[1]);
+            }
+            close(fds[1]);
+            running[fds[0]] = {pid, next++};
+            continue;
+        }
+        if (running.empty())
+            break;
+
+        std::vector<struct pollfd> fds;
+        for (auto &r : running)
+            fds.push_back({r.first, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), -1) < 0)
+            continue;
+        for (auto &p : fds) {
+            if (!p.revents)
+                continue;
+            running_t &r = running[p.fd];
+            char buf[65536];
+            ssize_t n = read(p.fd, buf, sizeof(buf));
+            if (n > 0) {
+                results[r.slice].append(buf, n);
+                continue;
+            }
+            close(p.fd);
+            waitpid(r.pid, NULL, 0);
+            running.erase(p.fd);
+        }
+    }
+
+    std::vector<size_t> next_at;
+    std::string next_arena;
+    uint32_t next_first = nodes.size();
+    for (size_t i = 0; i < slices && !failed; i++) {
+        if (explore_merge(results[i], next_at, next_arena)) {
+            fprintf(stderr, "explore: a child failed\n");
+            failed = 1;
+        }
+    }
+    first = next_first;
+    at.swap(next_at);
+    arena.swap(next_arena);
+    return failed ? -1 : 0;
+}
+
+int explore_main(sim_t *s) {
+    int depth = atoi(sim_plusarg("explore"));
+    if (depth < 1) {
+        fprintf(stderr, "+explore+ needs a depth of at least 1\n");
+        return 1;
+    }
+    if (s->engine) {
+        fprintf(stderr, "explore: the functional engine has no state to save\n");
+        return 1;
+    }
+
+    // the keys, each once however many characters map to it, the
+    // printable ones first (= rather than \n for ENTER)
+    const char *arg = sim_plusarg("explore_keys");
+    for (int i = 0; i < 128; i++) {
+        int c = arg ? (unsigned char)arg[i] : (i + 32) % 128;
+        if (arg && !c)
+            break;
+        const char *name = key_name(c);
+        if (!c || !name) {
+            if (arg) {
+                fprintf(stderr, "explore: '%c' isn't a key\n", c);
+                return 1;
+            }
+            continue;
+        }
+        int dup = 0;
+        for (int k : keys)
+            dup |= !strcmp(key_name(k), name);
+        if (!dup)
+            keys.push_back(c);
+    }
+    if (keys.empty() || keys.size() > 256) {
+        fprintf(stderr, "explore: no keys to press\n");
+        return 1;
+    }
+
+    arg = sim_plusarg("jobs");
+    jobs = arg ? atoi(arg) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs < 1)
+        jobs = 1;
+    arg = sim_plusarg("explore_timeout");
+    timeout = arg ? strtoull(arg, NULL, 0) : EXPLORE_TIMEOUT;
+
+    // start from the cleared machine
+    if (batch_run(s, {"clear", "c"}) || snapshot_save_mem(s->top, root)) {
+        fprintf(stderr, "explore: can't clear the machine\n");
+        return 1;
+    }
+    visited.insert(hash_machine(s->top));
+    nodes.push_back({0, 0});
+    first = 0;
+    at.assign(1, 0);
+    encode(root, arena);
+
+    printf("explore: %zu keys, depth %d, %d jobs, %lu cycles before a press hangs\n",
+           keys.size(), depth, jobs, timeout);
+    auto start = std::chrono::steady_clock::now();
+    int level;
+    for (level = 1; level <= depth && !at.empty(); level++) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t pressed = presses, hung = hangs;
+        if (explore_level(s))
+            return 1;
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("explore: depth %d: %lu presses, %zu new states, %lu hangs, %.2f s\n",
+               level, presses - pressed, at.size(), hangs - hung, secs);
+        fflush(stdout);
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("explore: %zu states, %lu presses, %lu cycles in %.2f s\n",
+           nodes.size(), presses, cycles, secs);
+    if (at.empty() && level <= depth)
+        printf("explore: no new states after depth %d, so none deeper either\n", level - 1);
+    printf("explore: %lu hangs, %lu wedged even after CLEAR ALL\n", hangs, wedged);
+    return hangs ? 1 : 0;
+}
@@ -0,0 +1,40 @@
+// Friden simulator key sequence explorer
+// with +explore+<depth>, batch mode tries every key sequence up to that
+// length from the cleared machine, breadth first, to show that none of
+// them can wedge it: each key is pressed in each state reached so far,
+// and waited on until the machine is idle again; a press it never comes
+// back from (KBD LOCK or a command flip-flop stuck) is a hang, reported
+// with the shortest key sequence that leads to it and whether CLEAR ALL
+// gets the machine back
+//
+// states are told apart by a hash of the registers, control flip-flops,
+// counters and lamps once the machine is idle, leaving out where the
+// delay lines and timing chain are, so a state reached by several
+// sequences is only explored once; the states of a level are kept as
+// their differences from the cleared machine, in one arena, and
+// expanded by forked children (+jobs+<n>, one per CPU by default), each
+// taking a slice of them
+//
+// +explore_keys+<keys> limits the keys pressed (all of the simulator's
+// keys by default), e.g. +explore_keys+0123456789.=+-*/c; a press is
+// given up as hung after +explore_timeout+<cycles>, EXPLORE_TIMEOUT by
+// default
+
+#ifndef EXPLORE_H
+#define EXPLORE_H
+
+#include "sim.h"
+
+// cycles a press may take before it counts as a hang; the longest
+// operations, divisions with many quotient digits, take a few million
+#define EXPLORE_TIMEOUT 20000000UL
+
+// true if +explore+<depth> was given
+int explore_arg();
+
+// explores from the state s is in, after a CLEAR ALL; prints each level
+// and every hang found
+// returns the process exit status: 1 if anything hung, or on an error
+int explore_main(sim_t *s);
+
+#endif
@@ -0,0 +1,618 @@
+// Friden simulator fault injection
+//
+// for each operation, a clean run is made first (in a child process,
+// so the state before the operation is kept) to get its length and
+// result. Every fault is then drawn in the parent from +seed+, so a
+// campaign can be repeated exactly, and run in a child of its own: the
+// child arms a sim_t hook for a random cycle within the length of the
+// clean run (or the +fault_at+ window of it), injects the fault there,
+// and re-arms the hook as a deadline that gives the run up as hung. Its
+// exit status is the outcome, so nothing but the fault itself is shared
+// with the parent.
+//
+// Stuck-at faults hold an output for the rest of the run; delay line
+// flips and forced charges are transient, and the model may well
+// recover from them on its own.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "verilated_vpi.h"
+#include "Vtop.h"
+#include "sim.h"
+#include "batch.h"
+#include "dl.h"
+#include "shm.h"
+#include "dltrace.h"
+#include "lockstep.h"
+#include "metrics.h"
+#include "fault.h"
+
+static const char *kind_names[FAULT_KINDS] = {
+    "dl", "burst", "stuck0", "stuck1", "ac"
+};
+
+static const char *outcome_names[FAULT_OUTCOMES] = {
+    "masked", "wrong", "overflow", "hang", "crash"
+};
+
+// an ac or ff instance of top.v or one of its cards
+struct fault_target {
+    std::string name;
+    int ac;
+    vpiHandle stuck;
+    vpiHandle cnt; // ac only
+};
+
+struct fault_t {
+    int kind;
+    int target; // index into targets, or the first delay line bit
+    int value; // burst length, or charge
+    uint64_t offset; // cycles into the operation
+};
+
+// what a run of an operation left behind
+struct fault_result {
+    int status; // from batch_run
+    uint64_t cycles;
+    uint8_t regs[DL_REGS][16];
+    uint8_t overflow;
+};
+
+static std::vector<fault_target> targets;
+static std::vector<int> stuck_targets, ac_targets;
+static int kinds[FAULT_KINDS];
+static int burst_len;
+static int dl_len;
+static uint64_t at_from, at_to; // window of cycles faults go in, if at_to
+static int jobs;
+static uint64_t rng;
+static FILE *log_file;
+
+static uint64_t totals[FAULT_KINDS][FAULT_OUTCOMES];
+static uint64_t total_faults;
+static double total_secs;
+
+// the fault a child injects, and when it gives up
+static fault_t cur;
+static uint64_t deadline;
+
+// splitmix64
+static uint64_t fault_rand() {
+    uint64_t z = (rng += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t fault_below(uint64_t n) {
+    return n ? fault_rand() % n : 0;
+}
+
+int fault_arg() {
+    const char *arg = sim_plusarg("faults");
+    return arg ? atoi(arg) : 0;
+}
+
+static vpiHandle fault_handle(const std::string &inst, const char *var) {
+    std::string name = "TOP.top." + inst + "." + var;
+    vpiHandle h = vpi_handle_by_name((PLI_BYTE8 *)name.c_str(), NULL);
+    if (!h) {
+        name = "top." + inst + "." + var;
+        h = vpi_handle_by_name((PLI_BYTE8 *)name.c_str(), NULL);
+    }
+    return h;
+}
+
+// "ac AC_1051 (" -> type and name, as in tools/pack_banks.cpp
+static int fault_parse_header(const char *line, std::string &type, std::string &name) {
+    while (*line == ' ' || *line == '\t')
+        line++;
+    if (strncmp(line, "ac ", 3) && strncmp(line, "ff ", 3))
+        return 0;
+    type.assign(line, 2);
+    name.clear();
+    const char *p = line + 3;
+    while (*p == ' ')
+        p++;
+    for (; *p && *p != ' ' && *p != '('; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_')
+            return 0;
+        name += *p;
+    }
+    while (*p == ' ')
+        p++;
+    return !name.empty() && *p == '(';
+}
+
+// "keyboard #(.KEYBOARD_DELAY(KEYBOARD_DELAY)) KEYBOARD (.*);" -> module
+// and instance name
+static int fault_parse_card(const char *line, std::string &module, std::string &name) {
+    const char *p = line + strspn(line, " \t");
+    module.clear();
+    for (; isalnum((unsigned char)*p) || *p == '_'; p++)
+        module += *p;
+    if (module.empty() || (*p != ' ' && *p != '#'))
+        return 0;
+    p += strspn(p, " ");
+    if (*p == '#') {
+        // skip the parameters
+        int depth = 0;
+        for (p++; *p; p++) {
+            if (*p == '(')
+                depth++;
+            else if (*p == ')' && --depth == 0)
+                break;
+        }
+        if (!*p)
+            return 0;
+        p++;
+        p += strspn(p, " ");
+    }
+    name.clear();
+    for (; isalnum((unsigned char)*p) || *p == '_'; p++)
+        name += *p;
+    p += strspn(p, " ");
+    return !name.empty() && *p == '(';
+}
+
+// true if name matches one of the comma-separated shell patterns, or
+// if there are none
+static int fault_match(const char *patterns, const std::string &name) {
+    if (!patterns)
+        return 1;
+    for (const char *p = patterns; *p; ) {
+        size_t n = strcspn(p, ",");
+        std::string pattern(p, n);
+        if (!fnmatch(pattern.c_str(), name.c_str(), 0))
+            return 1;
+        p += n;
+        if (*p)
+            p++;
+    }
+    return 0;
+}
+
+// reads the ac and ff instances of filename that match patterns, and
+// those of the cards it instantiates from dir (../modules next to
+// top.v), with prefix before their names; instances inside `ifdef
+// blocks (the timing chain when it's replaced by timing.v, the parts of
+// a card for the other machines) count only if they were built
+static int fault_read_module(const std::string &filename, const std::string &dir,
+                             const std::string &prefix, const char *patterns, int &missing) {
+    FILE *f = fopen(filename.c_str(), "r");
+    if (!f) {
+        perror(filename.c_str());
+        return -1;
+    }
+
+    char buf[4096];
+    int ifdef_depth = 0;
+    int in_module = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        const char *s = buf + strspn(buf, " \t");
+        if (!strncmp(s, "`ifdef", 6) || !strncmp(s, "`ifndef", 7))
+            ifdef_depth++;
+        else if (!strncmp(s, "`endif", 6) && ifdef_depth > 0)
+            ifdef_depth--;
+        // the module's own header isn't an instance
+        if (!strncmp(s, "module ", 7))
+            in_module = 1;
+        else if (in_module == 1 && !strncmp(s, ");", 2))
+            in_module = 2;
+        if (in_module != 2)
+            continue;
+
+        std::string type, name;
+        if (!fault_parse_header(buf, type, name)) {
+            // a card: read its instances too
+            std::string module;
+            if (!fault_parse_card(buf, module, name))
+                continue;
+            std::string card = dir + "/" + module + ".v";
+            if (access(card.c_str(), R_OK))
+                continue;
+            if (fault_read_module(card, dir, prefix + name + ".", patterns, missing)) {
+                fclose(f);
+                return -1;
+            }
+            continue;
+        }
+        if (!fault_match(patterns, name))
+            continue;
+
+        fault_target t;
+        t.name = prefix + name;
+        int seen = 0;
+        for (const fault_target &other : targets)
+            seen |= other.name == t.name;
+        if (seen)
+            continue;
+        t.ac = type == "ac";
+        t.stuck = fault_handle(t.name, "stuck");
+        t.cnt = t.ac ? fault_handle(t.name, "_cnt") : NULL;
+        if (!t.stuck) {
+            if (!ifdef_depth)
+                missing++;
+            continue;
+        }
+        stuck_targets.push_back(targets.size());
+        if (t.cnt)
+            ac_targets.push_back(targets.size());
+        targets.push_back(t);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int fault_read_targets(const char *filename, const char *patterns) {
+    std::string path = filename;
+    size_t slash = path.rfind('/');
+    std::string dir = (slash == std::string::npos ? std::string(".") : path.substr(0, slash)) + "/../modules";
+
+    int missing = 0;
+    if (fault_read_module(path, dir, "", patterns, missing))
+        return -1;
+    if (missing)
+        fprintf(stderr, "faults: %d instances of %s aren't visible; build with make faults (and PACKED=0, HIER=0)\n",
+                missing, filename);
+    return 0;
+}
+
+int fault_start(sim_t *s) {
+    if (s->engine) {
+        fprintf(stderr, "faults: can't inject faults into the functional engine\n");
+        return -1;
+    }
+
+    const char *arg = sim_plusarg("fault_kinds");
+    for (int k = 0; k < FAULT_KINDS; k++)
+        kinds[k] = !arg;
+    if (arg) {
+        std::string list = arg;
+        size_t p = 0;
+        while (p <= list.size()) {
+            size_t len = list.find(',', p);
+            if (len == std::string::npos)
+                len = list.size();
+            std::string name = list.substr(p, len - p);
+            int k;
+            for (k = 0; k < FAULT_KINDS; k++)
+                if (name == kind_names[k])
+                    break;
+            if (k == FAULT_KINDS) {
+                fprintf(stderr, "faults: unknown kind %s\n", name.c_str());
+                return -1;
+            }
+            kinds[k] = 1;
+            p = len + 1;
+        }
+    }
+
+    arg = sim_plusarg("fault_burst");
+    burst_len = arg ? atoi(arg) : FAULT_BURST_LEN;
+    if (burst_len < 1)
+        burst_len = FAULT_BURST_LEN;
+
+    // +fault_at+<from>-<to>, or +fault_at+<cycle> for a single cycle
+    arg = sim_plusarg("fault_at");
+    if (arg) {
+        char *end;
+        at_from = strtoull(arg, &end, 0);
+        at_to = *end == '-' ? strtoull(end + 1, &end, 0) : at_from;
+        if (*end || at_to < at_from) {
+            fprintf(stderr, "faults: bad +fault_at+%s, expected <from>-<to>\n", arg);
+            return -1;
+        }
+        at_to++;
+    }
+
+    arg = sim_plusarg("jobs");
+    jobs = arg ? atoi(arg) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs < 1)
+        jobs = 1;
+
+    arg = sim_plusarg("seed");
+    rng = arg ? strtoull(arg, NULL, 0) : 1;
+
+    if (kinds[FAULT_DL] || kinds[FAULT_BURST]) {
+        dl_len = dl_length();
+        if (dl_len <= 0)
+            kinds[FAULT_DL] = kinds[FAULT_BURST] = 0;
+    }
+    if (kinds[FAULT_STUCK0] || kinds[FAULT_STUCK1] || kinds[FAULT_AC]) {
+        arg = sim_plusarg("fault_netlist");
+        const char *patterns = sim_plusarg("fault_targets");
+        if (fault_read_targets(arg ? arg : "top.v", patterns))
+            return -1;
+        if (stuck_targets.empty())
+            kinds[FAULT_STUCK0] = kinds[FAULT_STUCK1] = 0;
+        if (ac_targets.empty())
+            kinds[FAULT_AC] = 0;
+    }
+
+    int n = 0;
+    for (int k = 0; k < FAULT_KINDS; k++)
+        n += kinds[k];
+    if (!n) {
+        fprintf(stderr, "faults: none of the faults asked for can be injected\n");
+        return -1;
+    }
+
+    arg = sim_plusarg("fault_log");
+    if (arg) {
+        log_file = fopen(arg, "w");
+        if (!log_file) {
+            perror(arg);
+            return -1;
+        }
+        fprintf(log_file, "op,kind,target,detail,cycle,outcome\n");
+    }
+
+    printf("faults: %zu ac/ff targets, %d delay line bits, %d jobs, kinds",
+           stuck_targets.size(), kinds[FAULT_DL] || kinds[FAULT_BURST] ? dl_len : 0, jobs);
+    for (int k = 0; k < FAULT_KINDS; k++)
+        if (kinds[k])
+            printf(" %s", kind_names[k]);
+    if (at_to)
+        printf(", at cycles %lu to %lu", at_from, at_to - 1);
+    printf("\n");
+    return 0;
+}
+
+// draws the cycle into an operation of the given length a fault goes
+// in: anywhere in it, or in the +fault_at+ window, cut short by the end
+// of the operation
+static uint64_t fault_draw_offset(uint64_t cycles) {
+    if (!at_to)
+        return fault_below(cycles);
+    uint64_t to = at_to < cycles ? at_to : cycles;
+    uint64_t from = at_from < to ? at_from : (to ? to - 1 : 0);
+    return from + fault_below(to - from);
+}
+
+static fault_t fault_draw(uint64_t cycles) {
+    int enabled[FAULT_KINDS], n = 0;
+    for (int k = 0; k < FAULT_KINDS; k++)
+        if (kinds[k])
+            enabled[n++] = k;
+
+    fault_t f;
+    f.kind = enabled[fault_below(n)];
+    f.offset = fault_draw_offset(cycles);
+    switch (f.kind) {
+        case FAULT_DL:
+            f.target = fault_below(dl_len);
+            f.value = 1;
+            break;
+        case FAULT_BURST:
+            f.target = fault_below(dl_len);
+            f.value = burst_len;
+            break;
+        case FAULT_STUCK0:
+        case FAULT_STUCK1:
+            f.target = stuck_targets[fault_below(stuck_targets.size())];
+            f.value = f.kind == FAULT_STUCK1;
+            break;
+        default:
+            f.target = ac_targets[fault_below(ac_targets.size())];
+            f.value = fault_below(10); // _cnt counts 0 to 9
+            break;
+    }
+    return f;
+}
+
+static void fault_put(vpiHandle h, int value) {
+    s_vpi_value v;
+    v.format = vpiIntVal;
+    v.value.integer = value;
+    vpi_put_value(h, &v, NULL, vpiNoDelay);
+}
+
+static void fault_deadline(sim_t *s) {
+    (void)s;
+    _exit(FAULT_HANG);
+}
+
+static void fault_inject(sim_t *s) {
+    switch (cur.kind) {
+        case FAULT_DL:
+        case FAULT_BURST:
+            dl_flip(cur.target, cur.value);
+            break;
+        case FAULT_STUCK0:
+        case FAULT_STUCK1:
+            fault_put(targets[cur.target].stuck, 2 | cur.value);
+            break;
+        default:
+            fault_put(targets[cur.target].cnt, cur.value);
+            break;
+    }
+    s->hook = fault_deadline;
+    s->hook_cycle = deadline;
+}
+
+static void fault_get_result(sim_t *s, int status, uint64_t start, fault_result *r) {
+    Vtop *top = s->top;
+    memset(r, 0, sizeof(*r));
+    r->status = status;
+    r->cycles = s->cycle - start;
+    memcpy(r->regs[DL_REG_S], &top->reg_s[0], 16);
+    memcpy(r->regs[DL_REG_0], &top->reg_0[0], 16);
+    memcpy(r->regs[DL_REG_1], &top->reg_1[0], 16);
+    memcpy(r->regs[DL_REG_2], &top->reg_2[0], 16);
+    memcpy(r->regs[DL_REG_3], &top->reg_3[0], 16);
+    memcpy(r->regs[DL_REG_4], &top->reg_4[0], 16);
+    r->overflow = top->lamp_overflow;
+}
+
+// a forked child is a copy of the simulator that mustn't write to any
+// of the parent's outputs
+static void fault_child(sim_t *s) {
+    if (!freopen("/dev/null", "w", stdout))
+        _exit(FAULT_CRASH);
+    s->tfp = nullptr;
+    shm_on = 0;
+    dltrace_on = 0;
+    lockstep_on = 0;
+    metrics_on = 0;
+}
+
+// runs op cleanly in a child, so s is left as it was
+static int fault_clean_run(sim_t *s, const batch_op &op, fault_result *r) {
+    int fds[2];
+    if (pipe(fds)) {
+        perror("faults: pipe");
+        return -1;
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("faults: fork");
+        return -1;
+    }
+    if (!pid) {
+        close(fds[0]);
+        fault_child(s);
+        uint64_t start = s->cycle;
+        int status = batch_run(s, op);
+        fault_result res;
+        fault_get_result(s, status, start, &res);
+        _exit(write(fds[1], &res, sizeof(res)) == sizeof(res) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t n = read(fds[0], r, sizeof(*r));
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    return n == sizeof(*r) && !r->status ? 0 : -1;
+}
+
+static int fault_classify(const fault_result &clean, const fault_result &r) {
+    if (r.status < 0)
+        return FAULT_HANG;
+    if (r.overflow && !clean.overflow)
+        return FAULT_OVERFLOW;
+    if (r.status || r.overflow != clean.overflow || memcmp(r.regs, clean.regs, sizeof(r.regs)))
+        return FAULT_WRONG;
+    return FAULT_MASKED;
+}
+
+static void fault_log(const batch_op &op, const fault_t &f, int outcome) {
+    if (!log_file)
+        return;
+    const char *target = f.kind == FAULT_DL || f.kind == FAULT_BURST ?
+        "_dl" : targets[f.target].name.c_str();
+    int detail = f.kind == FAULT_DL || f.kind == FAULT_BURST ? f.target : f.value;
+    fprintf(log_file, "%s,%s,%s,%d,%lu,%s\n", op.name, kind_names[f.kind],
+            target, detail, f.offset, outcome_names[outcome]);
+}
+
+static void fault_print(const char *name, uint64_t n, const uint64_t *counts, double secs) {
+    printf("faults: %-10s %8lu", name, n);
+    if (secs > 0)
+        printf(" in %.2f s (%.0f/s)", secs, n / secs);
+    printf(":");
+    for (int o = 0; o < FAULT_OUTCOMES; o++)
+        printf(" %s %lu", outcome_names[o], counts[o]);
+    printf("\n");
+}
+
+int fault_campaign(sim_t *s, const batch_op &op, int n) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    fault_result clean;
+    if (fault_clean_run(s, op, &clean)) {
+        fprintf(stderr, "faults: clean run of %s failed\n", op.name);
+        return -1;
+    }
+
+    // draw every fault up front, so they don't depend on the order the
+    // runs finish in
+    std::vector<fault_t> faults(n);
+    for (int i = 0; i < n; i++)
+        faults[i] = fault_draw(clean.cycles);
+
+    uint64_t counts[FAULT_OUTCOMES] = {0};
+    std::map<pid_t, int> running;
+    int next = 0;
+
+    if (log_file)
+        fflush(log_file);
+    fflush(stdout);
+
+    while (next < n || !running.empty()) {
+        if (next < n && (int)running.size() < jobs) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                if (running.empty()) {
+                    perror("faults: fork");
+                    return -1;
+                }
+            }
+            else if (!pid) {
+                fault_child(s);
+                uint64_t start = s->cycle;
+                cur = faults[next];
+                deadline = start + FAULT_HANG_FACTOR * clean.cycles + FAULT_SLACK;
+                s->hook = fault_inject;
+                s->hook_cycle = start + cur.offset + 1;
+                int status = batch_run(s, op);
+                fault_result r;
+                fault_get_result(s, status, start, &r);
+                _exit(fault_classify(clean, r));
+            }
+            else {
+                running[pid] = next++;
+                continue;
+            }
+        }
+
+        int st;
+        pid_t pid = waitpid(-1, &st, 0);
+        if (pid < 0)
+            break;
+        auto it = running.find(pid);
+        if (it == running.end())
+            continue;
+        int outcome = WIFEXITED(st) && WEXITSTATUS(st) < FAULT_CRASH ?
+            WEXITSTATUS(st) : FAULT_CRASH;
+        const fault_t &f = faults[it->second];
+        counts[outcome]++;
+        totals[f.kind][outcome]++;
+        fault_log(op, f, outcome);
+        running.erase(it);
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    total_faults += n;
+    total_secs += secs;
+    fault_print(op.name, n, counts, secs);
+    return 0;
+}
+
+void fault_summary() {
+    uint64_t all[FAULT_OUTCOMES] = {0};
+    for (int k = 0; k < FAULT_KINDS; k++) {
+        uint64_t n = 0;
+        for (int o = 0; o < FAULT_OUTCOMES; o++) {
+            n += totals[k][o];
+            all[o] += totals[k][o];
+        }
+        if (n)
+            fault_print(kind_names[k], n, totals[k], 0);
+    }
+    fault_print("total", total_faults, all, total_secs);
+    if (log_file)
+        fclose(log_file);
+}
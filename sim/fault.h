@@ -0,0 +1,74 @@
+// Friden simulator fault injection
+// runs each batch operation many times over with a single fault
+// injected at a random cycle, and counts how the machine comes out of
+// it; every run is a child process forked from the state before the
+// operation, so they all start from the same checkpoint and run in
+// parallel
+//
+// needs a model verilated with +define+FAULT_INJECT (make faults), which
+// makes the stuck-at controls in modules/ac.v and ff.v and the ac
+// charge counters visible over VPI, and with _dl public_flat_rw
+
+#ifndef FAULT_H
+#define FAULT_H
+
+#include "sim.h"
+#include "batch.h"
+
+// kinds of fault
+enum {
+    FAULT_DL, // one delay line bit flipped
+    FAULT_BURST, // a run of delay line bits flipped
+    FAULT_STUCK0, // an ac or ff output held at 0 from then on
+    FAULT_STUCK1, // an ac or ff output held at 1 from then on
+    FAULT_AC, // an ac gate's charge forced to a value
+    FAULT_KINDS
+};
+
+// how a faulty run ended, compared with a clean run of the operation;
+// also the exit status of the run's process
+enum {
+    FAULT_MASKED, // same registers and overflow lamp
+    FAULT_WRONG, // different registers
+    FAULT_OVERFLOW, // the overflow lamp came on
+    FAULT_HANG, // never went idle again
+    FAULT_CRASH, // the process died
+    FAULT_OUTCOMES
+};
+
+// delay line bits flipped by a burst, unless given by +fault_burst+<n>
+#define FAULT_BURST_LEN 8
+
+// a faulty run is given up as hung after this many times the cycles
+// of the clean run, plus FAULT_SLACK cycles (four word times)
+#define FAULT_HANG_FACTOR 2
+#define FAULT_SLACK 57600
+
+// the number of faults per operation from +faults+<n>, or 0 if none
+// should be injected
+int fault_arg();
+
+// reads the fault targets and options from the plusargs:
+// +fault_kinds+<kinds> picks kinds by name (dl,burst,stuck0,stuck1,ac;
+// all of them by default), +fault_netlist+<file> gives the file the ac
+// and ff instances are read from (top.v by default, with the cards it
+// instantiates from ../modules), and +fault_targets+<patterns> limits
+// them to those whose names match one of the comma-separated shell
+// patterns (e.g. AC_10*,START_1010);
+// +fault_at+<from>-<to> limits the cycles into an operation the faults
+// go in (anywhere in it by default; a single cycle with
+// +fault_at+<cycle>), +jobs+<n> the runs in parallel (one per CPU by
+// default), +seed+<n> the random seed, and +fault_log+<file> a CSV file
+// with one line per fault
+// returns -1 if no fault can be injected
+int fault_start(sim_t *s);
+
+// injects faults into n runs of op from the current state, leaving s as
+// it was; prints the outcomes, and adds them to the totals
+// returns -1 if the clean run of op failed
+int fault_campaign(sim_t *s, const batch_op &op, int n);
+
+// prints the outcomes of all the campaigns
+void fault_summary();
+
+#endif
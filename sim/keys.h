@@ -0,0 +1,31 @@
+// Friden simulator key interface
+
+// each simulator provides its own keys.cpp mapping host keyboard
+// characters onto the key inputs of its model, using the same
+// characters as the interactive simulators (see README.md)
+//
+// a few extra characters are accepted so key sequences can be
+// written in scripts:
+//   '=' or '\n' - ENTER
+//   '\b'        - CLEAR ENTRY
+
+#ifndef KEYS_H
+#define KEYS_H
+
+class Vtop;
+
+// presses the key mapped to character c
+// returns 0 (and presses nothing) if c is not a calculator key
+int key_press(Vtop *top, int c);
+
+// releases every key
+void key_release_all(Vtop *top);
+
+// character of the key being held down, or 0 if none is
+// (ENTER is '\n' and CLEAR ENTRY '\b')
+int key_down(Vtop *top);
+
+// human-readable name of the key mapped to c, or NULL
+const char *key_name(int c);
+
+#endif
@@ -0,0 +1,296 @@
+// Friden simulator lockstep check
+//
+// only does anything in builds with the reference model (LOCKSTEP, see
+// Makefile_obj), which is linked in from obj_dir/ref; the ports of both
+// are reached through ports.h, as each simulator has its own
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "snapshot.h"
+#include "ports.h"
+#include "lockstep.h"
+#ifdef LOCKSTEP
+#include "verilated_save.h"
+#include "Vref.h"
+#endif
+
+int lockstep_on = 0;
+
+#ifndef LOCKSTEP
+
+int lockstep_start(const char *prefix) {
+    if (!prefix)
+        return 0;
+    fprintf(stderr, "+lockstep needs the reference model built in, see make lockstep\n");
+    return -1;
+}
+
+void lockstep_stop() {
+}
+
+void lockstep_cycle(sim_t *) {
+}
+
+#else
+
+// the inputs from a cycle on
+struct lockstep_input_t {
+    uint64_t cycle;
+    uint8_t buf[PORTS_INPUTS_MAX];
+};
+
+// a model being checked, and its reference
+struct lockstep_model_t {
+    size_t n; // in the order they first ran
+    Vtop *top;
+    Vref *ref;
+    std::string top_file, ref_file;
+    uint64_t cycles;
+    uint64_t top_hash, ref_hash;
+    uint64_t compares;
+    uint64_t checkpoint; // cycle both models were last saved at
+    std::vector<lockstep_input_t> inputs; // changes since then
+    lockstep_input_t current;
+    size_t inputs_size;
+};
+
+static std::string prefix;
+static uint64_t interval;
+static uint64_t checkpoint_every;
+static std::vector<lockstep_model_t *> models;
+static lockstep_model_t *last; // the one lockstep_cycle() last ran
+
+int lockstep_start(const char *name) {
+    if (!name || lockstep_on)
+        return 0;
+    if (!*name) {
+        fprintf(stderr, "+lockstep+ needs a file name prefix for its checkpoints\n");
+        return -1;
+    }
+    if (sim_plusarg("poweron") || sim_plusarg("engine")) {
+        fprintf(stderr, "+lockstep starts both models from reset, so it can't be used with +poweron or +engine\n");
+        return -1;
+    }
+    prefix = name;
+
+    const char *arg = sim_plusarg("lockstep_interval");
+    interval = arg ? strtoull(arg, NULL, 0) : LOCKSTEP_INTERVAL;
+    if (!interval)
+        interval = 1;
+    arg = sim_plusarg("lockstep_checkpoint");
+    checkpoint_every = arg ? strtoull(arg, NULL, 0) : LOCKSTEP_CHECKPOINT;
+    if (!checkpoint_every)
+        checkpoint_every = 1;
+
+    // every bit of all the models starts out zero rather than random, so
+    // they start out the same
+    Verilated::randReset(0);
+    models.clear();
+    last = nullptr;
+    lockstep_on = 1;
+    atexit(lockstep_stop);
+    return 0;
+}
+
+// a reference for a model that hasn't run a cycle before; the first
+// one's checkpoints are <prefix>.top.vlt and <prefix>.ref.vlt, the
+// others' <prefix>.<n>.top.vlt and so on
+static lockstep_model_t *watch(Vtop *top) {
+    lockstep_model_t *m = new lockstep_model_t();
+    m->n = models.size();
+    m->top = top;
+    m->ref = new Vref;
+    std::string base = prefix;
+    if (m->n)
+        base += "." + std::to_string(m->n);
+    m->top_file = base + ".top.vlt";
+    m->ref_file = base + ".ref.vlt";
+    models.push_back(m);
+    return m;
+}
+
+// runs a cycle of the reference; one verilated with SINGLE_CLOCK runs
+// on both edges of clk, as the model does in such a build (sim_cycle())
+static void ref_cycle(Vref *ref) {
+#ifdef REF_SINGLE_CLOCK
+    ref->clk = !ref->clk;
+    ref->eval();
+#else
+    for (int clk = 0; clk < 2; clk++) {
+        ref->clk = clk;
+        ref->eval();
+    }
+#endif
+}
+
+static void top_cycle(Vtop *top) {
+#ifdef SINGLE_CLOCK
+    top->clk = !top->clk;
+    top->eval();
+#else
+    for (int clk = 0; clk < 2; clk++) {
+        top->clk = clk;
+        top->eval();
+    }
+#endif
+}
+
+static int save(lockstep_model_t *m) {
+    if (snapshot_save(m->top, m->top_file.c_str()))
+        return -1;
+    VerilatedSave os;
+    os.open(m->ref_file.c_str());
+    if (!os.isOpen())
+        return -1;
+    os << *m->ref;
+    os.close();
+    return 0;
+}
+
+static int restore(lockstep_model_t *m) {
+    if (snapshot_restore(m->top, m->top_file.c_str()))
+        return -1;
+    VerilatedRestore os;
+    os.open(m->ref_file.c_str());
+    if (!os.isOpen())
+        return -1;
+    os >> *m->ref;
+    os.close();
+    return 0;
+}
+
+// saves both models as of the cycle about to run
+static void save_checkpoint(lockstep_model_t *m) {
+    if (save(m)) {
+        fprintf(stderr, "can't save lockstep checkpoint %s\n", m->top_file.c_str());
+        return;
+    }
+    m->checkpoint = m->cycles;
+    m->inputs.clear();
+    m->current.cycle = m->cycles;
+    m->inputs.push_back(m->current);
+}
+
+static int differs(lockstep_model_t *m, uint64_t cycle) {
+    if (ports_hash(m->top, 0) == ports_hash(m->ref, 0))
+        return 0;
+    printf("lockstep: ");
+    if (models.size() > 1)
+        printf("model %zu ", m->n);
+    else
+        printf("the model ");
+    printf("and the reference differ on cycle %lu:\n", cycle);
+    ports_diff(stdout, m->top, m->ref);
+    return 1;
+}
+
+// runs both models again from the checkpoint up to cycle to, with the
+// same inputs, comparing every output on every cycle
+static void find_difference(lockstep_model_t *m, uint64_t to) {
+    if (restore(m)) {
+        printf("lockstep: the output hashes differ by cycle %lu, and checkpoint %s can't be read\n",
+               to, m->top_file.c_str());
+        return;
+    }
+    size_t next = 0;
+    for (uint64_t c = m->checkpoint; c < to; c++) {
+        for (; next < m->inputs.size() && m->inputs[next].cycle <= c; next++) {
+            ports_set_inputs(m->top, m->inputs[next].buf);
+            ports_set_inputs(m->ref, m->inputs[next].buf);
+        }
+        top_cycle(m->top);
+        ref_cycle(m->ref);
+        if (differs(m, c))
+            return;
+    }
+    printf("lockstep: the output hashes differ by cycle %lu, but no output does when run again from cycle %lu\n",
+           to, m->checkpoint);
+}
+
+void lockstep_stop() {
+    if (!lockstep_on)
+        return;
+    lockstep_on = 0;
+
+    // the cycles since the last compare
+    uint64_t cycles = 0, compares = 0;
+    for (lockstep_model_t *m : models) {
+        if (m->top_hash != m->ref_hash) {
+            find_difference(m, m->cycles);
+            // other exit handlers are skipped, as exit() can't be called here
+            fflush(NULL);
+            _exit(1);
+        }
+        cycles += m->cycles;
+        compares += m->compares;
+    }
+    if (models.size() > 1)
+        printf("lockstep: the %zu models and their references agree over %lu cycles (%lu compares)\n",
+               models.size(), cycles, compares);
+    else
+        printf("lockstep: the model and the reference agree over %lu cycles (%lu compares)\n",
+               cycles, compares);
+}
+
+void lockstep_cycle(sim_t *s) {
+    Vtop *top = s->top;
+    lockstep_model_t *m = last && last->top == top ? last : nullptr;
+    for (size_t i = 0; !m && i < models.size(); i++)
+        if (models[i]->top == top)
+            m = models[i];
+    if (!m)
+        m = watch(top);
+    last = m;
+
+    // the inputs the cycle just run had, for the reference and the log
+    uint8_t buf[PORTS_INPUTS_MAX];
+    size_t n = ports_inputs(top, buf);
+    int first = !m->inputs_size;
+    if (first || memcmp(buf, m->current.buf, n)) {
+        m->inputs_size = n;
+        memcpy(m->current.buf, buf, n);
+        m->current.cycle = m->cycles;
+        m->inputs.push_back(m->current);
+        ports_set_inputs(m->ref, buf);
+    }
+#ifdef REF_SINGLE_CLOCK
+    // so its first toggle of clk is seen as an edge, as in sim_init()
+    if (first)
+        m->ref->eval();
+#endif
+    ref_cycle(m->ref);
+    m->cycles++;
+
+    m->top_hash = ports_hash(top, m->top_hash);
+    m->ref_hash = ports_hash(m->ref, m->ref_hash);
+
+    if (first) {
+        // there's no checkpoint to go back to yet, so the first cycle is
+        // compared in full
+        if (differs(m, m->cycles - 1)) {
+            lockstep_on = 0;
+            exit(1);
+        }
+        save_checkpoint(m);
+        return;
+    }
+    if (m->cycles % interval)
+        return;
+
+    if (m->top_hash != m->ref_hash) {
+        lockstep_on = 0;
+        find_difference(m, m->cycles);
+        exit(1);
+    }
+    if (++m->compares % checkpoint_every == 0)
+        save_checkpoint(m);
+}
+
+#endif
@@ -0,0 +1,51 @@
+// Friden simulator lockstep check
+// runs a reference build of the same simulator (verilated as Vref, see
+// "make lockstep") alongside the model, cycle for cycle with the same
+// inputs, to show that a reworked model (packed banks, the timing
+// generator, a change to top.v or the modules) still behaves the same
+//
+// every output of both is folded into a hash each cycle, and the two
+// hashes are compared every interval cycles, so the check costs little
+// more than running the reference; both models are saved every so many
+// matching compares, and when the hashes differ they are restored from
+// there and run again comparing every output on every cycle, to find
+// the first cycle and the outputs that differ
+//
+// only the ports are shared, so registers written straight into the
+// delay line (dl_write(), fault injection) are only written in the model
+
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "sim.h"
+
+// cycles between compares, unless given by +lockstep_interval+<n>: a
+// word time (delay line recirculation)
+#define LOCKSTEP_INTERVAL 14400
+
+// matching compares between saves of both models, unless given by
+// +lockstep_checkpoint+<n>
+#define LOCKSTEP_CHECKPOINT 64
+
+// set while the check runs
+extern int lockstep_on;
+
+// starts the check (from +lockstep+<prefix>), saving both models to
+// <prefix>.top.vlt and <prefix>.ref.vlt; does nothing if prefix is
+// NULL; every model that runs a cycle is checked against a reference
+// of its own, so all of a scenario run's are (saved to
+// <prefix>.<n>.top.vlt and so on after the first)
+// the models start from reset, so this is to be called before they
+// are created, and not with +poweron or +engine
+// returns -1 if the simulator wasn't built with the reference model
+int lockstep_start(const char *prefix);
+
+// prints how far the models agreed; called at exit, or before then by
+// whatever deletes the models checked
+void lockstep_stop();
+
+// called every cycle; runs the reference for the same cycle, and on a
+// difference reports it and exits with status 1
+void lockstep_cycle(sim_t *s);
+
+#endif
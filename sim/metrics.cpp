@@ -0,0 +1,166 @@
+// Friden simulator live metrics
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "metrics.h"
+
+// master clock, 8x TOSC4
+#define SIM_CLOCK_HZ 2666666.7
+
+// kinds of operation, as metrics_op() tells them apart
+enum { OP_ENTRY, OP_ADD, OP_SUB, OP_MULT, OP_DIV, OP_SQRT, OP_STACK, OP_CLEAR, METRICS_OPS };
+static const char *const m_op_names[METRICS_OPS] = {
+    "entry", "add", "sub", "mult", "div", "sqrt", "stack", "clear"
+};
+
+int metrics_on = 0;
+
+// only the simulation thread writes these, so plain loads and stores
+// are enough to update them; relaxed atomics just keep the writer
+// thread's reads well-defined
+static std::atomic<uint64_t> m_cycles(0);
+static std::atomic<uint64_t> m_eval_ns(0);
+static std::atomic<uint64_t> m_keys(0);
+static std::atomic<uint64_t> m_overflows(0);
+static std::atomic<int> m_busy(0);
+static std::atomic<uint64_t> m_ops[METRICS_OPS];
+static int m_overflow_prev = 0;
+
+static std::string m_filename;
+static std::thread m_thread;
+static std::mutex m_mutex;
+static std::condition_variable m_cv;
+static int m_stop = 0;
+static std::chrono::steady_clock::time_point m_start;
+
+static inline void bump(std::atomic<uint64_t> &a, uint64_t n) {
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void metrics_cycle(int overflow) {
+    bump(m_cycles, 1);
+    if (overflow && !m_overflow_prev)
+        bump(m_overflows, 1);
+    m_overflow_prev = overflow;
+}
+
+void metrics_eval(uint64_t ns) {
+    bump(m_eval_ns, ns * METRICS_SAMPLE);
+}
+
+void metrics_busy(int busy) {
+    m_busy.store(busy, std::memory_order_relaxed);
+}
+
+void metrics_key() {
+    bump(m_keys, 1);
+}
+
+void metrics_op(int c) {
+    int op;
+    switch (c) {
+        case '+': op = OP_ADD; break;
+        case '-': op = OP_SUB; break;
+        case '*': op = OP_MULT; break;
+        case '/': op = OP_DIV; break;
+        case 'q': op = OP_SQRT; break;
+        case '\n': case 't': case 'e': case 'r': op = OP_STACK; break;
+        case '\b': case 'd': case 'c': case 'o': op = OP_CLEAR; break;
+        case 0: return;
+        default: op = OP_ENTRY; break;
+    }
+    bump(m_ops[op], 1);
+}
+
+static void write_metrics(double wall, double rate) {
+    std::string tmp = m_filename + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "w");
+    if (!f)
+        return;
+
+    uint64_t cycles = m_cycles.load(std::memory_order_relaxed);
+    double eval = m_eval_ns.load(std::memory_order_relaxed) / 1e9;
+    if (eval > wall)
+        eval = wall;
+
+    fprintf(f, "# HELP friden_cycles_total Master clock cycles simulated.\n");
+    fprintf(f, "# TYPE friden_cycles_total counter\n");
+    fprintf(f, "friden_cycles_total %lu\n", cycles);
+    fprintf(f, "# HELP friden_cycles_per_second Cycles simulated per second, over the last interval.\n");
+    fprintf(f, "# TYPE friden_cycles_per_second gauge\n");
+    fprintf(f, "friden_cycles_per_second %.1f\n", rate);
+    fprintf(f, "# HELP friden_realtime_factor Simulated time per wall clock time, over the last interval.\n");
+    fprintf(f, "# TYPE friden_realtime_factor gauge\n");
+    fprintf(f, "friden_realtime_factor %.6f\n", rate / SIM_CLOCK_HZ);
+    fprintf(f, "# HELP friden_keys_total Keys pressed.\n");
+    fprintf(f, "# TYPE friden_keys_total counter\n");
+    fprintf(f, "friden_keys_total %lu\n", m_keys.load(std::memory_order_relaxed));
+    fprintf(f, "# HELP friden_ops_total Operations started, by the kind of key that started them.\n");
+    fprintf(f, "# TYPE friden_ops_total counter\n");
+    for (int i = 0; i < METRICS_OPS; i++)
+        fprintf(f, "friden_ops_total{op=\"%s\"} %lu\n", m_op_names[i],
+                m_ops[i].load(std::memory_order_relaxed));
+    fprintf(f, "# HELP friden_overflows_total Times the overflow lamp came on.\n");
+    fprintf(f, "# TYPE friden_overflows_total counter\n");
+    fprintf(f, "friden_overflows_total %lu\n", m_overflows.load(std::memory_order_relaxed));
+    fprintf(f, "# HELP friden_busy Whether the machine is working on a key or an operation.\n");
+    fprintf(f, "# TYPE friden_busy gauge\n");
+    fprintf(f, "friden_busy %d\n", m_busy.load(std::memory_order_relaxed));
+    fprintf(f, "# HELP friden_seconds_total Wall clock time spent, in model evaluation or host code.\n");
+    fprintf(f, "# TYPE friden_seconds_total counter\n");
+    fprintf(f, "friden_seconds_total{in=\"eval\"} %.3f\n", eval);
+    fprintf(f, "friden_seconds_total{in=\"host\"} %.3f\n", wall - eval);
+
+    fclose(f);
+    rename(tmp.c_str(), m_filename.c_str());
+}
+
+static void writer() {
+    auto last = m_start;
+    uint64_t last_cycles = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        int stop = m_cv.wait_for(lock, std::chrono::seconds(METRICS_INTERVAL), [] { return m_stop; });
+
+        auto now = std::chrono::steady_clock::now();
+        uint64_t cycles = m_cycles.load(std::memory_order_relaxed);
+        double dt = std::chrono::duration<double>(now - last).count();
+        double rate = dt > 0 ? (cycles - last_cycles) / dt : 0;
+        write_metrics(std::chrono::duration<double>(now - m_start).count(), rate);
+        last = now;
+        last_cycles = cycles;
+
+        if (stop)
+            break;
+    }
+}
+
+void metrics_start(const char *filename) {
+    if (!filename || !*filename || metrics_on)
+        return;
+
+    m_filename = filename;
+    m_start = std::chrono::steady_clock::now();
+    metrics_on = 1;
+    m_thread = std::thread(writer);
+    atexit(metrics_stop);
+}
+
+void metrics_stop() {
+    if (!metrics_on)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = 1;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    metrics_on = 0;
+}
@@ -0,0 +1,47 @@
+// Friden simulator live metrics
+// counters kept by the simulation thread and written out periodically
+// as a Prometheus text file (e.g. for node_exporter's textfile
+// collector) by a thread of their own; they are never read back by the
+// simulation, so they can't change what it does
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+// seconds between rewrites of the metrics file
+#define METRICS_INTERVAL 1
+
+// eval time is measured on one cycle in this many (a power of two)
+#define METRICS_SAMPLE 256
+
+// set while metrics are being kept
+extern int metrics_on;
+
+// starts writing metrics to filename (written to a temporary file and
+// renamed, so readers never see half of one); does nothing if filename
+// is NULL, as when +metrics+<file> isn't given
+void metrics_start(const char *filename);
+
+// writes the final metrics and stops the writer thread; called at exit
+void metrics_stop();
+
+// one master clock cycle simulated, with the overflow lamp's state
+void metrics_cycle(int overflow);
+
+// nanoseconds the model took to evaluate a sampled cycle
+void metrics_eval(uint64_t ns);
+
+// whether the machine was busy at the last sample
+void metrics_busy(int busy);
+
+// a key was pressed
+void metrics_key();
+
+// the keyboard took key c (as in keys.h), which is counted by the kind
+// of operation it starts: entry (digits, DECIMAL POINT, CHANGE SIGN),
+// add, sub, mult, div, sqrt, stack (ENTER, STORE, RECALL, REPEAT) or
+// clear (CLEAR ENTRY, CLEAR DISPLAY, CLEAR ALL, OVERFLOW LOCK)
+void metrics_op(int c);
+
+#endif
@@ -0,0 +1,148 @@
+// Friden simulator operation cache
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "Vtop.h"
+#include "sim.h"
+#include "batch.h"
+#include "snapshot.h"
+#include "dltrace.h"
+#include "lockstep.h"
+#include "opcache.h"
+
+int opcache_on = 0;
+
+struct opcache_entry {
+    uint64_t hash;
+    std::string keys;
+    int keyhold;
+    std::string before; // model state the operation started from
+    std::string after; // and ended with
+    uint64_t cycles;
+    uint64_t homes;
+    uint64_t pressed;
+};
+
+// most recently used first
+static std::list<opcache_entry> lru;
+static std::unordered_multimap<uint64_t, std::list<opcache_entry>::iterator> by_hash;
+static size_t capacity;
+
+static uint64_t hits, misses, uncached;
+static uint64_t saved; // cycles restored rather than simulated
+
+// FNV-1a
+static uint64_t fold(uint64_t h, const void *p, size_t n) {
+    const uint8_t *b = (const uint8_t *)p;
+    for (size_t i = 0; i < n; i++) {
+        h ^= b[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+int opcache_start() {
+    const char *arg = sim_plusarg("opcache");
+    if (!arg)
+        return 0;
+    char *end;
+    unsigned long n = strtoul(arg, &end, 0);
+    if (!*arg || *end || !n) {
+        fprintf(stderr, "+opcache+ needs a number of entries, not %s\n", arg);
+        return -1;
+    }
+    capacity = n;
+    opcache_on = 1;
+    return 0;
+}
+
+static int cacheable(sim_t *s, const batch_op &op) {
+#if VM_COVERAGE
+    return 0;
+#else
+    return !s->tfp && !s->engine && !lockstep_on && !dltrace_on && !strchr(op.keys, '[');
+#endif
+}
+
+static std::list<opcache_entry>::iterator lookup(uint64_t hash, const batch_op &op, int keyhold,
+                                                 const std::string &before) {
+    auto range = by_hash.equal_range(hash);
+    for (auto i = range.first; i != range.second; ++i) {
+        opcache_entry &e = *i->second;
+        if (e.keyhold == keyhold && e.keys == op.keys && e.before == before)
+            return i->second;
+    }
+    return lru.end();
+}
+
+static void forget(std::list<opcache_entry>::iterator e) {
+    auto range = by_hash.equal_range(e->hash);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second == e) {
+            by_hash.erase(i);
+            break;
+        }
+    }
+    lru.erase(e);
+}
+
+int opcache_run(sim_t *s, const batch_op &op, int *hit) {
+    *hit = 0;
+    std::string before;
+    if (!cacheable(s, op) || snapshot_save_mem(s->top, before)) {
+        uncached++;
+        return batch_run(s, op);
+    }
+
+    uint64_t hash = fold(0xcbf29ce484222325ULL, before.data(), before.size());
+    hash = fold(hash, op.keys, strlen(op.keys) + 1);
+    hash = fold(hash, &s->keyhold, sizeof(s->keyhold));
+
+    auto e = lookup(hash, op, s->keyhold, before);
+    if (e != lru.end() && !snapshot_restore_mem(s->top, e->after)) {
+        lru.splice(lru.begin(), lru, e);
+        s->cycle += e->cycles;
+        s->homes += e->homes;
+        s->keys += e->pressed;
+        s->home_prev = s->top->ff_home;
+        hits++;
+        saved += e->cycles;
+        *hit = 1;
+        return 0;
+    }
+
+    uint64_t cycle = s->cycle, homes = s->homes, pressed = s->keys;
+    int status = batch_run(s, op);
+    misses++;
+    if (status)
+        return status;
+
+    opcache_entry n;
+    if (snapshot_save_mem(s->top, n.after))
+        return 0;
+    n.hash = hash;
+    n.keys = op.keys;
+    n.keyhold = s->keyhold;
+    n.before.swap(before);
+    n.cycles = s->cycle - cycle;
+    n.homes = s->homes - homes;
+    n.pressed = s->keys - pressed;
+
+    if (lru.size() >= capacity)
+        forget(std::prev(lru.end()));
+    lru.push_front(std::move(n));
+    by_hash.emplace(hash, lru.begin());
+    return 0;
+}
+
+void opcache_summary() {
+    uint64_t looked = hits + misses;
+    printf("cache: %lu hits, %lu misses (%.1f%% hit), %lu not cacheable, "
+           "%lu cycles not simulated, %zu of %zu entries\n",
+           hits, misses, looked ? 100.0 * hits / looked : 0.0, uncached,
+           saved, lru.size(), capacity);
+}
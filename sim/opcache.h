@@ -0,0 +1,39 @@
+// Friden simulator operation cache
+// with +opcache+<entries>, batch mode remembers the outcome of each
+// operation it runs: the complete model state it started from, the
+// keys, and the state and cycle counts it ended with; running the
+// same operation from the same state again restores the state it ended
+// with instead of simulating it, so sweeps that repeat operations only
+// pay for each one once
+//
+// operations start and end on a HOME pulse with the machine idle, so
+// the same registers usually do mean the same state; the state is
+// compared in full, not just its hash, so a hit is always exact
+//
+// operations aren't cached while anything watches the cycles go by: a
+// trace, lockstep check, delay line trace, coverage or the functional
+// engine, nor if they load registers directly
+
+#ifndef OPCACHE_H
+#define OPCACHE_H
+
+#include <stdint.h>
+#include "sim.h"
+#include "batch.h"
+
+// set while operations are being cached
+extern int opcache_on;
+
+// turns the cache on with the capacity given by +opcache+<entries>; the
+// least recently used entry is dropped to make room
+// returns -1 if the capacity isn't a number
+int opcache_start();
+
+// runs op as batch_run() does, from the cache if it can; sets *hit if
+// it did
+int opcache_run(sim_t *s, const batch_op &op, int *hit);
+
+// prints the hit rate and the cycles not simulated
+void opcache_summary();
+
+#endif
@@ -0,0 +1,54 @@
+// Friden simulator model ports
+// the outputs that differ from model to model (extra counters, the
+// control flip-flops, the width of the timing chain); each simulator
+// provides its own ports.cpp reading them
+
+#ifndef PORTS_H
+#define PORTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+class Vtop;
+class Vref;
+struct shm_view_t;
+
+// name of the model, e.g. "ec130"
+extern const char *ports_model;
+
+// delay line bit at the start of the S register's digit 0 cell, as of
+// the start of a HOME pulse; the rest of the layout follows from it
+// (see dl.cpp)
+extern const int ports_dl_origin;
+
+// fills in the counters, timing and control flip-flops of a state view
+void ports_read(Vtop *top, shm_view_t *v);
+
+// sets control flip-flop bit to the state of a port, and marks it present
+#define PORTS_FF(v, bit, port) \
+    ((v)->ffs |= (uint32_t)((port) & 1) << (bit), (v)->ffs_present |= 1u << (bit))
+
+// for the lockstep check (lockstep.h), which needs every port: each
+// ports.cpp lists its model's ports as PORTS_INPUTS(X) and
+// PORTS_OUTPUTS(X), and includes ports_lockstep.h for these
+
+// most bytes ports_inputs() writes
+#define PORTS_INPUTS_MAX 64
+
+// copies the inputs of top to buf, returning the bytes written
+size_t ports_inputs(Vtop *top, uint8_t *buf);
+
+// sets the inputs of top (or ref) from buf
+void ports_set_inputs(Vtop *top, const uint8_t *buf);
+void ports_set_inputs(Vref *ref, const uint8_t *buf);
+
+// folds all the outputs of top (or ref) into h
+uint64_t ports_hash(Vtop *top, uint64_t h);
+uint64_t ports_hash(Vref *ref, uint64_t h);
+
+// prints each output that differs between top and ref, with its value
+// in both; returns how many did
+int ports_diff(FILE *f, Vtop *top, Vref *ref);
+
+#endif
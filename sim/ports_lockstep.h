@@ -0,0 +1,76 @@
+// Friden simulator model ports for the lockstep check
+// included by each ports.cpp in builds with the reference model
+// (LOCKSTEP), after defining PORTS_INPUTS(X) and PORTS_OUTPUTS(X) as
+// X(port) for each of its ports; the reference is a build of the same
+// simulator, so it has the same ports in the same form
+
+#ifndef PORTS_LOCKSTEP_H
+#define PORTS_LOCKSTEP_H
+
+#include <string.h>
+#include "Vref.h"
+#include "ports.h"
+
+// FNV-1a over the bytes of a port
+template <typename T> static inline uint64_t ports_fold(uint64_t h, const T &port) {
+    const uint8_t *p = (const uint8_t *)&port;
+    for (size_t i = 0; i < sizeof(port); i++)
+        h = (h ^ p[i]) * 0x100000001b3ull;
+    return h;
+}
+
+template <typename T> static inline void ports_print(FILE *f, const T &port) {
+    fprintf(f, "%lx", (unsigned long)port);
+}
+
+// arrays (the decoded registers) as one digit per element, last first
+template <typename T, size_t N> static inline void ports_print(FILE *f, const T (&port)[N]) {
+    for (size_t i = N; i-- > 0;)
+        fprintf(f, "%lx", (unsigned long)port[i]);
+}
+
+size_t ports_inputs(Vtop *top, uint8_t *buf) {
+    size_t n = 0;
+#define PORTS_GET(port) memcpy(buf + n, &top->port, sizeof(top->port)); n += sizeof(top->port);
+    PORTS_INPUTS(PORTS_GET)
+#undef PORTS_GET
+    return n;
+}
+
+template <class M> static void ports_set(M *m, const uint8_t *buf) {
+    size_t n = 0;
+#define PORTS_SET(port) memcpy(&m->port, buf + n, sizeof(m->port)); n += sizeof(m->port);
+    PORTS_INPUTS(PORTS_SET)
+#undef PORTS_SET
+}
+
+void ports_set_inputs(Vtop *top, const uint8_t *buf) { ports_set(top, buf); }
+void ports_set_inputs(Vref *ref, const uint8_t *buf) { ports_set(ref, buf); }
+
+template <class M> static uint64_t ports_hash_outputs(M *m, uint64_t h) {
+#define PORTS_HASH(port) h = ports_fold(h, m->port);
+    PORTS_OUTPUTS(PORTS_HASH)
+#undef PORTS_HASH
+    return h;
+}
+
+uint64_t ports_hash(Vtop *top, uint64_t h) { return ports_hash_outputs(top, h); }
+uint64_t ports_hash(Vref *ref, uint64_t h) { return ports_hash_outputs(ref, h); }
+
+int ports_diff(FILE *f, Vtop *top, Vref *ref) {
+    int n = 0;
+#define PORTS_DIFF(port) \
+    if (memcmp(&top->port, &ref->port, sizeof(top->port))) { \
+        fprintf(f, "  %-14s ", #port); \
+        ports_print(f, top->port); \
+        fprintf(f, " (reference "); \
+        ports_print(f, ref->port); \
+        fprintf(f, ")\n"); \
+        n++; \
+    }
+    PORTS_OUTPUTS(PORTS_DIFF)
+#undef PORTS_DIFF
+    return n;
+}
+
+#endif
@@ -0,0 +1,64 @@
+// Friden simulator real-time pacing
+
+#include <poll.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "typeahead.h"
+#include "realtime.h"
+
+static int64_t since(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t).count();
+}
+
+static void rebase(realtime_t *r, sim_t *s) {
+    r->base = std::chrono::steady_clock::now();
+    r->base_cycle = s->cycle;
+    r->checked = s->cycle;
+}
+
+void realtime_init(realtime_t *r, sim_t *s) {
+    r->on = sim_plusflag("realtime");
+    r->settle_homes = s->homes + SETTLE_HOMES;
+    r->skipped = 0;
+    rebase(r, s);
+}
+
+int64_t realtime_delay(realtime_t *r, sim_t *s) {
+    if (s->cycle - r->checked < REALTIME_SLICE)
+        return 0;
+    r->checked = s->cycle;
+
+    int64_t ahead = (int64_t)((s->cycle - r->base_cycle) * 1000000 / REALTIME_CLOCK) - since(r->base);
+    if (ahead < -REALTIME_MAX_LAG_US) {
+        rebase(r, s);
+        return 0;
+    }
+    return ahead > 0 ? ahead : 0;
+}
+
+int realtime_idle(realtime_t *r, sim_t *s, typeahead_t *q) {
+    // as sim_wait_idle(): not busy, and SETTLE_HOMES HOME pulses since
+    if (sim_busy(s->top) || !typeahead_idle(q)) {
+        r->settle_homes = s->homes + SETTLE_HOMES;
+        return 0;
+    }
+    return s->homes >= r->settle_homes;
+}
+
+void realtime_poll(int64_t timeout_us, int fd) {
+    struct pollfd fds[2] = {{0, POLLIN, 0}, {fd, POLLIN, 0}};
+    // rounded up, so a short wait isn't a busy one
+    poll(fds, fd >= 0 ? 2 : 1, timeout_us < 0 ? -1 : (int)((timeout_us + 999) / 1000));
+}
+
+uint64_t realtime_resume(realtime_t *r, sim_t *s) {
+    uint64_t cycles = (uint64_t)since(r->base) * REALTIME_CLOCK / 1000000;
+    cycles = cycles > s->cycle - r->base_cycle ? cycles - (s->cycle - r->base_cycle) : 0;
+    r->skipped += cycles;
+    rebase(r, s);
+    // whatever woke it (the DP switch, say) gets to reach the outputs
+    // before it's parked again
+    r->settle_homes = s->homes + SETTLE_HOMES;
+    return cycles;
+}
@@ -0,0 +1,65 @@
+// Friden simulator real-time pacing
+// with +realtime, the interactive simulators run the model at the speed
+// of the real machine instead of as fast as the host can, sleeping (or
+// waiting on the keyboard) whenever simulated time gets ahead of the
+// wall clock
+//
+// once the machine is idle with nothing left to do (no keys queued or
+// held, not busy, and the register outputs settled), the model isn't
+// run at all until a key comes in: idle, it only recirculates the same
+// digits, so the wall clock time spent parked is skipped rather than
+// simulated, and the next key is taken from the same point in the
+// recirculation a real one would have found sooner or later; anything
+// that follows time itself (the EC-132 clock) adds the cycles skipped
+// from realtime_resume()
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stdint.h>
+#include <chrono>
+#include "sim.h"
+
+struct typeahead_t;
+
+// the master clock, in Hz
+#define REALTIME_CLOCK 2666667
+
+// cycles between looks at the wall clock
+#define REALTIME_SLICE 4096
+
+// if the model falls this far behind the wall clock (a slow host, or
+// the process was stopped), it starts keeping time again from where it
+// is instead of racing to catch up
+#define REALTIME_MAX_LAG_US 100000
+
+struct realtime_t {
+    int on; // set by +realtime
+    std::chrono::steady_clock::time_point base; // when base_cycle was simulated
+    uint64_t base_cycle;
+    uint64_t checked; // cycle of the last look at the wall clock
+    uint64_t settle_homes; // HOME pulse count the outputs have settled at
+    uint64_t skipped; // cycles skipped while parked, in all
+};
+
+// turns pacing on if +realtime was given
+void realtime_init(realtime_t *r, sim_t *s);
+
+// called after every sim_cycle(); returns the microseconds to wait for
+// the wall clock to catch up with the model, or 0
+int64_t realtime_delay(realtime_t *r, sim_t *s);
+
+// called after every sim_cycle() and typeahead_cycle(); true once the
+// machine has nothing to do until the next key, so the model can be
+// parked
+int realtime_idle(realtime_t *r, sim_t *s, typeahead_t *q);
+
+// waits up to timeout_us (forever if negative) for input on standard
+// input or on fd (if it isn't -1)
+void realtime_poll(int64_t timeout_us, int fd);
+
+// called when the model is run again after being parked; starts keeping
+// time from now, and returns the cycles that went by meanwhile
+uint64_t realtime_resume(realtime_t *r, sim_t *s);
+
+#endif
@@ -0,0 +1,291 @@
+// Friden simulator scenarios
+//
+// a wait is a predicate on the scenario's model, checked before each
+// of its cycles; the key holds and idle waits follow sim_press() and
+// sim_wait_idle(), with their loops turned into phases so that the
+// scheduler can leave a wait half way and come back to it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <verilated.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "dl.h"
+#include "snapshot.h"
+#include "metrics.h"
+#include "engine.h"
+#include "lockstep.h"
+#include "scenario.h"
+
+#define SCENARIO_NEVER UINT64_MAX
+
+static int press_until(scenario_t *t) {
+    sim_t *s = &t->s;
+    uint64_t held = s->cycle - t->mark;
+
+    switch (t->phase) {
+        case 0:
+            // with adaptive holds, let go shortly after the ack
+            if (s->keyhold == KEYHOLD_ADAPTIVE && s->top->kbd_ack && held < KEY_DELAY) {
+                t->phase = 1;
+                t->mark2 = s->cycle;
+                return 0;
+            }
+            if (held < KEY_DELAY)
+                return 0;
+            key_release_all(s->top);
+            if (s->keyhold != KEYHOLD_ADAPTIVE)
+                return 1;
+            t->phase = 2;
+            t->mark2 = s->cycle;
+            return 0;
+        case 1:
+            if (s->cycle - t->mark2 < KEY_MIN_HOLD && held < KEY_DELAY)
+                return 0;
+            key_release_all(s->top);
+            t->phase = 2;
+            t->mark2 = s->cycle;
+            return 0;
+        default:
+            // the gap before the next key
+            return s->cycle - t->mark2 >= KEY_MIN_GAP;
+    }
+}
+
+// idle, then mark HOME pulses more
+static int homes_until(scenario_t *t) {
+    sim_t *s = &t->s;
+    if (!t->phase) {
+        if (sim_busy(s->top))
+            return 0;
+        t->phase = 1;
+        t->mark2 = s->homes + t->mark;
+    }
+    return s->homes >= t->mark2;
+}
+
+// presses c and starts holding it; returns 0 if c is not a key
+static int press_start(scenario_t *t, int c) {
+    if (!key_press(t->s.top, c)) {
+        fprintf(stderr, "%s[%d]: unknown key '%c'\n", t->name, t->arg, c);
+        t->failures++;
+        return 0;
+    }
+    t->s.keys++;
+    if (metrics_on)
+        metrics_key();
+    t->phase = 0;
+    t->mark = t->s.cycle;
+    return 1;
+}
+
+static int type_until(scenario_t *t) {
+    while (!t->step || t->step(t)) {
+        if (t->step == press_until) {
+            // as in batch_run(): with adaptive holds, only the last key
+            // needs the registers to have settled
+            int last = !*t->next;
+            t->phase = 0;
+            t->mark = !last && t->s.keyhold == KEYHOLD_ADAPTIVE ? 1 : SETTLE_HOMES;
+            t->step = homes_until;
+            continue;
+        }
+        if (!*t->next || !press_start(t, *t->next++))
+            return 1;
+        t->step = press_until;
+    }
+    return 0;
+}
+
+static int cycles_until(scenario_t *t) {
+    return t->s.cycle >= t->mark;
+}
+
+static int now_until(scenario_t *t) {
+    (void)t;
+    return 1;
+}
+
+scenario_wait scenario_t::press(int c) {
+    deadline = SCENARIO_NEVER;
+    waiting = "key";
+    until = press_start(this, c) ? press_until : now_until;
+    return {};
+}
+
+scenario_wait scenario_t::type(const char *keys, uint64_t timeout) {
+    next = keys;
+    step = nullptr;
+    deadline = s.cycle + timeout;
+    waiting = "keys";
+    until = type_until;
+    return {};
+}
+
+scenario_wait scenario_t::idle(uint64_t timeout) {
+    phase = 0;
+    mark = SETTLE_HOMES;
+    deadline = s.cycle + timeout;
+    waiting = "idle";
+    until = homes_until;
+    return {};
+}
+
+scenario_wait scenario_t::ready(uint64_t timeout) {
+    phase = 0;
+    mark = 1;
+    deadline = s.cycle + timeout;
+    waiting = "ready";
+    until = homes_until;
+    return {};
+}
+
+scenario_wait scenario_t::cycles(uint64_t n) {
+    mark = s.cycle + n;
+    deadline = SCENARIO_NEVER;
+    waiting = "cycles";
+    until = cycles_until;
+    return {};
+}
+
+int scenario_t::reg_is(int reg, const char *value) {
+    uint8_t digits[16];
+    if (dl_parse(value, s.top->sw_dp, digits))
+        return 0;
+    // the sign and digits 2 to 14
+    return !memcmp(&digits[1], sim_reg(s.top, reg) + 1, 14);
+}
+
+void scenario_t::expect(int ok, const char *what, const char *file, int line) {
+    if (ok)
+        return;
+    failures++;
+    printf("%s[%d]: %s:%d: expected %s at cycle %lu\n", name, arg, file, line, what, s.cycle);
+    sim_print_regs(stdout, s.top);
+}
+
+// a model like the one main() sets up, started from the power-on image
+static Vtop *scenario_model(Vtop *like) {
+    Vtop *top = new Vtop;
+    key_release_all(top);
+    top->sw_dp = like->sw_dp;
+    top->eval();
+    if (snapshot_poweron(top)) {
+        fprintf(stderr, "can't read power-on image %s\n", sim_plusarg("poweron"));
+        exit(1);
+    }
+    return top;
+}
+
+static int scenario_named(const char *names, const char *name) {
+    if (!strcmp(names, "all"))
+        return 1;
+    size_t len = strlen(name);
+    for (const char *p = names; *p; ) {
+        size_t n = strcspn(p, ",");
+        if (n == len && !strncmp(p, name, len))
+            return 1;
+        p += n;
+        if (*p)
+            p++;
+    }
+    return 0;
+}
+
+int scenario_main(Vtop *top, VerilatedVcdC *tfp, const char *names) {
+    int keyhold = sim_keyhold_arg(KEYHOLD_ADAPTIVE);
+    int engine = engine_arg() == ENGINE_FUNC;
+
+    std::vector<scenario_t *> list;
+    std::vector<scenario_task> tasks;
+    for (int d = 0; scenario_list[d].name; d++) {
+        const scenario_def &def = scenario_list[d];
+        if (!scenario_named(names, def.name))
+            continue;
+        for (int i = 0; i < def.count; i++) {
+            scenario_t *t = new scenario_t();
+            Vtop *model = list.empty() ? top : scenario_model(top);
+            sim_init(&t->s, model);
+            if (list.empty())
+                t->s.tfp = tfp;
+            if (engine)
+                t->s.engine = engine_new(model);
+            t->s.keyhold = keyhold;
+            t->name = def.name;
+            t->arg = i;
+            list.push_back(t);
+            tasks.push_back(def.fn(*t));
+        }
+    }
+    if (list.empty()) {
+        fprintf(stderr, "no scenario called %s\n", names);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // give each model a quantum in turn, resuming its scenario whenever
+    // its wait is over
+    std::vector<int> done(list.size(), 0);
+    size_t live = list.size();
+    while (live) {
+        for (size_t i = 0; i < list.size(); i++) {
+            if (done[i])
+                continue;
+            scenario_t *t = list[i];
+            for (uint64_t q = 0; q < SCENARIO_QUANTUM; ) {
+                if (!t->until || t->until(t)) {
+                    t->until = nullptr;
+                    tasks[i].h.resume();
+                    if (tasks[i].h.done()) {
+                        done[i] = 1;
+                        break;
+                    }
+                    continue;
+                }
+                if (t->s.cycle >= t->deadline) {
+                    printf("%s[%d]: timed out waiting for %s at cycle %lu\n",
+                           t->name, t->arg, t->waiting, t->s.cycle);
+                    sim_print_regs(stdout, t->s.top);
+                    t->failures++;
+                    done[i] = 1;
+                    break;
+                }
+                sim_cycle(&t->s);
+                q++;
+            }
+            if (done[i])
+                live--;
+        }
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t cycles = 0;
+    int failed = 0;
+    for (scenario_t *t : list) {
+        cycles += t->s.cycle;
+        failed += t->failures > 0;
+    }
+    printf("scenarios: %d of %zu failed, %lu cycles in %.2f s (%.1f kcycles/s)\n",
+           failed, list.size(), cycles, secs, secs > 0 ? cycles / secs / 1000.0 : 0.0);
+
+    // the check needs the models to go back to if it finds a difference
+    if (lockstep_on)
+        lockstep_stop();
+
+    // the scenarios go before the models they hold references into
+    tasks.clear();
+    for (scenario_t *t : list) {
+        if (t->s.engine)
+            engine_delete(t->s.engine);
+        if (t->s.top != top)
+            delete t->s.top;
+        delete t;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+// Friden simulator scenarios
+// tests written as C++20 coroutines, each driving a model of its own:
+//
+//     static scenario_task mult(scenario_t &t) {
+//         co_await t.type("6\n7");
+//         co_await t.press('*');
+//         co_await t.idle();
+//         SCENARIO_EXPECT(t, t.reg_is(DL_REG_1, "42"));
+//     }
+//
+// one scheduler runs any number of them side by side: each model is
+// only clocked, and its scenario only resumed, when what it waits on
+// has happened, so there's no per-cycle test code beyond that check
+//
+// scenarios are listed in scenarios.cpp and picked with
+// +scenario+<name>[,<name>...] (or +scenario+all)
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdint.h>
+#include <coroutine>
+#include <exception>
+#include "sim.h"
+#include "dl.h"
+
+class VerilatedVcdC;
+
+// cycles a model is run for before the scheduler moves on to the next
+// one: a word time (delay line recirculation)
+#define SCENARIO_QUANTUM 14400
+
+// the coroutine of a scenario; it starts suspended, and the scheduler
+// resumes it each time what it waits on is over
+struct scenario_task {
+    struct promise_type {
+        scenario_task get_return_object() {
+            return scenario_task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> h;
+
+    explicit scenario_task(std::coroutine_handle<promise_type> h) : h(h) {}
+    scenario_task(scenario_task &&o) : h(o.h) { o.h = nullptr; }
+    scenario_task(const scenario_task &) = delete;
+    ~scenario_task() {
+        if (h)
+            h.destroy();
+    }
+};
+
+// what co_await on a wait returns to the scheduler; the wait itself is
+// set up in the scenario_t by the call that returned it
+struct scenario_wait {
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<>) {}
+    void await_resume() {}
+};
+
+struct scenario_t {
+    sim_t s;
+    const char *name;
+    int arg; // which instance of the scenario, 0 to count - 1
+    int failures;
+
+    // the current wait: over once until returns true; with a deadline,
+    // the scenario fails and is stopped if it isn't over by then
+    int (*until)(scenario_t *t);
+    uint64_t deadline;
+    const char *waiting; // what on, for the failure message
+    uint64_t mark;
+    uint64_t mark2;
+    int phase;
+    const char *next; // keys left to type
+    int (*step)(scenario_t *t); // the press or wait typing them is at
+
+    // presses key c (as in keys.h) and holds it as set by s.keyhold
+    scenario_wait press(int c);
+
+    // presses keys one after the other, as batch mode does, and waits
+    // until the machine is idle after the last
+    scenario_wait type(const char *keys, uint64_t timeout = OP_TIMEOUT);
+
+    // waits until the machine is idle and the registers have settled
+    scenario_wait idle(uint64_t timeout = OP_TIMEOUT);
+
+    // waits until the machine is idle and can take the next key
+    scenario_wait ready(uint64_t timeout = OP_TIMEOUT);
+
+    // waits n cycles
+    scenario_wait cycles(uint64_t n);
+
+    // true if decoded register reg (DL_REG_S to DL_REG_4) holds value,
+    // e.g. "-12.5", with the decimal point where the DP switch has it
+    int reg_is(int reg, const char *value);
+
+    // records a failure unless ok; use SCENARIO_EXPECT
+    void expect(int ok, const char *what, const char *file, int line);
+};
+
+#define SCENARIO_EXPECT(t, cond) (t).expect((cond), #cond, __FILE__, __LINE__)
+
+typedef scenario_task (*scenario_fn)(scenario_t &t);
+
+struct scenario_def {
+    const char *name;
+    scenario_fn fn;
+    int count; // instances to run, each with its own model and arg
+};
+
+// all the scenarios, terminated by {NULL, NULL, 0}; see scenarios.cpp
+extern const scenario_def scenario_list[];
+
+// runs the scenarios named in names (separated by commas, or "all"),
+// the first of them on top (and traced to tfp, if given) and each of
+// the others on a new model started from the power-on image
+// returns the process exit status: 1 if any of them failed
+int scenario_main(Vtop *top, VerilatedVcdC *tfp, const char *names);
+
+#endif
@@ -0,0 +1,96 @@
+// Friden simulator scenarios
+// the tests +scenario+<name> runs (see scenario.h); they only use the
+// keys every model has, so they're shared by all the simulators
+//
+// each starts with CLEAR ALL, so none depends on the state its model
+// was left in: the first runs on the model main() set up, which only
+// starts cleared with a power-on image
+
+#include <stdio.h>
+#include "sim.h"
+#include "dl.h"
+#include "scenario.h"
+
+// CLEAR ALL, then 4 ENTER 7 MULT, with the registers printed along the
+// way; the default run of a traced build, for recording a trace file
+static scenario_task test_trace(scenario_t &t) {
+    co_await t.type("c");
+    printf("CLR ALL\n");
+    sim_print_regs(stdout, t.s.top);
+
+    co_await t.type("4\n");
+    co_await t.type("7");
+    printf("4 ENTER 7\n");
+    sim_print_regs(stdout, t.s.top);
+
+    co_await t.press('*');
+    co_await t.idle();
+    printf("MULT\n");
+    sim_print_regs(stdout, t.s.top);
+    SCENARIO_EXPECT(t, t.reg_is(DL_REG_1, "28"));
+}
+
+// a + b for a and b from 0 to 9, one pair per instance
+static scenario_task test_add(scenario_t &t) {
+    int a = t.arg / 10, b = t.arg % 10;
+    char x[16], y[16], want[16];
+    snprintf(x, sizeof(x), "%d\n", a);
+    snprintf(y, sizeof(y), "%d+", b);
+    snprintf(want, sizeof(want), "%d", a + b);
+
+    co_await t.type("c");
+    co_await t.type(x);
+    co_await t.type(y);
+    SCENARIO_EXPECT(t, t.reg_is(DL_REG_1, want));
+}
+
+// a - b for a from 10 to 19 and b from 0 to 9
+static scenario_task test_sub(scenario_t &t) {
+    int a = 10 + t.arg / 10, b = t.arg % 10;
+    char x[16], y[16], want[16];
+    snprintf(x, sizeof(x), "%d\n", a);
+    snprintf(y, sizeof(y), "%d-", b);
+    snprintf(want, sizeof(want), "%d", a - b);
+
+    co_await t.type("c");
+    co_await t.type(x);
+    co_await t.type(y);
+    SCENARIO_EXPECT(t, t.reg_is(DL_REG_1, want));
+}
+
+// the multiplication table up to 9 x 9
+static scenario_task test_mult(scenario_t &t) {
+    int a = t.arg / 10, b = t.arg % 10;
+    char x[16], y[16], want[16];
+    snprintf(x, sizeof(x), "%d\n", a);
+    snprintf(y, sizeof(y), "%d*", b);
+    snprintf(want, sizeof(want), "%d", a * b);
+
+    co_await t.type("c");
+    co_await t.type(x);
+    co_await t.type(y);
+    SCENARIO_EXPECT(t, t.reg_is(DL_REG_1, want));
+}
+
+// and back again: q * b / b for q from 0 to 9 and b from 1 to 9
+static scenario_task test_div(scenario_t &t) {
+    int q = t.arg / 9, b = 1 + t.arg % 9;
+    char x[16], y[16], want[16];
+    snprintf(x, sizeof(x), "%d\n", q * b);
+    snprintf(y, sizeof(y), "%d/", b);
+    snprintf(want, sizeof(want), "%d", q);
+
+    co_await t.type("c");
+    co_await t.type(x);
+    co_await t.type(y);
+    SCENARIO_EXPECT(t, t.reg_is(DL_REG_1, want));
+}
+
+const scenario_def scenario_list[] = {
+    {"trace", test_trace, 1},
+    {"add",   test_add,   100},
+    {"sub",   test_sub,   100},
+    {"mult",  test_mult,  100},
+    {"div",   test_div,   90},
+    {NULL,    NULL,       0}
+};
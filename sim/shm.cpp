@@ -0,0 +1,111 @@
+// Friden simulator shared state
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <verilated.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "shm_view.h"
+#include "shm.h"
+#include "ports.h"
+
+int shm_on = 0;
+
+static shm_view_t *view;
+static uint64_t interval;
+static uint64_t countdown;
+
+int shm_start(const char *name) {
+    if (!name || !*name || shm_on)
+        return 0;
+
+    char path[256] = "/";
+    strncat(path, name + (name[0] == '/'), sizeof(path) - 2);
+
+    int fd = shm_open(path, O_CREAT | O_RDWR, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(shm_view_t))) {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    void *p = mmap(NULL, sizeof(shm_view_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+
+    const char *arg = sim_plusarg("shm_interval");
+    interval = arg ? strtoull(arg, NULL, 0) : SHM_INTERVAL;
+    if (!interval)
+        interval = SHM_INTERVAL;
+    countdown = 1;
+
+    // readers check the header before anything else, so fill it in
+    // with seq odd, as an update would
+    view = (shm_view_t *)p;
+    __atomic_store_n(&view->seq, view->seq | 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memset((char *)view + offsetof(shm_view_t, cycle), 0,
+           sizeof(shm_view_t) - offsetof(shm_view_t, cycle));
+    view->magic = SHM_VIEW_MAGIC;
+    view->version = SHM_VIEW_VERSION;
+    view->size = sizeof(shm_view_t);
+    view->running = 1;
+    snprintf(view->model, sizeof(view->model), "%s", ports_model);
+    view->interval = interval;
+    __atomic_store_n(&view->seq, view->seq + 1, __ATOMIC_RELEASE);
+
+    shm_on = 1;
+    atexit(shm_stop);
+    return 0;
+}
+
+void shm_stop() {
+    if (!shm_on)
+        return;
+    __atomic_store_n(&view->running, 0, __ATOMIC_RELEASE);
+    munmap(view, sizeof(shm_view_t));
+    view = nullptr;
+    shm_on = 0;
+}
+
+static void publish(sim_t *s) {
+    Vtop *top = s->top;
+    uint32_t seq = view->seq;
+
+    __atomic_store_n(&view->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    view->cycle = s->cycle;
+    memcpy(view->reg[0], &top->reg_s[0], 16);
+    memcpy(view->reg[1], &top->reg_0[0], 16);
+    memcpy(view->reg[2], &top->reg_1[0], 16);
+    memcpy(view->reg[3], &top->reg_2[0], 16);
+    memcpy(view->reg[4], &top->reg_3[0], 16);
+    memcpy(view->reg[5], &top->reg_4[0], 16);
+    view->sw_dp = top->sw_dp;
+    view->kbd_lock = top->kbd_lock;
+    view->kbd_ack = top->kbd_ack;
+    view->lamp_overflow = top->lamp_overflow;
+    view->phase = top->phase;
+    view->dp_cnt = top->dp_cnt;
+    view->ffs = 0;
+    view->ffs_present = 0;
+    ports_read(top, view);
+
+    __atomic_store_n(&view->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void shm_cycle(sim_t *s) {
+    if (--countdown)
+        return;
+    countdown = interval;
+    publish(s);
+}
@@ -0,0 +1,30 @@
+// Friden simulator shared state
+// publishes the registers and control state in POSIX shared memory for
+// monitors outside the simulator (layout and reader in shm_view.h)
+
+#ifndef SHM_H
+#define SHM_H
+
+#include "sim.h"
+
+// cycles between updates, unless given by +shm_interval+<cycles>:
+// one word time (delay line recirculation)
+#define SHM_INTERVAL 14400
+
+// set while the state is being published
+extern int shm_on;
+
+// creates the shared memory object name (from +shm+<name>) and starts
+// publishing; does nothing if name is NULL
+// returns -1 if the object couldn't be created
+int shm_start(const char *name);
+
+// marks the state as no longer running and unmaps it; called at exit
+// (the object is left behind for monitors, until removed with shm_unlink
+// or from /dev/shm)
+void shm_stop();
+
+// called every cycle; updates the state every interval cycles
+void shm_cycle(sim_t *s);
+
+#endif
@@ -0,0 +1,140 @@
+// Friden simulator shared state view
+// the fixed layout of the state block a simulator publishes in POSIX
+// shared memory with +shm+<name>, and a small reader for it; this
+// header needs nothing from Verilator, so monitors can include it on
+// their own (see tools/shm_tail.cpp)
+//
+// the simulator rewrites the block every interval cycles under a
+// seqlock: seq is odd while an update is being written, so a reader
+// copies the block and only keeps the copy if seq was even and the same
+// before and after
+
+#ifndef SHM_VIEW_H
+#define SHM_VIEW_H
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define SHM_VIEW_MAGIC 0x4e444946 // "FIDN"
+#define SHM_VIEW_VERSION 1
+
+// reads give up after this many updates got in the way
+#define SHM_VIEW_TRIES 1000
+
+// counters a model doesn't have read as this
+#define SHM_CNT_NONE 0xff
+
+// control flip-flops, as bits of shm_view_t::ffs; ffs_present has the
+// bits of those the model has
+enum {
+    SHM_FF_START,
+    SHM_FF_HOME,
+    SHM_FF_COM_DIG,
+    SHM_FF_COM_FUN,
+    SHM_FF_MULT,
+    SHM_FF_DIV,
+    SHM_FF_SQRT,
+    SHM_FF_ADD_SUB,
+    SHM_FF_CHG_SIGN,
+    SHM_FF_SHIFT_DOWN,
+    SHM_FF_STORE,
+    SHM_FF_RECALL,
+    SHM_FF_REPEAT,
+    SHM_FF_CLR_DISP,
+    SHM_FF_CFS,
+    SHM_FF_SIGN_CONT,
+    SHM_FF_DPS,
+    SHM_FF_OF,
+    SHM_FF_CARRY,
+    SHM_FF_CARRY_OF,
+    SHM_FFS
+};
+
+// their names, in the order above, for printing
+static const char *const shm_ff_names[SHM_FFS] = {
+    "start", "home", "com_dig", "com_fun", "mult", "div", "sqrt", "add_sub",
+    "chg_sign", "shift_down", "store", "recall", "repeat", "clr_disp",
+    "cfs", "sign_cont", "dps", "of", "carry", "carry_of"
+};
+
+struct shm_view_t {
+    // set once when the simulator starts
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size; // sizeof(shm_view_t)
+    uint32_t running; // cleared when the simulator exits
+    char model[16]; // e.g. "ec130"
+    uint64_t interval; // cycles between updates
+
+    uint32_t seq;
+    uint32_t reserved;
+
+    // state as of the last update
+    uint64_t cycle;
+    uint8_t reg[6][16]; // reg_s, reg_0 to reg_4; sign in 1, digits 2 to 14
+    uint32_t timing;
+    uint32_t ffs;
+    uint32_t ffs_present;
+    uint8_t sw_dp;
+    uint8_t kbd_lock;
+    uint8_t kbd_ack;
+    uint8_t lamp_overflow;
+    uint8_t phase;
+    uint8_t dp_cnt;
+    uint8_t a_cnt;
+    uint8_t b_cnt;
+    uint8_t c_cnt;
+    uint8_t d_cnt;
+    uint8_t pad[6];
+};
+
+// maps the state block read-only; name as given to +shm+ (a leading /
+// is added if it's missing); returns NULL if it doesn't exist or has
+// another layout
+static inline const shm_view_t *shm_view_open(const char *name) {
+    char path[256] = "/";
+    strncat(path, name + (name[0] == '/'), sizeof(path) - 2);
+
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+    void *p = mmap(NULL, sizeof(shm_view_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    const shm_view_t *v = (const shm_view_t *)p;
+    if (v->magic != SHM_VIEW_MAGIC || v->version != SHM_VIEW_VERSION ||
+        v->size != sizeof(shm_view_t)) {
+        munmap(p, sizeof(shm_view_t));
+        return NULL;
+    }
+    return v;
+}
+
+static inline void shm_view_close(const shm_view_t *v) {
+    munmap((void *)v, sizeof(shm_view_t));
+}
+
+// copies a consistent snapshot of the block into out
+// returns -1 if the simulator kept updating it
+static inline int shm_view_read(const shm_view_t *v, shm_view_t *out) {
+    for (int i = 0; i < SHM_VIEW_TRIES; i++) {
+        uint32_t seq = __atomic_load_n(&v->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy(out, v, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&v->seq, __ATOMIC_RELAXED) == seq)
+            return 0;
+    }
+    return -1;
+}
+
+#endif
@@ -0,0 +1,242 @@
+// Friden simulator host-side helpers
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <verilated.h>
+#include "verilated_vcd_c.h"
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "metrics.h"
+#include "engine.h"
+#include "shm.h"
+#include "dltrace.h"
+#include "lockstep.h"
+#include "trace_writer.h"
+
+void sim_init(sim_t *s, Vtop *top) {
+    s->top = top;
+    s->tfp = nullptr;
+    s->engine = nullptr;
+    s->hook = nullptr;
+    s->hook_cycle = 0;
+    s->cycle = 0;
+    s->homes = 0;
+    s->home_prev = top->ff_home;
+    s->home_at = 0;
+    s->keyhold = KEYHOLD_FIXED;
+    s->keys = 0;
+    s->ack_prev = top->kbd_ack;
+    s->press_ack = 0;
+    s->press_release = 0;
+#ifdef SINGLE_CLOCK
+    // the first eval() only sets up the model, so toggling clk on the
+    // first cycle wouldn't otherwise be seen as an edge
+    top->eval();
+#endif
+}
+
+void sim_cycle(sim_t *s) {
+    Vtop *top = s->top;
+
+    // time the model on a sample of cycles for the metrics
+    int sample = metrics_on && !(s->cycle & (METRICS_SAMPLE - 1));
+    std::chrono::steady_clock::time_point t0;
+    if (sample)
+        t0 = std::chrono::steady_clock::now();
+
+    if (s->engine) {
+        for (int clk = 0; clk < 2; clk++) {
+            top->clk = clk;
+            engine_eval(s->engine, top);
+        }
+    }
+    else {
+#ifdef SINGLE_CLOCK
+        // both edges of clk are master clocks (see clock.vh), so a
+        // cycle is one toggle and one eval()
+#if VM_TRACE
+        if (s->tfp)
+            trace_dump(s->tfp, 10*s->cycle);
+#endif
+        top->clk = !top->clk;
+        top->eval();
+#else
+        // Verilator only sees a rising edge after evaluating clk low, so
+        // both halves are needed
+        for (int clk = 0; clk < 2; clk++) {
+#if VM_TRACE
+            if (s->tfp)
+                trace_dump(s->tfp, 10*s->cycle + 5*clk);
+#endif
+            top->clk = clk;
+            top->eval();
+        }
+#endif
+    }
+
+    if (sample) {
+        metrics_eval(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+        metrics_busy(sim_busy(top));
+    }
+    if (metrics_on) {
+        metrics_cycle(top->lamp_overflow);
+        // count operations by the key that starts them as the keyboard
+        // takes it, so interactive runs are counted as well as batch ones
+        if (top->kbd_ack && !s->ack_prev)
+            metrics_op(key_down(top));
+    }
+    s->ack_prev = top->kbd_ack;
+
+    if ((top->ff_home && !s->home_prev) ||
+        (top->ff_start && s->cycle - s->home_at >= WORD_CYCLES)) {
+        s->homes++;
+        s->home_at = s->cycle;
+    }
+    s->home_prev = top->ff_home;
+    s->cycle++;
+
+    if (shm_on)
+        shm_cycle(s);
+    if (dltrace_on)
+        dltrace_cycle(s);
+    if (lockstep_on)
+        lockstep_cycle(s);
+
+    if (s->hook && s->cycle == s->hook_cycle) {
+        void (*hook)(sim_t *) = s->hook;
+        s->hook = nullptr;
+        hook(s);
+    }
+}
+
+int sim_busy(Vtop *top) {
+    // START stays set after CLEAR ALL until the next key, so it isn't
+    // a sign of activity on its own
+    return top->kbd_lock || top->ff_com_fun || top->ff_com_dig;
+}
+
+// waits for the machine to go idle, then for n more HOME pulses
+static int64_t wait_homes(sim_t *s, uint64_t timeout, int n) {
+    uint64_t start = s->cycle;
+
+    while (sim_busy(s->top)) {
+        if (s->cycle - start >= timeout)
+            return -1;
+        sim_cycle(s);
+    }
+
+    uint64_t homes = s->homes + n;
+    while (s->homes < homes) {
+        if (s->cycle - start >= timeout)
+            return -1;
+        sim_cycle(s);
+    }
+
+    return s->cycle - start;
+}
+
+int64_t sim_wait_idle(sim_t *s, uint64_t timeout) {
+    return wait_homes(s, timeout, SETTLE_HOMES);
+}
+
+int64_t sim_wait_ready(sim_t *s, uint64_t timeout) {
+    return wait_homes(s, timeout, 1);
+}
+
+int sim_press(sim_t *s, int c) {
+    if (!key_press(s->top, c))
+        return 0;
+    s->keys++;
+    if (metrics_on)
+        metrics_key();
+
+    s->press_ack = 0;
+    if (s->keyhold == KEYHOLD_ADAPTIVE) {
+        // let go shortly after the keyboard counter acks the key
+        uint64_t i;
+        for (i = 0; i < KEY_DELAY && !s->top->kbd_ack; i++)
+            sim_cycle(s);
+        if (s->top->kbd_ack)
+            s->press_ack = i;
+        for (uint64_t j = 0; j < KEY_MIN_HOLD && i < KEY_DELAY; i++, j++)
+            sim_cycle(s);
+        key_release_all(s->top);
+        s->press_release = i;
+        for (i = 0; i < KEY_MIN_GAP; i++)
+            sim_cycle(s);
+        return 1;
+    }
+
+    for (uint64_t i = 0; i < KEY_DELAY; i++) {
+        if (!s->press_ack && s->top->kbd_ack)
+            s->press_ack = i;
+        sim_cycle(s);
+    }
+
+    key_release_all(s->top);
+    s->press_release = KEY_DELAY;
+    return 1;
+}
+
+int sim_keyhold_arg(int def) {
+    const char *mode = sim_plusarg("keyhold");
+    if (!mode)
+        return def;
+    if (!strcmp(mode, "fixed"))
+        return KEYHOLD_FIXED;
+    if (!strcmp(mode, "adaptive"))
+        return KEYHOLD_ADAPTIVE;
+    fprintf(stderr, "unknown +keyhold+%s, using %s\n", mode,
+            def == KEYHOLD_ADAPTIVE ? "adaptive" : "fixed");
+    return def;
+}
+
+const char *sim_plusarg(const char *name) {
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "+%s+", name);
+
+    // match "name+", so +shm+ isn't taken for the +shm_interval+ before it
+    const char *arg = Verilated::commandArgsPlusMatch(prefix + 1);
+    if (!arg || strncmp(arg, prefix, strlen(prefix)))
+        return NULL;
+    return arg + strlen(prefix);
+}
+
+int sim_plusflag(const char *name) {
+    const char *arg = Verilated::commandArgsPlusMatch(name);
+    return arg && arg[0] == '+' && !strncmp(arg + 1, name, strlen(name));
+}
+
+uint8_t *sim_reg(Vtop *top, int reg) {
+    switch (reg) {
+        case 0: return &top->reg_s[0];
+        case 1: return &top->reg_0[0];
+        case 2: return &top->reg_1[0];
+        case 3: return &top->reg_2[0];
+        case 4: return &top->reg_3[0];
+        default: return &top->reg_4[0];
+    }
+}
+
+// same layout as the interactive simulators
+static void print_reg(FILE *f, uint8_t *reg, int dp) {
+    for (int i = 15; i >= 2; i--) {
+        if (i < 15)
+            fprintf(f, "%x", reg[i]);
+        if (dp + 2 == i)
+            fprintf(f, ".");
+    }
+    if (reg[1])
+        fprintf(f, "-");
+    else
+        fprintf(f, " ");
+    fprintf(f, "\n");
+}
+
+void sim_print_regs(FILE *f, Vtop *top) {
+    for (int r = 5; r >= 0; r--)
+        print_reg(f, sim_reg(top, r), top->sw_dp);
+}
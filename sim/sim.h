@@ -0,0 +1,102 @@
+// Friden simulator host-side helpers
+// shared by all of the simulators, compiled against each one's Vtop
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "Vtop.h"
+
+class VerilatedVcdC;
+struct engine_t;
+
+// cycles a key is held down for
+#define KEY_DELAY 50000UL
+
+// with adaptive key holds, keys are released this many cycles after
+// kbd_ack instead, which gives the AC gates the acknowledge charges
+// time to fire; keys that never get an ack are still held KEY_DELAY
+#define KEY_MIN_HOLD 16
+
+// cycles between releasing a key and pressing the next, so the key's
+// AC gates discharge and its edge detectors see it go
+#define KEY_MIN_GAP 64
+
+// how keys are held
+enum {
+    KEYHOLD_FIXED, // KEY_DELAY cycles, like the interactive simulators
+    KEYHOLD_ADAPTIVE // until kbd_ack plus KEY_MIN_HOLD
+};
+
+// once the machine is idle, wait for this many HOME pulses (delay line
+// recirculations) so the decoded register outputs have caught up
+#define SETTLE_HOMES 2
+
+// master clock cycles for the delay line to go round once (1800 bits,
+// one every 8 clocks); START holds HOME off from CLEAR ALL until the
+// next key, so meanwhile a recirculation is counted every this many
+#define WORD_CYCLES 14400
+
+// give up waiting on an operation after this many cycles
+#define OP_TIMEOUT 200000000UL
+
+struct sim_t {
+    Vtop *top;
+    VerilatedVcdC *tfp; // optional trace file
+    engine_t *engine; // functional engine to run instead of the model
+    uint64_t cycle; // master clock cycles simulated
+    uint64_t homes; // HOME rising edges seen (see WORD_CYCLES)
+    int home_prev;
+    uint64_t home_at; // cycle of the last one
+    int keyhold; // KEYHOLD_FIXED or KEYHOLD_ADAPTIVE
+    uint64_t keys; // keys pressed
+    int ack_prev; // kbd_ack on the cycle before
+    uint64_t press_ack; // cycles from the last key's press to kbd_ack, or 0
+    uint64_t press_release; // cycles from the last key's press to its release
+
+    // if set, called once the cycle count reaches hook_cycle, e.g. to
+    // inject a fault; it may set itself up again for a later cycle
+    void (*hook)(sim_t *s);
+    uint64_t hook_cycle;
+};
+
+void sim_init(sim_t *s, Vtop *top);
+
+// advances the model by one master clock cycle
+void sim_cycle(sim_t *s);
+
+// true while the machine is doing something with a key or an operation
+int sim_busy(Vtop *top);
+
+// runs until the machine is idle and the register outputs have settled
+// returns the number of cycles taken, or -1 on timeout
+int64_t sim_wait_idle(sim_t *s, uint64_t timeout);
+
+// runs until the machine is idle and back at a HOME pulse, which is
+// soon enough to press the next key, if not to read the registers
+// returns the number of cycles taken, or -1 on timeout
+int64_t sim_wait_ready(sim_t *s, uint64_t timeout);
+
+// presses key c and holds it as set by s->keyhold, then releases it
+// returns 0 if c is not a calculator key
+int sim_press(sim_t *s, int c);
+
+// key hold mode from +keyhold+fixed or +keyhold+adaptive, or def if
+// not given
+int sim_keyhold_arg(int def);
+
+// value of a +name+value plusarg, or NULL if it wasn't given
+const char *sim_plusarg(const char *name);
+
+// true if +name was given on the command line
+int sim_plusflag(const char *name);
+
+// decoded output of register reg: the S register for 0, then registers
+// 0 to 4 for 1 to 5 (as DL_REG_S to DL_REG_4 in dl.h)
+uint8_t *sim_reg(Vtop *top, int reg);
+
+// prints the decoded working registers, top to bottom
+void sim_print_regs(FILE *f, Vtop *top);
+
+#endif
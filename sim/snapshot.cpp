@@ -0,0 +1,100 @@
+// Friden simulator state snapshots
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <verilated.h>
+#include "verilated_save.h"
+#include "Vtop.h"
+#include "sim.h"
+#include "snapshot.h"
+
+int snapshot_save(Vtop *top, const char *filename) {
+    VerilatedSave os;
+    os.open(filename);
+    if (!os.isOpen())
+        return -1;
+    os << *top;
+    os.close();
+    return 0;
+}
+
+int snapshot_restore(Vtop *top, const char *filename) {
+    // VerilatedRestore gives up with a fatal error on a missing file
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return -1;
+    fclose(f);
+
+    VerilatedRestore os;
+    os.open(filename);
+    if (!os.isOpen())
+        return -1;
+    os >> *top;
+    os.close();
+    return 0;
+}
+
+// made on first use, and removed at exit (by the process that made
+// it, not by forked children, which make their own)
+static std::string scratch;
+static pid_t scratch_owner;
+
+static void scratch_remove() {
+    if (getpid() == scratch_owner)
+        unlink(scratch.c_str());
+}
+
+void snapshot_scratch_remove() {
+    scratch_remove();
+}
+
+static const char *scratch_file() {
+    if (scratch.empty() || getpid() != scratch_owner) {
+        const char *dir = getenv("TMPDIR");
+        std::string name = std::string(dir && *dir ? dir : "/tmp") + "/friden-XXXXXX";
+        int fd = mkstemp(&name[0]);
+        if (fd < 0)
+            return NULL;
+        close(fd);
+        scratch = name;
+        scratch_owner = getpid();
+        atexit(scratch_remove);
+    }
+    return scratch.c_str();
+}
+
+int snapshot_save_mem(Vtop *top, std::string &state) {
+    const char *filename = scratch_file();
+    if (!filename || snapshot_save(top, filename))
+        return -1;
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return -1;
+    fseek(f, 0, SEEK_END);
+    state.resize(ftell(f));
+    rewind(f);
+    size_t n = fread(&state[0], 1, state.size(), f);
+    fclose(f);
+    return n == state.size() ? 0 : -1;
+}
+
+int snapshot_restore_mem(Vtop *top, const std::string &state) {
+    const char *filename = scratch_file();
+    if (!filename)
+        return -1;
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return -1;
+    size_t n = fwrite(state.data(), 1, state.size(), f);
+    if (fclose(f) || n != state.size())
+        return -1;
+    return snapshot_restore(top, filename);
+}
+
+int snapshot_poweron(Vtop *top) {
+    const char *filename = sim_plusarg("poweron");
+    if (!filename || !*filename)
+        return 0;
+    return snapshot_restore(top, filename);
+}
@@ -0,0 +1,33 @@
+// Friden simulator state snapshots
+// needs a model verilated with --savable
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+
+class Vtop;
+
+// writes the complete model state to a file
+// returns -1 if the file can't be written
+int snapshot_save(Vtop *top, const char *filename);
+
+// reads back a state written by snapshot_save, from the same build
+// returns -1 if the file can't be read
+int snapshot_restore(Vtop *top, const char *filename);
+
+// the same, to and from memory (by way of a scratch file, as Verilator
+// only saves to files); returns -1 if the scratch file can't be used
+int snapshot_save_mem(Vtop *top, std::string &state);
+int snapshot_restore_mem(Vtop *top, const std::string &state);
+
+// a forked child gets a scratch file of its own, and removes it with
+// this before it _exit()s
+void snapshot_scratch_remove();
+
+// restores the power-on image given with +poweron+<file>, if any, so
+// the machine starts out cleared and idle instead of in random state
+// returns -1 if one was given but can't be read
+int snapshot_poweron(Vtop *top);
+
+#endif
@@ -0,0 +1,45 @@
+// Friden simulator single producer, single consumer ring
+// a fixed size queue between the simulation thread and one helper
+// thread (e.g. a file writer), without locks: the producer only moves
+// tail and the consumer only moves head, each publishing its items
+// (or free slots) to the other with a release store
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <atomic>
+
+// N must be a power of two
+template <typename T, size_t N> struct spsc_ring {
+    static_assert(N && !(N & (N - 1)), "spsc_ring size must be a power of two");
+
+    // on lines of their own, so the two threads don't share one
+    alignas(64) std::atomic<size_t> head{0}; // next item to pop
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to push to
+    alignas(64) T items[N];
+
+    // producer: returns false (and drops v) if the ring is full
+    bool push(const T &v) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+            return false;
+        items[t & (N - 1)] = v;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer: pops up to max items into out, returning how many
+    size_t pop(T *out, size_t max) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t n = tail.load(std::memory_order_acquire) - h;
+        if (n > max)
+            n = max;
+        for (size_t i = 0; i < n; i++)
+            out[i] = items[(h + i) & (N - 1)];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+};
+
+#endif
@@ -0,0 +1,219 @@
+// Friden simulator trace writer
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <verilated.h>
+#include "verilated_vcd_c.h"
+#include "Vtop.h"
+#include "sim.h"
+#include "spsc_ring.h"
+#include "trace_writer.h"
+
+#if VM_TRACE
+
+struct trace_block_t {
+    size_t len;
+    char data[TRACE_BLOCK];
+};
+
+// the VCD as Verilator writes it, queued for the writer thread
+class trace_file : public VerilatedVcdFile {
+public:
+    bool open(const std::string &name) override;
+    void close() override;
+    ssize_t write(const char *bufp, ssize_t len) override;
+
+    // blocks waiting for the writer
+    size_t queued() const {
+        return ring.tail.load(std::memory_order_relaxed) - ring.head.load(std::memory_order_relaxed);
+    }
+
+    int drop = 0; // set by +trace_queue+drop
+    uint64_t stalls = 0; // times the simulation waited for the writer
+    uint64_t dropped = 0; // dumps skipped with +trace_queue+drop
+    int dropping = 0;
+    uint64_t drop_from, drop_to; // the dumps being skipped
+
+    // marks the dumps skipped, in the VCD
+    void mark();
+
+private:
+    void put(trace_block_t *b);
+    void run();
+
+    FILE *out = nullptr;
+    int piped = 0;
+    std::string name;
+    trace_block_t *cur = nullptr;
+    spsc_ring<trace_block_t *, TRACE_QUEUE> ring;
+    std::thread writer;
+    std::atomic<int> done{0};
+    uint64_t written = 0;
+    int failed = 0;
+};
+
+bool trace_file::open(const std::string &filename) {
+    name = filename;
+    // compressed by a process of its own, so on another CPU
+    const char *compress = NULL;
+    if (name.size() > 4 && !name.compare(name.size() - 4, 4, ".zst"))
+        compress = "zstd -q -f -o";
+    else if (name.size() > 3 && !name.compare(name.size() - 3, 3, ".gz"))
+        compress = "gzip -c >";
+    if (compress) {
+        if (name.find('\'') != std::string::npos)
+            return false;
+        // if the compressor dies, the writes fail rather than killing us
+        signal(SIGPIPE, SIG_IGN);
+        std::string cmd = std::string(compress) + " '" + name + "'";
+        out = popen(cmd.c_str(), "w");
+        piped = 1;
+    }
+    else
+        out = fopen(name.c_str(), "wb");
+    if (!out) {
+        perror(name.c_str());
+        return false;
+    }
+    cur = new trace_block_t;
+    cur->len = 0;
+    done = 0;
+    writer = std::thread(&trace_file::run, this);
+    return true;
+}
+
+void trace_file::run() {
+    for (;;) {
+        // checked before popping, so nothing queued before the close is lost
+        int stop = done.load(std::memory_order_acquire);
+        trace_block_t *b;
+        if (ring.pop(&b, 1)) {
+            if (!failed && fwrite(b->data, 1, b->len, out) != b->len) {
+                perror(name.c_str());
+                failed = 1;
+            }
+            written += b->len;
+            delete b;
+            continue;
+        }
+        if (stop)
+            break;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+void trace_file::put(trace_block_t *b) {
+    // with +trace_queue+drop, trace_dump() stops dumping well before
+    // this, but the text already formatted has to go out whole
+    while (!ring.push(b)) {
+        stalls++;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+ssize_t trace_file::write(const char *bufp, ssize_t len) {
+    ssize_t left = len;
+    while (left > 0) {
+        size_t n = std::min((size_t)left, TRACE_BLOCK - cur->len);
+        memcpy(cur->data + cur->len, bufp, n);
+        cur->len += n;
+        bufp += n;
+        left -= n;
+        if (cur->len == TRACE_BLOCK) {
+            put(cur);
+            cur = new trace_block_t;
+            cur->len = 0;
+        }
+    }
+    return len;
+}
+
+void trace_file::mark() {
+    char marker[128];
+    int n = snprintf(marker, sizeof(marker), "$comment dropped #%lu to #%lu $end\n",
+                     drop_from, drop_to);
+    write(marker, n);
+    dropping = 0;
+}
+
+void trace_file::close() {
+    if (!out)
+        return;
+    // Verilator has flushed its buffer by now
+    if (dropping)
+        mark();
+    if (cur->len)
+        put(cur);
+    else
+        delete cur;
+    cur = nullptr;
+    done.store(1, std::memory_order_release);
+    writer.join();
+    int status = piped ? pclose(out) : fclose(out);
+    if (status && !failed)
+        fprintf(stderr, "%s: %s\n", name.c_str(), piped ? "compressor failed" : strerror(errno));
+    out = nullptr;
+    fprintf(stderr, "trace: %.1f MB to %s, waited on the writer %lu times, %lu dumps dropped\n",
+            written / 1e6, name.c_str(), stalls, dropped);
+}
+
+static trace_file *file;
+static VerilatedVcdC *file_tfp;
+
+VerilatedVcdC *trace_open(Vtop *top, const char *filename) {
+    const char *arg = sim_plusarg("trace_file");
+    const char *queue = sim_plusarg("trace_queue");
+    file = new trace_file;
+    if (queue && !strcmp(queue, "drop"))
+        file->drop = 1;
+    else if (queue && strcmp(queue, "block"))
+        fprintf(stderr, "unknown +trace_queue+%s, waiting for the writer\n", queue);
+    file_tfp = new VerilatedVcdC(file);
+    top->trace(file_tfp, 99);
+    file_tfp->open(arg && *arg ? arg : filename);
+    return file_tfp;
+}
+
+void trace_dump(VerilatedVcdC *tfp, uint64_t time) {
+    if (tfp != file_tfp || !file->drop) {
+        tfp->dump(time);
+        return;
+    }
+
+    size_t queued = file->queued();
+    if (file->dropping) {
+        if (queued > TRACE_RESUME) {
+            file->drop_to = time;
+            file->dropped++;
+            return;
+        }
+        // Verilator's own buffer goes out before the marker
+        tfp->flush();
+        file->mark();
+    }
+    else if (queued >= TRACE_HIGH) {
+        file->dropping = 1;
+        file->drop_from = file->drop_to = time;
+        file->dropped++;
+        return;
+    }
+    tfp->dump(time);
+}
+
+#else
+
+VerilatedVcdC *trace_open(Vtop *, const char *) {
+    return nullptr;
+}
+
+void trace_dump(VerilatedVcdC *, uint64_t) {
+}
+
+#endif
@@ -0,0 +1,40 @@
+// Friden simulator trace writer
+// Verilator formats the VCD on the simulation thread; this takes the
+// rest of the work off it: the formatted text is handed over in blocks,
+// through a bounded queue, to a writer thread that writes it out,
+// compressed if the file name asks for it (.zst or .gz, through zstd or
+// gzip running alongside), so a traced run only pays for the formatting
+//
+// when the writer falls behind and the queue fills, the simulation
+// either waits for it (+trace_queue+block, the default) or stops dumping
+// until it has caught up (+trace_queue+drop); the gap is marked with a
+// $comment in the VCD, and whatever changed meanwhile shows up at the
+// next dump
+
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include <stdint.h>
+
+class Vtop;
+class VerilatedVcdC;
+
+// bytes handed to the writer at a time
+#define TRACE_BLOCK (256 * 1024)
+
+// blocks queued for the writer, at most (a power of two)
+#define TRACE_QUEUE 64
+
+// with +trace_queue+drop, dumping stops once the queue has this many
+// blocks in it, and starts again once it's down to TRACE_RESUME
+#define TRACE_HIGH (TRACE_QUEUE - 4)
+#define TRACE_RESUME (TRACE_QUEUE / 4)
+
+// traces top to filename, or to +trace_file+<file> if given; closing
+// the VerilatedVcdC flushes the queue and stops the writer
+VerilatedVcdC *trace_open(Vtop *top, const char *filename);
+
+// dumps the trace at time, or not if it's being dropped
+void trace_dump(VerilatedVcdC *tfp, uint64_t time);
+
+#endif
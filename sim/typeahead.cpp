@@ -0,0 +1,160 @@
+// Friden simulator type-ahead
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Vtop.h"
+#include "sim.h"
+#include "keys.h"
+#include "metrics.h"
+#include "typeahead.h"
+
+enum {
+    TYPEAHEAD_WAIT, // for the machine to be ready for the next key
+    TYPEAHEAD_HOLD, // a key, until it's acked or KEY_DELAY is up
+    TYPEAHEAD_ACKED, // an acked key, for KEY_MIN_HOLD more
+    TYPEAHEAD_GAP // after letting go, for KEY_MIN_GAP
+};
+
+void typeahead_init(typeahead_t *q) {
+    q->head = 0;
+    q->tail = 0;
+    q->last = 0;
+    q->state = TYPEAHEAD_WAIT;
+    q->mark = 0;
+    q->homes = 0;
+    q->fd = -1;
+    q->read_homes = 0;
+    q->dropped = 0;
+}
+
+unsigned typeahead_pending(typeahead_t *q) {
+    return q->tail - q->head;
+}
+
+int typeahead_idle(typeahead_t *q) {
+    return q->state == TYPEAHEAD_WAIT && !typeahead_pending(q);
+}
+
+int typeahead_put(typeahead_t *q, int c) {
+    if (!key_name(c))
+        return 0;
+    if (typeahead_pending(q) == TYPEAHEAD_SIZE) {
+        q->dropped++;
+        return -1;
+    }
+    q->keys[q->tail++ % TYPEAHEAD_SIZE] = c;
+    return 1;
+}
+
+static void press(typeahead_t *q, sim_t *s, int c) {
+    key_press(s->top, c);
+    s->keys++;
+    if (metrics_on)
+        metrics_key();
+    q->state = TYPEAHEAD_HOLD;
+    q->mark = s->cycle;
+}
+
+int typeahead_now(typeahead_t *q, sim_t *s, int c) {
+    if (!key_name(c))
+        return 0;
+    q->head = q->tail;
+    key_release_all(s->top);
+    press(q, s, c);
+    return 1;
+}
+
+int typeahead_open(typeahead_t *q, const char *filename) {
+    if (!filename)
+        return 0;
+    int fd = strcmp(filename, "-") ? open(filename, O_RDONLY) : dup(0);
+    if (fd < 0) {
+        perror(filename);
+        return -1;
+    }
+    // stdin may be a terminal or a pipe, which mustn't hold up the model
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    q->fd = fd;
+    return 0;
+}
+
+// tops the queue up from the file; only once per HOME pulse, as the
+// keys don't go any faster than that
+static void refill(typeahead_t *q, sim_t *s) {
+    if (s->homes == q->read_homes)
+        return;
+    q->read_homes = s->homes;
+
+    char buf[TYPEAHEAD_SIZE];
+    unsigned room = TYPEAHEAD_SIZE - typeahead_pending(q);
+    ssize_t n = read(q->fd, buf, room);
+    if (n == 0) {
+        close(q->fd);
+        q->fd = -1;
+        return;
+    }
+    // anything that isn't a key, such as spaces, is skipped
+    for (ssize_t i = 0; i < n; i++)
+        typeahead_put(q, (unsigned char)buf[i]);
+}
+
+static void let_go(typeahead_t *q, sim_t *s) {
+    key_release_all(s->top);
+    q->mark = s->cycle;
+    if (s->keyhold == KEYHOLD_ADAPTIVE) {
+        q->state = TYPEAHEAD_GAP;
+    }
+    else {
+        q->state = TYPEAHEAD_WAIT;
+        q->homes = s->homes + 1;
+    }
+}
+
+int typeahead_cycle(typeahead_t *q, sim_t *s) {
+    Vtop *top = s->top;
+    uint64_t held = s->cycle - q->mark;
+
+    switch (q->state) {
+        case TYPEAHEAD_HOLD:
+            // with adaptive holds, let go shortly after the ack
+            if (s->keyhold == KEYHOLD_ADAPTIVE && top->kbd_ack && held < KEY_DELAY) {
+                q->state = TYPEAHEAD_ACKED;
+                q->mark = s->cycle;
+                return 0;
+            }
+            if (held < KEY_DELAY)
+                return 0;
+            let_go(q, s);
+            return -1;
+        case TYPEAHEAD_ACKED:
+            if (held < KEY_MIN_HOLD)
+                return 0;
+            let_go(q, s);
+            return -1;
+        case TYPEAHEAD_GAP:
+            if (held < KEY_MIN_GAP)
+                return 0;
+            q->state = TYPEAHEAD_WAIT;
+            q->homes = s->homes + 1;
+            return 0;
+    }
+
+    if (q->fd >= 0 && typeahead_pending(q) < TYPEAHEAD_SIZE)
+        refill(q, s);
+    if (!typeahead_pending(q))
+        return 0;
+    // as sim_wait_ready(): idle, then a HOME pulse
+    if (sim_busy(top)) {
+        q->homes = s->homes + 1;
+        return 0;
+    }
+    if (s->homes < q->homes)
+        return 0;
+
+    q->last = q->head;
+    int c = q->keys[q->head++ % TYPEAHEAD_SIZE];
+    press(q, s, c);
+    return c;
+}
@@ -0,0 +1,69 @@
+// Friden simulator type-ahead
+// keys for the interactive simulators: a key typed is first checked
+// with TYPEAHEAD_NOW, and CLEAR ALL and OVERFLOW LOCK are pressed at
+// once, dropping whatever is queued (typeahead_now()); every other key
+// goes into a bounded queue (typeahead_put()), so keys typed or pasted
+// faster than the calculator takes them wait their turn, and each is
+// pressed once the machine is ready for it (as batch mode waits: not
+// busy, kbd_lock clear, and a HOME pulse since), held as set by
+// s->keyhold, and let go before the next one, so none are lost
+//
+// keys can also be read from a file with +typein+<file> ("-" for
+// stdin), as fast as the queue takes them; those are all queued, CLEAR
+// ALL included, as they're meant to be pressed in order
+
+#ifndef TYPEAHEAD_H
+#define TYPEAHEAD_H
+
+#include <stdint.h>
+#include "sim.h"
+
+// keys the queue holds; more are refused until it has room
+#define TYPEAHEAD_SIZE 256
+
+// keys typed that are pressed at once rather than queued: CLEAR ALL and
+// OVERFLOW LOCK, which the machine takes even while locked, as a way out
+// of a long paste
+#define TYPEAHEAD_NOW(c) ((c) == 'c' || (c) == 'o')
+
+struct typeahead_t {
+    // keys are numbered in the order they're queued, by head and tail,
+    // so a key can be told from an earlier one of the same character
+    int keys[TYPEAHEAD_SIZE];
+    unsigned head; // next key to press
+    unsigned tail; // where the next key queued goes
+    unsigned last; // number of the key typeahead_cycle() last pressed
+    int state;
+    uint64_t mark; // cycle the key was pressed, acked or let go
+    uint64_t homes; // HOME pulse count to wait for before the next key
+    int fd; // source of keys, or -1
+    uint64_t read_homes; // HOME pulse count it was last read at
+    uint64_t dropped; // keys refused as the queue was full
+};
+
+void typeahead_init(typeahead_t *q);
+
+// queues key c (as in keys.h), as number q->tail - 1; returns 1 if it
+// was queued, 0 if c isn't a calculator key, or -1 if the queue is full
+int typeahead_put(typeahead_t *q, int c);
+
+// drops the queued keys, lets go of any key held, and presses c
+// straight away; returns 0 if c isn't a calculator key
+int typeahead_now(typeahead_t *q, sim_t *s, int c);
+
+// reads keys from filename ("-" for stdin) as the queue has room, from
+// +typein+<file>; does nothing if filename is NULL
+// returns -1 if the file can't be opened
+int typeahead_open(typeahead_t *q, const char *filename);
+
+// keys queued and not yet pressed
+unsigned typeahead_pending(typeahead_t *q);
+
+// true if no keys are queued and none is being held or let go
+int typeahead_idle(typeahead_t *q);
+
+// called after every sim_cycle(); presses and lets go of keys
+// returns the key pressed on this cycle, -1 if one was let go, or 0
+int typeahead_cycle(typeahead_t *q, sim_t *s);
+
+#endif
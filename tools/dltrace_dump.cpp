@@ -0,0 +1,251 @@
+// Friden simulator delay line trace dump
+//
+// lists a trace written with +dltrace+<file> (see sim/dltrace_format.h):
+// a line per recirculation whose registers changed, with registers 1 to
+// 4 and the storage register, and a line per change of the control
+// flip-flops, lamps, phase, keys or DP switch
+//
+// -w <from>:<to> only lists that window of cycles; -v <file> writes the
+// same as a VCD instead, a timestep per cycle, with each register as a
+// 64 bit vector (digit 15 in the top nibble), for any waveform viewer
+//
+// usage: dltrace_dump [-w from:to] [-v out.vcd] <trace>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "dltrace_format.h"
+
+static const char *reg_names[DLT_REGS_N] = {"reg_s", "reg_0", "reg_1", "reg_2", "reg_3", "reg_4"};
+
+// same layout as shm_tail, most significant digit first
+static void print_reg(const uint8_t *reg, int dp) {
+    for (int i = 14; i >= 2; i--) {
+        printf("%x", reg[i]);
+        if (dp + 2 == i)
+            printf(".");
+    }
+    printf("%c ", reg[1] ? '-' : ' ');
+}
+
+static void print_control(uint64_t control) {
+    printf("ph=%x ", (int)(control >> DLT_CTL_PHASE_SHIFT) & 0xf);
+    if (control & DLT_CTL_OVERFLOW)
+        printf("OVERFLOW ");
+    if (control & DLT_CTL_KBD_LOCK)
+        printf("lock ");
+    if (control & DLT_CTL_KBD_ACK)
+        printf("ack ");
+    for (int i = 0; i < SHM_FFS; i++)
+        if (control & (1ull << i))
+            printf("%s ", shm_ff_names[i]);
+}
+
+static void print_record(const dlt_record_t *r) {
+    printf("%12lu ", r->cycle);
+    switch (r->tag) {
+        case DLT_REGS:
+            for (int i = 5; i >= 2; i--)
+                print_reg(r->regs[i], r->sw_dp);
+            printf("s=");
+            print_reg(r->regs[0], r->sw_dp);
+            break;
+        case DLT_CONTROL:
+            print_control(r->control);
+            break;
+        case DLT_INPUTS:
+            if (r->key >= ' ' && r->key < 0x7f)
+                printf("key '%c' ", r->key);
+            else if (r->key)
+                printf("key 0x%02x ", r->key);
+            else
+                printf("no key ");
+            printf("dp=%d ", r->sw_dp);
+            break;
+        case DLT_KEYFRAME:
+            printf("keyframe %s ", r->keyframe);
+            break;
+        case DLT_LOAD:
+            printf("load %s ", r->keyframe);
+            break;
+    }
+    printf("\n");
+}
+
+// VCD identifiers: the registers, the flip-flops, then the rest
+enum {
+    VCD_REGS = 0,
+    VCD_FFS = VCD_REGS + DLT_REGS_N,
+    VCD_KBD_LOCK = VCD_FFS + SHM_FFS,
+    VCD_KBD_ACK,
+    VCD_OVERFLOW,
+    VCD_PHASE,
+    VCD_KEY,
+    VCD_SW_DP,
+    VCD_SIGNALS
+};
+
+static void vcd_id(char *id, int n) {
+    id[0] = '!' + n % 94;
+    id[1] = n >= 94 ? '!' + n / 94 : '\0';
+    id[2] = '\0';
+}
+
+static void vcd_vector(FILE *f, uint64_t v, int bits, int n) {
+    char id[3];
+    vcd_id(id, n);
+    putc('b', f);
+    for (int i = bits - 1; i >= 0; i--)
+        putc(v >> i & 1 ? '1' : '0', f);
+    fprintf(f, " %s\n", id);
+}
+
+static void vcd_bit(FILE *f, int v, int n) {
+    char id[3];
+    vcd_id(id, n);
+    fprintf(f, "%d%s\n", v ? 1 : 0, id);
+}
+
+static void vcd_header(FILE *f, const dlt_header_t *h) {
+    char id[3];
+    fprintf(f, "$comment %s delay line trace, a timestep per cycle $end\n", h->model);
+    fprintf(f, "$timescale 1ns $end\n");
+    fprintf(f, "$scope module %s $end\n", h->model);
+    for (int i = 0; i < DLT_REGS_N; i++) {
+        vcd_id(id, VCD_REGS + i);
+        fprintf(f, "$var wire 64 %s %s [63:0] $end\n", id, reg_names[i]);
+    }
+    for (int i = 0; i < SHM_FFS; i++) {
+        if (!(h->ffs_present & (1u << i)))
+            continue;
+        vcd_id(id, VCD_FFS + i);
+        fprintf(f, "$var wire 1 %s %s $end\n", id, shm_ff_names[i]);
+    }
+    static const struct { int n, bits; const char *name; } rest[] = {
+        {VCD_KBD_LOCK, 1, "kbd_lock"}, {VCD_KBD_ACK, 1, "kbd_ack"},
+        {VCD_OVERFLOW, 1, "lamp_overflow"}, {VCD_PHASE, 4, "phase"},
+        {VCD_KEY, 8, "key"}, {VCD_SW_DP, 8, "sw_dp"}
+    };
+    for (auto &r : rest) {
+        vcd_id(id, r.n);
+        if (r.bits == 1)
+            fprintf(f, "$var wire 1 %s %s $end\n", id, r.name);
+        else
+            fprintf(f, "$var wire %d %s %s [%d:0] $end\n", r.bits, id, r.name, r.bits - 1);
+    }
+    fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+}
+
+static uint64_t reg_value(const uint8_t *reg) {
+    uint64_t v = 0;
+    for (int d = 15; d >= 0; d--)
+        v = v << 4 | (reg[d] & 0xf);
+    return v;
+}
+
+// writes the signals that record r changes, or all of them
+static void vcd_record(FILE *f, const dlt_header_t *h, const dlt_record_t *r, int all) {
+    if (all || r->tag == DLT_REGS)
+        for (int i = 0; i < DLT_REGS_N; i++)
+            if (all || r->mask & (1 << i))
+                vcd_vector(f, reg_value(r->regs[i]), 64, VCD_REGS + i);
+    if (all || r->tag == DLT_CONTROL) {
+        // VCD readers only keep changes, so all of the word is written
+        for (int i = 0; i < SHM_FFS; i++)
+            if (h->ffs_present & (1u << i))
+                vcd_bit(f, r->control & (1ull << i), VCD_FFS + i);
+        vcd_bit(f, r->control & DLT_CTL_KBD_LOCK, VCD_KBD_LOCK);
+        vcd_bit(f, r->control & DLT_CTL_KBD_ACK, VCD_KBD_ACK);
+        vcd_bit(f, r->control & DLT_CTL_OVERFLOW, VCD_OVERFLOW);
+        vcd_vector(f, r->control >> DLT_CTL_PHASE_SHIFT & 0xf, 4, VCD_PHASE);
+    }
+    if (all || r->tag == DLT_INPUTS) {
+        vcd_vector(f, r->key, 8, VCD_KEY);
+        vcd_vector(f, r->sw_dp, 8, VCD_SW_DP);
+    }
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-w from:to] [-v out.vcd] <trace>\n", name);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    uint64_t from = 0, to = UINT64_MAX;
+    const char *vcd_name = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:v:")) != -1) {
+        switch (opt) {
+            case 'w':
+                if (sscanf(optarg, "%lu:%lu", &from, &to) < 1)
+                    usage(argv[0]);
+                break;
+            case 'v': vcd_name = optarg; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1)
+        usage(argv[0]);
+
+    FILE *f = fopen(argv[optind], "rb");
+    if (!f) {
+        perror(argv[optind]);
+        return 1;
+    }
+    dlt_header_t h;
+    if (dlt_read_header(f, &h)) {
+        fprintf(stderr, "%s isn't a delay line trace of this version\n", argv[optind]);
+        return 1;
+    }
+
+    FILE *vcd = NULL;
+    if (vcd_name) {
+        vcd = fopen(vcd_name, "w");
+        if (!vcd) {
+            perror(vcd_name);
+            return 1;
+        }
+        vcd_header(vcd, &h);
+    }
+    else
+        printf("%s, from cycle %lu\n", h.model, h.start);
+
+    dlt_record_t r;
+    memset(&r, 0, sizeof(r));
+    r.cycle = h.start;
+    uint64_t time = UINT64_MAX;
+    int status, started = 0;
+    long records = 0;
+    while (!(status = dlt_read_record(f, &r))) {
+        if (r.cycle < from)
+            continue;
+        if (r.cycle >= to)
+            break;
+        records++;
+        if (!vcd) {
+            print_record(&r);
+            continue;
+        }
+        if (r.cycle != time) {
+            time = r.cycle;
+            fprintf(vcd, "#%lu\n", time);
+        }
+        // the state carried in from before the window comes first
+        vcd_record(vcd, &h, &r, !started);
+        started = 1;
+    }
+    fclose(f);
+
+    if (vcd) {
+        fclose(vcd);
+        printf("%ld records to %s\n", records, vcd_name);
+    }
+    if (status < 0) {
+        fprintf(stderr, "%s is cut short at cycle %lu\n", argv[optind], r.cycle);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,321 @@
+// Friden simulator ac/ff bank packer
+//
+// rewrites a module (a simulator's top.v, or one of the cards in
+// modules/ it instantiates) so that every ac and ff instance becomes
+// one lane of a single ac_bank or ff_bank (modules/ac_bank.v, ff_bank.v)
+// instead of a module instance of its own; the behaviour is unchanged,
+// but Verilator can then update all the RC counters and flip-flops with
+// a few wide operations per clock
+//
+// `ifdef blocks are resolved first, with the macros given by -D defined
+// and all others not, so the output is only good for a build with the
+// same defines; each instance is then replaced in place by assigns to
+// and from its lane, the lane vectors are declared after the port list
+// of the module, and the banks are instantiated just before endmodule
+//
+// usage: pack_banks [-D NAME]... top.v > obj_dir/packed/top.v
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+struct inst_t {
+    std::string type; // ac or ff
+    std::string name;
+    std::map<std::string, std::string> ports;
+    size_t first, last; // line range in the source
+    int lane;
+};
+
+static std::vector<std::string> lines;
+static std::vector<inst_t> insts;
+static std::set<std::string> defines;
+
+static std::string trim(const std::string &s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos)
+        return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+// "ac AC_1051 (" -> type and name
+static int parse_header(const std::string &line, std::string &type, std::string &name) {
+    std::string s = trim(line);
+    if (s.compare(0, 3, "ac ") && s.compare(0, 3, "ff "))
+        return 0;
+    if (s.empty() || s[s.size() - 1] != '(')
+        return 0;
+    type = s.substr(0, 2);
+    name = trim(s.substr(3, s.size() - 4));
+    for (char c : name)
+        if (!isalnum((unsigned char)c) && c != '_')
+            return 0;
+    return !name.empty();
+}
+
+// ".trans(EKBD3)," -> port and connection
+static int parse_port(const std::string &line, std::string &port, std::string &conn) {
+    std::string s = trim(line);
+    size_t comment = s.find("//");
+    if (comment != std::string::npos)
+        s = trim(s.substr(0, comment));
+    if (s.empty() || s[0] != '.')
+        return 0;
+    size_t open = s.find('(');
+    size_t close = s.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close < open)
+        return 0;
+    port = trim(s.substr(1, open - 1));
+    conn = trim(s.substr(open + 1, close - open - 1));
+    return 1;
+}
+
+static const char *ac_ports[] = {"clk", "en", "trans", "out", NULL};
+static const char *ff_ports[] = {"clk", "rst_l", "set_l", "tog_p", "rst_p", "set_p", "q", "q_n", NULL};
+
+static int check_ports(const inst_t &inst) {
+    const char **ports = inst.type == "ac" ? ac_ports : ff_ports;
+    for (int i = 0; ports[i]; i++) {
+        auto p = inst.ports.find(ports[i]);
+        if (p == inst.ports.end() || p->second.empty()) {
+            fprintf(stderr, "pack_banks: %s has no connection for .%s\n", inst.name.c_str(), ports[i]);
+            return -1;
+        }
+    }
+    if (inst.ports.size() != (size_t)(inst.type == "ac" ? 4 : 8)) {
+        fprintf(stderr, "pack_banks: %s has unexpected ports\n", inst.name.c_str());
+        return -1;
+    }
+    // every bank runs off the master clock
+    if (inst.ports.at("clk") != "clk") {
+        fprintf(stderr, "pack_banks: %s is not clocked by clk\n", inst.name.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+static void emit_inst(FILE *f, const inst_t &inst) {
+    char lane[32];
+    snprintf(lane, sizeof(lane), "[%d]", inst.lane);
+    auto &p = inst.ports;
+
+    if (inst.type == "ac") {
+        fprintf(f, "// %s: ac_bank lane %d\n", inst.name.c_str(), inst.lane);
+        fprintf(f, "assign _ac_en%s = %s;\n", lane, p.at("en").c_str());
+        fprintf(f, "assign _ac_trans%s = %s;\n", lane, p.at("trans").c_str());
+        fprintf(f, "assign %s = (%s) && _ac_charged%s;\n", p.at("out").c_str(), p.at("trans").c_str(), lane);
+    }
+    else {
+        fprintf(f, "// %s: ff_bank lane %d\n", inst.name.c_str(), inst.lane);
+        fprintf(f, "assign _ff_rst_l%s = %s;\n", lane, p.at("rst_l").c_str());
+        fprintf(f, "assign _ff_set_l%s = %s;\n", lane, p.at("set_l").c_str());
+        fprintf(f, "assign _ff_tog_p%s = %s;\n", lane, p.at("tog_p").c_str());
+        fprintf(f, "assign _ff_rst_p%s = %s;\n", lane, p.at("rst_p").c_str());
+        fprintf(f, "assign _ff_set_p%s = %s;\n", lane, p.at("set_p").c_str());
+        fprintf(f, "assign %s = _ff_q%s;\n", p.at("q").c_str(), lane);
+        fprintf(f, "assign %s = !_ff_q%s;\n", p.at("q_n").c_str(), lane);
+    }
+}
+
+// "`ifdef FOUR_COUNTERS" -> directive and macro
+static std::string directive(const std::string &line, std::string &macro) {
+    std::string s = trim(line);
+    macro.clear();
+    if (s.empty() || s[0] != '`')
+        return "";
+    size_t end = s.find_first_of(" \t");
+    std::string d = s.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+    if (end != std::string::npos) {
+        macro = trim(s.substr(end));
+        size_t comment = macro.find("//");
+        if (comment != std::string::npos)
+            macro = trim(macro.substr(0, comment));
+    }
+    return d;
+}
+
+// drops the `ifdef, `ifndef, `elsif, `else and `endif lines, and the
+// lines of the branches not taken; a `define is kept, and defines its
+// macro for the rest of the file
+static int resolve_ifdefs(const char *filename) {
+    struct cond_t {
+        int outer; // the lines around the block are kept
+        int taken; // a branch has been taken
+        int on; // the lines of this branch are kept
+    };
+    std::vector<cond_t> stack;
+    std::vector<std::string> out;
+    int on = 1;
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::string macro;
+        std::string d = directive(lines[i], macro);
+        int defined = defines.count(macro) > 0;
+        if (d == "ifdef" || d == "ifndef") {
+            int cond = d == "ifdef" ? defined : !defined;
+            stack.push_back({on, cond, cond});
+            on = on && cond;
+        }
+        else if (d == "elsif" || d == "else") {
+            if (stack.empty()) {
+                fprintf(stderr, "pack_banks: %s:%zu: `%s without `ifdef\n", filename, i + 1, d.c_str());
+                return -1;
+            }
+            cond_t &c = stack.back();
+            c.on = !c.taken && (d == "else" || defined);
+            c.taken = c.taken || c.on;
+            on = c.outer && c.on;
+        }
+        else if (d == "endif") {
+            if (stack.empty()) {
+                fprintf(stderr, "pack_banks: %s:%zu: `endif without `ifdef\n", filename, i + 1);
+                return -1;
+            }
+            on = stack.back().outer;
+            stack.pop_back();
+        }
+        else if (on) {
+            // a macro defined in the file counts from there on
+            if (d == "define")
+                defines.insert(macro.substr(0, macro.find_first_of(" \t")));
+            out.push_back(lines[i]);
+        }
+    }
+    if (!stack.empty()) {
+        fprintf(stderr, "pack_banks: %s: `ifdef without `endif\n", filename);
+        return -1;
+    }
+    lines = out;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "D:")) != -1) {
+        if (opt == 'D')
+            defines.insert(optarg);
+        else
+            break;
+    }
+    if (opt != -1 || optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-D NAME]... top.v > packed/top.v\n", argv[0]);
+        return 1;
+    }
+    const char *filename = argv[optind];
+
+    FILE *in = fopen(filename, "r");
+    if (!in) {
+        perror(filename);
+        return 1;
+    }
+    char buf[4096];
+    while (fgets(buf, sizeof(buf), in)) {
+        std::string s = buf;
+        if (!s.empty() && s[s.size() - 1] == '\n')
+            s.erase(s.size() - 1);
+        lines.push_back(s);
+    }
+    fclose(in);
+    if (resolve_ifdefs(filename))
+        return 1;
+
+    // find the end of the port list and of the module
+    size_t header_end = 0, module_end = 0;
+    int in_module = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::string s = trim(lines[i]);
+        if (!in_module && s.compare(0, 7, "module ") == 0)
+            in_module = 1;
+        else if (in_module == 1 && s == ");") {
+            header_end = i;
+            in_module = 2;
+        }
+        else if (in_module == 2 && s.compare(0, 9, "endmodule") == 0) {
+            module_end = i;
+            break;
+        }
+    }
+    if (!header_end || !module_end) {
+        fprintf(stderr, "pack_banks: can't find a module in %s\n", filename);
+        return 1;
+    }
+
+    // collect the instances
+    int n_ac = 0, n_ff = 0;
+    for (size_t i = header_end + 1; i < module_end; i++) {
+        inst_t inst;
+        if (!parse_header(lines[i], inst.type, inst.name))
+            continue;
+        inst.first = i;
+        for (i++; i < module_end; i++) {
+            std::string port, conn;
+            if (trim(lines[i]) == ");")
+                break;
+            if (!parse_port(lines[i], port, conn)) {
+                fprintf(stderr, "pack_banks: %s: can't parse port of %s: %s\n", filename, inst.name.c_str(), lines[i].c_str());
+                return 1;
+            }
+            inst.ports[port] = conn;
+        }
+        inst.last = i;
+        if (check_ports(inst))
+            return 1;
+        inst.lane = inst.type == "ac" ? n_ac++ : n_ff++;
+        insts.push_back(inst);
+    }
+
+    printf("// generated by tools/pack_banks from %s, do not edit\n", filename);
+    printf("// %d ac instances packed into ac_bank, %d ff instances into ff_bank\n\n", n_ac, n_ff);
+
+    size_t next = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (next < insts.size() && i == insts[next].first) {
+            emit_inst(stdout, insts[next]);
+            i = insts[next].last;
+            next++;
+            continue;
+        }
+
+        if (i == module_end) {
+            printf("\n");
+            if (n_ac) {
+                printf("ac_bank #(.N(%d)) AC_BANK (\n", n_ac);
+                printf("    .clk(clk),\n");
+                printf("    .en(_ac_en),\n");
+                printf("    .trans(_ac_trans),\n");
+                printf("    .charged(_ac_charged)\n");
+                printf(");\n");
+            }
+            if (n_ff) {
+                printf("ff_bank #(.N(%d)) FF_BANK (\n", n_ff);
+                printf("    .clk(clk),\n");
+                printf("    .rst_l(_ff_rst_l),\n");
+                printf("    .set_l(_ff_set_l),\n");
+                printf("    .tog_p(_ff_tog_p),\n");
+                printf("    .rst_p(_ff_rst_p),\n");
+                printf("    .set_p(_ff_set_p),\n");
+                printf("    .q(_ff_q)\n");
+                printf(");\n");
+            }
+            printf("\n");
+        }
+
+        printf("%s\n", lines[i].c_str());
+
+        if (i == header_end) {
+            printf("\n// packed ac and ff lanes\n");
+            if (n_ac)
+                printf("wire [%d:0] _ac_en, _ac_trans, _ac_charged;\n", n_ac - 1);
+            if (n_ff)
+                printf("wire [%d:0] _ff_rst_l, _ff_set_l, _ff_tog_p, _ff_rst_p, _ff_set_p, _ff_q;\n", n_ff - 1);
+        }
+    }
+
+    return 0;
+}
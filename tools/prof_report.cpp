@@ -0,0 +1,393 @@
+// Friden simulator eval profile report
+//
+// reads the gprof flat profile of a simulator built with `make profile`
+// (Verilator --prof-cfuncs, which gives every always block or assign a
+// function of its own, named after its source file and line, e.g.
+// _sequent__TOP__3__PROF__top__l127) and maps the time back to the
+// Verilog sources, reporting:
+//  - the time per section of each source file, a section being the
+//    lines after a comment at the start of a line in top level code
+//    (// decode the data on the delay line and such, ...)
+//  - the time per source file, i.e. per module
+//  - the hottest statements, with the ac or ff instance they're the
+//    port connections of, if any
+//  - the time spent outside the model's statements (host code, eval
+//    bookkeeping)
+// and with -f, writes the same samples as folded stacks for
+// flamegraph.pl (file;section;line count)
+//
+// usage: prof_report [-n hottest] [-f folded] gprof.txt top.v ../modules/*.v
+//        [obj_dir/packed/*.v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+struct source_t {
+    std::string path;
+    std::vector<std::string> lines;
+    std::vector<int> section; // first line of the section each line is in
+    std::vector<std::string> inst; // ac/ff instance each line is in
+};
+
+struct stmt_t {
+    std::string file; // source file basename, without extension
+    int line;
+    double self;
+    uint64_t calls;
+};
+
+static std::map<std::string, source_t> sources;
+static std::vector<stmt_t> stmts;
+static std::vector<std::pair<std::string, double>> others;
+static double interval = 0.01;
+
+static std::string trim(const std::string &s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos)
+        return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+// "../modules/ac.v" -> "ac", the way Verilator names profiled functions
+static std::string base_name(const std::string &path) {
+    size_t slash = path.rfind('/');
+    std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = base.rfind('.');
+    if (dot != std::string::npos)
+        base = base.substr(0, dot);
+    for (auto &c : base)
+        if (!isalnum((unsigned char)c) && c != '_')
+            c = '_';
+    return base;
+}
+
+// "ac AC_1051 (" -> name, as in pack_banks
+static std::string inst_name(const std::string &line) {
+    std::string s = trim(line);
+    if ((s.compare(0, 3, "ac ") && s.compare(0, 3, "ff ")) || s.empty() || s[s.size() - 1] != '(')
+        return "";
+    return trim(s.substr(3, s.size() - 4));
+}
+
+static int read_source(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    // a later file of the same name (a packed copy of a card) replaces
+    // the one before it
+    source_t &src = sources[base_name(path)];
+    src = source_t();
+    src.path = path;
+    src.lines.push_back(""); // lines count from 1
+    char buf[4096];
+    while (fgets(buf, sizeof(buf), f)) {
+        std::string s = buf;
+        if (!s.empty() && s[s.size() - 1] == '\n')
+            s.erase(s.size() - 1);
+        src.lines.push_back(s);
+    }
+    fclose(f);
+
+    int section = 1;
+    int prev_comment = 0;
+    std::string inst;
+    src.section.resize(src.lines.size(), 1);
+    src.inst.resize(src.lines.size());
+    for (size_t i = 1; i < src.lines.size(); i++) {
+        const std::string &s = src.lines[i];
+        int comment = !s.compare(0, 2, "//");
+        if (comment && !prev_comment)
+            section = i;
+        prev_comment = comment;
+        src.section[i] = section;
+
+        if (inst.empty())
+            inst = inst_name(s);
+        src.inst[i] = inst;
+        if (!inst.empty() && trim(s) == ");")
+            inst.clear();
+    }
+    return 0;
+}
+
+// "_sequent__TOP__3__PROF__top__l127(Vtop___024root*)" -> top, 127
+static int parse_prof_name(const std::string &name, std::string &file, int &line) {
+    size_t p = name.find("__PROF__");
+    if (p == std::string::npos)
+        return 0;
+    p += 8;
+    size_t l = name.find("__l", p);
+    while (l != std::string::npos && !isdigit((unsigned char)name[l + 3]))
+        l = name.find("__l", l + 1);
+    if (l == std::string::npos)
+        return 0;
+    file = name.substr(p, l - p);
+    line = atoi(name.c_str() + l + 3);
+    return 1;
+}
+
+static int is_number(const char *s) {
+    char *end;
+    strtod(s, &end);
+    return end != s && (*end == '\0' || isspace((unsigned char)*end));
+}
+
+static int read_profile(const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        return -1;
+    }
+
+    char line[8192];
+    int in_flat = 0;
+    while (fgets(line, sizeof(line), f)) {
+        double d;
+        if (sscanf(line, " Each sample counts as %lf seconds", &d) == 1) {
+            interval = d;
+            continue;
+        }
+        if (strstr(line, "time   seconds   seconds")) {
+            in_flat = 1;
+            continue;
+        }
+        if (!in_flat)
+            continue;
+        if (line[0] == '\n' || line[0] == '\f')
+            break;
+
+        //  %time cumulative self [calls self/call total/call] name
+        const char *p = line;
+        double self = 0;
+        uint64_t calls = 0;
+        int fields = 0;
+        while (*p && fields < 6) {
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (!is_number(p))
+                break;
+            char *end;
+            double v = strtod(p, &end);
+            if (fields == 2)
+                self = v;
+            if (fields == 3)
+                calls = (uint64_t)v;
+            p = end;
+            fields++;
+        }
+        if (fields < 3)
+            continue;
+        std::string name = trim(p);
+
+        stmt_t st;
+        if (parse_prof_name(name, st.file, st.line)) {
+            st.self = self;
+            st.calls = calls;
+            stmts.push_back(st);
+        }
+        else
+            others.push_back({name, self});
+    }
+    fclose(f);
+    return 0;
+}
+
+static std::string source_line(const stmt_t &st) {
+    auto it = sources.find(st.file);
+    if (it == sources.end() || st.line <= 0 || st.line >= (int)it->second.lines.size())
+        return "";
+    return trim(it->second.lines[st.line]);
+}
+
+// "top" -> "top.v", if its source was given
+static std::string file_of(const stmt_t &st) {
+    auto it = sources.find(st.file);
+    if (it == sources.end())
+        return st.file;
+    const std::string &path = it->second.path;
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// "top.v:123-199 decode the data on the delay line and such"
+static std::string section_of(const stmt_t &st) {
+    auto it = sources.find(st.file);
+    if (it == sources.end() || st.line <= 0 || st.line >= (int)it->second.lines.size())
+        return st.file + " (source not given)";
+    const source_t &src = it->second;
+    int a = src.section[st.line];
+    int b = a;
+    while (b + 1 < (int)src.lines.size() && src.section[b + 1] == a)
+        b++;
+    std::string title = trim(src.lines[a]);
+    if (!title.compare(0, 2, "//"))
+        title = trim(title.substr(2));
+    else
+        title = "(start of file)";
+    char range[64];
+    snprintf(range, sizeof(range), ":%d-%d ", a, b);
+    return file_of(st) + range + title;
+}
+
+static std::string inst_of(const stmt_t &st) {
+    auto it = sources.find(st.file);
+    if (it == sources.end() || st.line <= 0 || st.line >= (int)it->second.inst.size())
+        return "";
+    return it->second.inst[st.line];
+}
+
+static std::vector<std::pair<std::string, double>> ranked(const std::map<std::string, double> &m) {
+    std::vector<std::pair<std::string, double>> v(m.begin(), m.end());
+    std::stable_sort(v.begin(), v.end(),
+        [](const std::pair<std::string, double> &a, const std::pair<std::string, double> &b) {
+            return a.second > b.second;
+        });
+    return v;
+}
+
+int main(int argc, char **argv) {
+    size_t hottest = 40;
+    const char *folded = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:f:")) != -1) {
+        switch (opt) {
+            case 'n': hottest = strtoul(optarg, NULL, 10); break;
+            case 'f': folded = optarg; break;
+            default: optind = argc + 1; break;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-n hottest] [-f folded] gprof.txt top.v ../modules/*.v\n", argv[0]);
+        return 1;
+    }
+
+    if (read_profile(argv[optind]))
+        return 1;
+    for (int i = optind + 1; i < argc; i++)
+        if (read_source(argv[i]))
+            return 1;
+
+    double model = 0, host = 0;
+    for (auto &st : stmts)
+        model += st.self;
+    for (auto &o : others)
+        host += o.second;
+    double total = model + host;
+    if (total <= 0) {
+        fprintf(stderr, "%s: no samples; was the model built with make profile?\n", argv[optind]);
+        return 1;
+    }
+
+    printf("eval profile: %.2f s sampled, %.1f%% in %zu Verilog statements, %.1f%% elsewhere\n\n",
+           total, 100 * model / total, stmts.size(), 100 * host / total);
+
+    // per section
+    std::map<std::string, double> by_section;
+    std::map<std::string, double> by_file;
+    std::map<std::string, double> by_inst;
+    for (auto &st : stmts) {
+        by_section[section_of(st)] += st.self;
+        auto it = sources.find(st.file);
+        by_file[it == sources.end() ? st.file : it->second.path] += st.self;
+        std::string inst = inst_of(st);
+        if (!inst.empty())
+            by_inst[inst] += st.self;
+    }
+
+    printf("time by section\n");
+    printf("%6s %9s  section\n", "%time", "self s");
+    for (auto &s : ranked(by_section))
+        printf("%6.1f %9.2f  %s\n", 100 * s.second / total, s.second, s.first.c_str());
+
+    printf("\ntime by source file (module)\n");
+    printf("%6s %9s  file\n", "%time", "self s");
+    for (auto &s : ranked(by_file))
+        printf("%6.1f %9.2f  %s\n", 100 * s.second / total, s.second, s.first.c_str());
+
+    if (!by_inst.empty()) {
+        printf("\ntime in ac/ff instance port connections\n");
+        printf("%6s %9s  instance\n", "%time", "self s");
+        size_t n = 0;
+        for (auto &s : ranked(by_inst)) {
+            if (n++ == hottest)
+                break;
+            printf("%6.1f %9.2f  %s\n", 100 * s.second / total, s.second, s.first.c_str());
+        }
+    }
+
+    std::vector<stmt_t> sorted = stmts;
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const stmt_t &a, const stmt_t &b) { return a.self > b.self; });
+
+    printf("\nhottest statements\n");
+    printf("%6s %9s %12s  %-16s source\n", "%time", "self s", "calls", "where");
+    for (size_t i = 0; i < sorted.size() && i < hottest; i++) {
+        const stmt_t &st = sorted[i];
+        char where[64];
+        snprintf(where, sizeof(where), "%s:%d", file_of(st).c_str(), st.line);
+        std::string text = source_line(st);
+        std::string inst = inst_of(st);
+        if (!inst.empty())
+            text = inst + ": " + text;
+        if (text.size() > 72)
+            text = text.substr(0, 69) + "...";
+        printf("%6.1f %9.2f %12lu  %-16s %s\n", 100 * st.self / total, st.self, st.calls,
+               where, text.c_str());
+    }
+
+    std::stable_sort(others.begin(), others.end(),
+        [](const std::pair<std::string, double> &a, const std::pair<std::string, double> &b) {
+            return a.second > b.second;
+        });
+    printf("\noutside the Verilog statements\n");
+    printf("%6s %9s  function\n", "%time", "self s");
+    for (size_t i = 0; i < others.size() && i < hottest; i++) {
+        if (others[i].second <= 0)
+            break;
+        printf("%6.1f %9.2f  %s\n", 100 * others[i].second / total, others[i].second,
+               others[i].first.c_str());
+    }
+
+    if (folded) {
+        FILE *f = fopen(folded, "w");
+        if (!f) {
+            perror(folded);
+            return 1;
+        }
+        for (auto &st : stmts) {
+            uint64_t n = (uint64_t)(st.self / interval + 0.5);
+            if (!n)
+                continue;
+            std::string section = section_of(st);
+            for (auto &c : section)
+                if (c == ';')
+                    c = ',';
+            fprintf(f, "Vtop::eval;%s;%s:%d %lu\n", section.c_str(), file_of(st).c_str(), st.line, n);
+        }
+        for (auto &o : others) {
+            uint64_t n = (uint64_t)(o.second / interval + 0.5);
+            if (!n)
+                continue;
+            std::string name = o.first;
+            for (auto &c : name)
+                if (c == ';')
+                    c = ',';
+            fprintf(f, "host;%s %lu\n", name.c_str(), n);
+        }
+        fclose(f);
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Friden simulator shared state monitor
+//
+// follows the state a simulator publishes with +shm+<name> (see
+// sim/shm_view.h), printing a line each time it changes: the cycle,
+// registers 1 to 4 and the storage register, the phase and counters,
+// and the control flip-flops that are set
+//
+// usage: shm_tail [-i ms] [-n lines] <name>
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "shm_view.h"
+
+// same layout as the simulators, most significant digit first
+static void print_reg(const uint8_t *reg, int dp) {
+    for (int i = 14; i >= 2; i--) {
+        printf("%x", reg[i]);
+        if (dp + 2 == i)
+            printf(".");
+    }
+    printf("%c ", reg[1] ? '-' : ' ');
+}
+
+static void print_cnt(const char *name, int cnt) {
+    if (cnt == SHM_CNT_NONE)
+        return;
+    printf("%s=%x ", name, cnt);
+}
+
+static void print_view(const shm_view_t *v) {
+    printf("%12lu ", v->cycle);
+    for (int r = 5; r >= 2; r--)
+        print_reg(v->reg[r], v->sw_dp);
+    printf("s=");
+    print_reg(v->reg[0], v->sw_dp);
+
+    printf("ph=%x ", v->phase);
+    print_cnt("a", v->a_cnt);
+    print_cnt("b", v->b_cnt);
+    print_cnt("c", v->c_cnt);
+    print_cnt("d", v->d_cnt);
+    print_cnt("dp", v->dp_cnt);
+
+    if (v->lamp_overflow)
+        printf("OVERFLOW ");
+    if (v->kbd_lock)
+        printf("lock ");
+    for (int i = 0; i < SHM_FFS; i++)
+        if (v->ffs & (1u << i))
+            printf("%s ", shm_ff_names[i]);
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int interval_ms = 100;
+    long lines = -1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+        switch (opt) {
+            case 'i': interval_ms = atoi(optarg); break;
+            case 'n': lines = atol(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-i ms] [-n lines] <name>\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-i ms] [-n lines] <name>\n", argv[0]);
+        return 1;
+    }
+
+    const shm_view_t *shm = shm_view_open(argv[optind]);
+    if (!shm) {
+        fprintf(stderr, "%s: no simulator state there, or of another version\n", argv[optind]);
+        return 1;
+    }
+
+    shm_view_t v, prev;
+    memset(&prev, 0, sizeof(prev));
+    int first = 1;
+
+    for (;;) {
+        if (shm_view_read(shm, &v)) {
+            fprintf(stderr, "%s: can't get a consistent read\n", argv[optind]);
+            return 1;
+        }
+        if (first)
+            printf("%s, updated every %lu cycles\n", v.model, v.interval);
+
+        // only the state after the cycle count is worth comparing
+        size_t from = offsetof(shm_view_t, reg);
+        if (first || memcmp((char *)&v + from, (char *)&prev + from, sizeof(v) - from)) {
+            print_view(&v);
+            fflush(stdout);
+            if (lines > 0 && --lines == 0)
+                break;
+        }
+        prev = v;
+        first = 0;
+
+        if (!__atomic_load_n(&shm->running, __ATOMIC_ACQUIRE)) {
+            printf("%s has stopped\n", v.model);
+            break;
+        }
+        usleep(interval_ms * 1000);
+    }
+
+    shm_view_close(shm);
+    return 0;
+}
@@ -0,0 +1,219 @@
+// Friden simulator toggle activity report
+//
+// reads the per-operation toggle coverage files written by a simulator
+// built with `make toggle` (logs/toggle_<op>_<n>.dat) and reports:
+//  - the hottest nets, broken down by operation type
+//  - nets that never toggled in any of the files
+//  - activity totals per card, taken from the card number in the
+//    instance or net name (START_1010, AC_1662, s_1662, ...)
+//
+// usage: toggle_report [-n hottest] logs/toggle_*.dat
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+struct net_t {
+    std::string card;
+    std::vector<uint64_t> ops; // toggles per operation type
+    uint64_t total;
+};
+
+static std::vector<std::string> op_names;
+static std::map<std::string, net_t> nets;
+
+// operation type from a file name like logs/toggle_mult_8.dat
+static std::string op_from_filename(const char *filename) {
+    const char *base = strrchr(filename, '/');
+    base = base ? base + 1 : filename;
+    std::string op = base;
+    if (op.compare(0, 7, "toggle_") == 0)
+        op = op.substr(7);
+    size_t dot = op.rfind('.');
+    if (dot != std::string::npos)
+        op = op.substr(0, dot);
+    size_t us = op.rfind('_');
+    if (us != std::string::npos && us + 1 < op.size() && isdigit((unsigned char)op[us + 1]))
+        op = op.substr(0, us);
+    return op;
+}
+
+// first four-digit number in a name, as the card it belongs to,
+// e.g. AC_1662 -> 166x
+static std::string card_from_name(const std::string &name) {
+    for (size_t i = 0; i + 4 <= name.size(); i++) {
+        if ((i == 0 || !isdigit((unsigned char)name[i - 1])) &&
+            isdigit((unsigned char)name[i]) && isdigit((unsigned char)name[i + 1]) &&
+            isdigit((unsigned char)name[i + 2]) && isdigit((unsigned char)name[i + 3]) &&
+            (i + 4 == name.size() || !isdigit((unsigned char)name[i + 4])))
+            return name.substr(i, 3) + "x";
+    }
+    return "";
+}
+
+// net name from a coverage point: hierarchy plus signal, without the
+// bit index or toggle direction (e.g. top.AC_1662 / _cnt[2]:0->1)
+static std::string net_from_point(std::string hier, std::string sig) {
+    size_t cut = sig.find_first_of("[:");
+    if (cut != std::string::npos)
+        sig = sig.substr(0, cut);
+    if (hier.compare(0, 4, "top.") == 0)
+        hier = hier.substr(4);
+    else if (hier == "top")
+        hier = "";
+    return hier.empty() ? sig : hier + "." + sig;
+}
+
+static int read_file(const char *filename, size_t op) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        return -1;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+        // C '<\001key\002value...>' count
+        if (strncmp(line, "C '", 3))
+            continue;
+        char *end = strrchr(line, '\'');
+        if (!end || end == line + 2)
+            continue;
+        *end = '\0';
+        uint64_t count = strtoull(end + 1, NULL, 10);
+
+        std::string page, hier, sig;
+        std::string keys(line + 3);
+        size_t pos = 0;
+        while (pos < keys.size()) {
+            size_t next = keys.find('\001', pos + 1);
+            if (next == std::string::npos)
+                next = keys.size();
+            std::string kv = keys.substr(pos, next - pos);
+            if (!kv.empty() && kv[0] == '\001')
+                kv.erase(0, 1);
+            size_t sep = kv.find('\002');
+            if (sep != std::string::npos) {
+                std::string key = kv.substr(0, sep);
+                if (key == "page")
+                    page = kv.substr(sep + 1);
+                else if (key == "h")
+                    hier = kv.substr(sep + 1);
+                else if (key == "o")
+                    sig = kv.substr(sep + 1);
+            }
+            pos = next;
+        }
+
+        if (page.compare(0, 8, "v_toggle") || sig.empty())
+            continue;
+
+        std::string name = net_from_point(hier, sig);
+        net_t &n = nets[name];
+        if (n.ops.empty()) {
+            n.card = card_from_name(name);
+            n.total = 0;
+        }
+        n.ops.resize(op_names.size(), 0);
+        n.ops[op] += count;
+        n.total += count;
+    }
+
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    size_t hottest = 40;
+    int first = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        hottest = strtoul(argv[2], NULL, 10);
+        first = 3;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [-n hottest] toggle_<op>_<n>.dat ...\n", argv[0]);
+        return 1;
+    }
+
+    // operation types, in the order they first appear
+    std::vector<size_t> file_op;
+    for (int i = first; i < argc; i++) {
+        std::string op = op_from_filename(argv[i]);
+        size_t j = std::find(op_names.begin(), op_names.end(), op) - op_names.begin();
+        if (j == op_names.size())
+            op_names.push_back(op);
+        file_op.push_back(j);
+    }
+
+    for (int i = first; i < argc; i++)
+        if (read_file(argv[i], file_op[i - first]))
+            return 1;
+
+    std::vector<std::pair<std::string, net_t *>> sorted;
+    for (auto &n : nets) {
+        n.second.ops.resize(op_names.size(), 0);
+        sorted.push_back({n.first, &n.second});
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const std::pair<std::string, net_t *> &a, const std::pair<std::string, net_t *> &b) {
+            return a.second->total > b.second->total;
+        });
+
+    uint64_t grand = 0;
+    for (auto &n : sorted)
+        grand += n.second->total;
+
+    printf("toggle activity: %d files, %zu operation types, %zu nets, %lu toggles\n\n",
+           argc - first, op_names.size(), nets.size(), grand);
+
+    // hottest nets
+    printf("hottest nets\n");
+    printf("%5s %12s", "rank", "total");
+    for (auto &op : op_names)
+        printf(" %10.10s", op.c_str());
+    printf("  net\n");
+    for (size_t i = 0; i < sorted.size() && i < hottest; i++) {
+        printf("%5zu %12lu", i + 1, sorted[i].second->total);
+        for (auto t : sorted[i].second->ops)
+            printf(" %10lu", t);
+        printf("  %s\n", sorted[i].first.c_str());
+    }
+
+    // dead nets
+    size_t dead = 0;
+    for (auto &n : sorted)
+        if (!n.second->total)
+            dead++;
+    printf("\nnets that never toggled (%zu)\n", dead);
+    for (auto &n : nets)
+        if (!n.second.total)
+            printf("  %s\n", n.first.c_str());
+
+    // per-card totals
+    std::map<std::string, std::pair<size_t, uint64_t>> cards;
+    for (auto &n : nets) {
+        auto &c = cards[n.second.card.empty() ? "(none)" : n.second.card];
+        c.first++;
+        c.second += n.second.total;
+    }
+    std::vector<std::pair<std::string, std::pair<size_t, uint64_t>>> card_sorted(cards.begin(), cards.end());
+    std::stable_sort(card_sorted.begin(), card_sorted.end(),
+        [](const std::pair<std::string, std::pair<size_t, uint64_t>> &a,
+           const std::pair<std::string, std::pair<size_t, uint64_t>> &b) {
+            return a.second.second > b.second.second;
+        });
+
+    printf("\nactivity per card\n");
+    printf("%-8s %6s %12s %7s\n", "card", "nets", "toggles", "share");
+    for (auto &c : card_sorted)
+        printf("%-8s %6zu %12lu %6.2f%%\n", c.first.c_str(), c.second.first, c.second.second,
+               grand ? 100.0 * c.second.second / grand : 0.0);
+
+    return 0;
+}
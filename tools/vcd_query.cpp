@@ -0,0 +1,692 @@
+// Friden simulator trace query
+//
+// answers questions about a large VCD (logs/trace.vcd from make trace,
+// or one written by dltrace_dump -v) without loading it into a viewer:
+// the VCD is memory mapped, and on first use indexed in one pass split
+// across threads, each signal getting the times and file offsets of its
+// changes; the index is kept in <trace>.idx and used again as long as
+// the VCD hasn't changed since
+//
+// queries, with times in cycles (-t ticks of VCD time per cycle; 10, as
+// the simulators dump, or 1 for a VCD from dltrace_dump):
+//   list [pattern]            signals, with their widths and changes
+//   value <signal> <cycle>    a signal's value at the end of a cycle
+//   edges <pattern> [from:to] rising and falling edges of the 1 bit
+//                             signals matching pattern, e.g. 'ff_*'
+//   regs <cycle>              the decoded registers at the end of a cycle
+//   between <a> <b> [from:to] cycles from each event a to the next event
+//                             b, where an event is <signal>[:rise|:fall]
+//                             (any change if neither is given)
+// signals are named by their full name or the last part of it, and
+// patterns are shell wildcards matched against either
+//
+// usage: vcd_query [-j threads] [-t ticks] [-r] <trace.vcd> <query> [args]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// a change whose time and offset are written whole rather than as
+// deltas from the one before, every this many changes of a signal
+#define SKIP_EVERY 256
+
+#define INDEX_MAGIC "FRIDVQX1"
+
+struct signal_t {
+    std::string id;
+    int width;
+    std::vector<std::string> names; // full names, first as declared
+};
+
+// a change whose time and offset restart the deltas
+struct skip_t {
+    uint64_t time;
+    uint64_t pos; // in the signal's bytes
+    uint64_t index; // which change of the signal it is
+};
+
+struct index_header_t {
+    char magic[8];
+    uint64_t vcd_size;
+    int64_t vcd_mtime;
+    uint64_t signals;
+};
+
+struct index_signal_t {
+    uint64_t changes;
+    uint64_t skips;
+    uint64_t bytes;
+    uint64_t data; // file offset of the skips, then the bytes
+};
+
+// a signal's changes, as read from the index
+struct changes_t {
+    uint64_t count;
+    const skip_t *skips;
+    uint64_t nskips;
+    const uint8_t *bytes;
+};
+
+static const char *vcd;
+static size_t vcd_size;
+static const char *body; // just past $enddefinitions
+static std::vector<signal_t> signals;
+static std::vector<changes_t> changes;
+static uint64_t ticks = 10;
+
+// maps VCD identifiers to signals; the views are of the ids in signals,
+// for looking up changes without copying their ids
+static std::unordered_map<std::string, int> by_id;
+static std::unordered_map<std::string_view, int> by_view;
+
+static void *map_file(const char *filename, size_t *size, struct stat *st) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, st) || !st->st_size) {
+        close(fd);
+        return NULL;
+    }
+    void *p = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+    *size = st->st_size;
+    return p;
+}
+
+// the next whitespace separated token of the header
+static std::string token(const char *&p) {
+    const char *end = vcd + vcd_size;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        p++;
+    const char *start = p;
+    while (p < end && !(*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        p++;
+    return std::string(start, p - start);
+}
+
+static int read_header() {
+    const char *p = vcd;
+    std::vector<std::string> scopes;
+    for (;;) {
+        std::string t = token(p);
+        if (t.empty())
+            return -1;
+        if (t == "$scope") {
+            token(p);
+            scopes.push_back(token(p));
+            token(p);
+        }
+        else if (t == "$upscope") {
+            if (!scopes.empty())
+                scopes.pop_back();
+            token(p);
+        }
+        else if (t == "$var") {
+            token(p);
+            int width = atoi(token(p).c_str());
+            std::string id = token(p);
+            std::string name;
+            for (auto &s : scopes)
+                name += s + ".";
+            name += token(p);
+            while (!(t = token(p)).empty() && t != "$end")
+                ;
+            auto i = by_id.find(id);
+            if (i == by_id.end()) {
+                by_id[id] = signals.size();
+                signals.push_back({id, width, {name}});
+            }
+            else
+                signals[i->second].names.push_back(name);
+        }
+        else if (t == "$enddefinitions") {
+            token(p);
+            body = p;
+            for (size_t i = 0; i < signals.size(); i++)
+                by_view[signals[i].id] = i;
+            return 0;
+        }
+        else if (t[0] == '$') {
+            // $date, $version, $timescale, $comment
+            std::string text;
+            while (!(t = token(p)).empty() && t != "$end")
+                text += t + " ";
+            if (text.find("a timestep per cycle") != std::string::npos)
+                ticks = 1;
+        }
+    }
+}
+
+static void put_varint(std::string &out, uint64_t v) {
+    while (v >= 0x80) {
+        out += (char)(v | 0x80);
+        v >>= 7;
+    }
+    out += (char)v;
+}
+
+static uint64_t get_varint(const uint8_t *&p) {
+    uint64_t v = 0;
+    for (int shift = 0; ; shift += 7) {
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+}
+
+// one thread's changes of one signal
+struct stream_t {
+    std::string bytes;
+    std::vector<skip_t> skips;
+    uint64_t count = 0;
+    uint64_t time = 0, offset = 0; // of the last change
+};
+
+static void index_chunk(const char *p, const char *end, std::vector<stream_t> *streams) {
+    uint64_t time = 0;
+    while (p < end) {
+        const char *eol = (const char *)memchr(p, '\n', end - p);
+        if (!eol)
+            eol = end;
+        const char *id = NULL;
+        switch (*p) {
+            case '#':
+                time = strtoull(p + 1, NULL, 10);
+                break;
+            case '0': case '1': case 'x': case 'X': case 'z': case 'Z':
+                id = p + 1;
+                break;
+            case 'b': case 'B': case 'r': case 'R':
+                id = (const char *)memchr(p, ' ', eol - p);
+                if (id)
+                    id++;
+                break;
+        }
+        if (id) {
+            const char *id_end = eol;
+            while (id_end > id && (id_end[-1] == '\r' || id_end[-1] == ' '))
+                id_end--;
+            auto i = by_view.find(std::string_view(id, id_end - id));
+            if (i != by_view.end()) {
+                stream_t &s = (*streams)[i->second];
+                uint64_t offset = p - vcd;
+                if (!(s.count % SKIP_EVERY) || s.skips.empty()) {
+                    s.skips.push_back({time, s.bytes.size(), s.count});
+                    s.time = 0;
+                    s.offset = 0;
+                }
+                put_varint(s.bytes, time - s.time);
+                put_varint(s.bytes, offset - s.offset);
+                s.time = time;
+                s.offset = offset;
+                s.count++;
+            }
+        }
+        p = eol + 1;
+    }
+}
+
+static int write_index(const char *filename, const struct stat *st, int threads) {
+    const char *end = vcd + vcd_size;
+    size_t len = end - body;
+    if ((size_t)threads > len / 65536 + 1)
+        threads = len / 65536 + 1;
+
+    // each chunk starts at a timestamp, so it knows its time
+    std::vector<const char *> starts;
+    starts.push_back(body);
+    for (int t = 1; t < threads; t++) {
+        const char *p = body + len * t / threads;
+        while (p < end && !(p[-1] == '\n' && *p == '#'))
+            p++;
+        if (p > starts.back())
+            starts.push_back(p);
+    }
+    starts.push_back(end);
+
+    std::vector<std::vector<stream_t>> streams(starts.size() - 1,
+                                               std::vector<stream_t>(signals.size()));
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t + 1 < starts.size(); t++)
+        workers.emplace_back(index_chunk, starts[t], starts[t + 1], &streams[t]);
+    for (auto &w : workers)
+        w.join();
+
+    std::string tmp = std::string(filename) + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f)
+        return -1;
+    index_header_t h;
+    memcpy(h.magic, INDEX_MAGIC, 8);
+    h.vcd_size = st->st_size;
+    h.vcd_mtime = st->st_mtime;
+    h.signals = signals.size();
+    fwrite(&h, sizeof(h), 1, f);
+
+    // the table of signals, then their data, each chunk's run of it
+    // carried on from the last with its skips moved along
+    std::vector<index_signal_t> table(signals.size());
+    uint64_t data = sizeof(h) + table.size() * sizeof(index_signal_t);
+    for (size_t i = 0; i < signals.size(); i++) {
+        index_signal_t &e = table[i];
+        e.changes = e.skips = e.bytes = 0;
+        for (auto &chunk : streams) {
+            e.changes += chunk[i].count;
+            e.skips += chunk[i].skips.size();
+            e.bytes += chunk[i].bytes.size();
+        }
+        e.data = data;
+        data += (e.skips * sizeof(skip_t) + e.bytes + 7) & ~7ull;
+    }
+    fwrite(table.data(), sizeof(index_signal_t), table.size(), f);
+    for (size_t i = 0; i < signals.size(); i++) {
+        uint64_t pos = 0, count = 0;
+        for (auto &chunk : streams) {
+            for (skip_t k : chunk[i].skips) {
+                k.pos += pos;
+                k.index += count;
+                fwrite(&k, sizeof(k), 1, f);
+            }
+            pos += chunk[i].bytes.size();
+            count += chunk[i].count;
+        }
+        for (auto &chunk : streams) {
+            fwrite(chunk[i].bytes.data(), 1, chunk[i].bytes.size(), f);
+            std::string().swap(chunk[i].bytes);
+        }
+        static const char pad[8] = {0};
+        size_t used = table[i].skips * sizeof(skip_t) + table[i].bytes;
+        fwrite(pad, 1, ((used + 7) & ~7ull) - used, f);
+    }
+    if (fclose(f) || rename(tmp.c_str(), filename)) {
+        unlink(tmp.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+static int read_index(const char *filename, const struct stat *vcd_st) {
+    size_t size;
+    struct stat st;
+    const char *p = (const char *)map_file(filename, &size, &st);
+    if (!p)
+        return -1;
+    const index_header_t *h = (const index_header_t *)p;
+    if (size < sizeof(*h) || memcmp(h->magic, INDEX_MAGIC, 8) ||
+        h->vcd_size != (uint64_t)vcd_st->st_size || h->vcd_mtime != vcd_st->st_mtime ||
+        h->signals != signals.size() || size < sizeof(*h) + h->signals * sizeof(index_signal_t)) {
+        munmap((void *)p, size);
+        return -1;
+    }
+    const index_signal_t *table = (const index_signal_t *)(h + 1);
+    changes.resize(signals.size());
+    for (size_t i = 0; i < signals.size(); i++) {
+        changes[i].count = table[i].changes;
+        changes[i].skips = (const skip_t *)(p + table[i].data);
+        changes[i].nskips = table[i].skips;
+        changes[i].bytes = (const uint8_t *)(changes[i].skips + table[i].skips);
+    }
+    return 0;
+}
+
+// walks the changes of a signal
+struct cursor_t {
+    const changes_t *c;
+    uint64_t next; // index of the next change
+    uint64_t skip; // the next skip
+    const uint8_t *p;
+    uint64_t time, offset; // of the change last read
+};
+
+static void cursor_at_skip(cursor_t &k, const changes_t *c, uint64_t skip) {
+    k.c = c;
+    k.skip = skip;
+    k.next = skip < c->nskips ? c->skips[skip].index : c->count;
+    k.p = c->bytes + (skip < c->nskips ? c->skips[skip].pos : 0);
+    k.time = k.offset = 0;
+}
+
+static int cursor_step(cursor_t &k) {
+    if (k.next >= k.c->count)
+        return 0;
+    if (k.skip < k.c->nskips && k.c->skips[k.skip].index == k.next) {
+        k.time = k.offset = 0;
+        k.skip++;
+    }
+    k.time += get_varint(k.p);
+    k.offset += get_varint(k.p);
+    k.next++;
+    return 1;
+}
+
+// time of the change the cursor would read next, or UINT64_MAX
+static uint64_t cursor_peek(const cursor_t &k) {
+    if (k.next >= k.c->count)
+        return UINT64_MAX;
+    cursor_t t = k;
+    cursor_step(t);
+    return t.time;
+}
+
+// positions k just before the first change after time; returns 0 if
+// there is no change at or before it
+static int cursor_seek(cursor_t &k, const changes_t *c, uint64_t time) {
+    // the last skip at or before time
+    uint64_t lo = 0, hi = c->nskips;
+    while (lo < hi) {
+        uint64_t mid = (lo + hi) / 2;
+        if (c->skips[mid].time <= time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    cursor_at_skip(k, c, lo ? lo - 1 : 0);
+    int found = 0;
+    while (cursor_peek(k) <= time) {
+        cursor_step(k);
+        found = 1;
+    }
+    return found;
+}
+
+// the value written at a change: a bit, or the bits of a vector
+static std::string value_at(uint64_t offset) {
+    const char *p = vcd + offset;
+    if (*p == 'b' || *p == 'B' || *p == 'r' || *p == 'R') {
+        const char *end = p + 1;
+        while (*end != ' ' && *end != '\n')
+            end++;
+        return std::string(p + 1, end - p - 1);
+    }
+    return std::string(1, *p);
+}
+
+static std::string short_name(const std::string &name) {
+    size_t dot = name.rfind('.');
+    return dot == std::string::npos ? name : name.substr(dot + 1);
+}
+
+static int matches(const signal_t &s, const char *pattern) {
+    for (auto &n : s.names)
+        if (!fnmatch(pattern, n.c_str(), 0) || !fnmatch(pattern, short_name(n).c_str(), 0))
+            return 1;
+    return 0;
+}
+
+static int find_signal(const char *name) {
+    for (size_t i = 0; i < signals.size(); i++)
+        for (auto &n : signals[i].names)
+            if (n == name)
+                return i;
+    for (size_t i = 0; i < signals.size(); i++)
+        for (auto &n : signals[i].names)
+            if (short_name(n) == name)
+                return i;
+    fprintf(stderr, "no signal %s\n", name);
+    exit(1);
+}
+
+// the end of a cycle, in VCD time
+static uint64_t cycle_end(uint64_t cycle) {
+    return cycle * ticks + ticks - 1;
+}
+
+static int parse_window(const char *arg, uint64_t *from, uint64_t *to) {
+    *from = 0;
+    *to = UINT64_MAX;
+    return arg && sscanf(arg, "%lu:%lu", from, to) < 1 ? -1 : 0;
+}
+
+static void query_list(const char *pattern) {
+    for (size_t i = 0; i < signals.size(); i++) {
+        if (pattern && !matches(signals[i], pattern))
+            continue;
+        printf("%-40s %4d %12lu\n", signals[i].names[0].c_str(), signals[i].width,
+               changes[i].count);
+    }
+}
+
+static void print_value(const std::string &bits) {
+    printf("%s", bits.c_str());
+    if (bits.size() > 1 && bits.size() <= 64 && bits.find_first_not_of("01") == std::string::npos)
+        printf(" (0x%lx)", (uint64_t)strtoull(bits.c_str(), NULL, 2));
+    printf("\n");
+}
+
+static void query_value(const char *name, uint64_t cycle) {
+    int i = find_signal(name);
+    cursor_t k;
+    if (!cursor_seek(k, &changes[i], cycle_end(cycle))) {
+        printf("%s has no value yet at cycle %lu\n", name, cycle);
+        return;
+    }
+    printf("%s = ", name);
+    print_value(value_at(k.offset));
+    printf("since cycle %lu\n", k.time / ticks);
+}
+
+struct edge_t {
+    uint64_t time;
+    int signal;
+    char value;
+};
+
+static void query_edges(const char *pattern, uint64_t from, uint64_t to) {
+    std::vector<edge_t> edges;
+    for (size_t i = 0; i < signals.size(); i++) {
+        if (signals[i].width != 1 || !matches(signals[i], pattern))
+            continue;
+        cursor_t k;
+        cursor_seek(k, &changes[i], from ? cycle_end(from - 1) : 0);
+        if (!from)
+            cursor_at_skip(k, &changes[i], 0);
+        while (cursor_step(k) && k.time / ticks < to)
+            edges.push_back({k.time, (int)i, vcd[k.offset]});
+    }
+    std::stable_sort(edges.begin(), edges.end(),
+                     [](const edge_t &a, const edge_t &b) { return a.time < b.time; });
+    for (auto &e : edges)
+        printf("%12lu %-24s %s\n", e.time / ticks, short_name(signals[e.signal].names[0]).c_str(),
+               e.value == '1' ? "rise" : e.value == '0' ? "fall" : "x");
+}
+
+// same layout as dltrace_dump, most significant digit first
+static void print_reg(uint64_t v, int dp) {
+    for (int i = 14; i >= 2; i--) {
+        printf("%x", (int)(v >> 4 * i) & 0xf);
+        if (dp + 2 == i)
+            printf(".");
+    }
+    printf("%c\n", v >> 4 & 0xf ? '-' : ' ');
+}
+
+static int value_of(const char *name, uint64_t time, uint64_t *v) {
+    for (size_t i = 0; i < signals.size(); i++) {
+        for (auto &n : signals[i].names) {
+            if (short_name(n) != name)
+                continue;
+            cursor_t k;
+            if (!cursor_seek(k, &changes[i], time))
+                return -1;
+            std::string bits = value_at(k.offset);
+            if (bits.find_first_not_of("01") != std::string::npos)
+                return -1;
+            *v = strtoull(bits.c_str(), NULL, 2);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void query_regs(uint64_t cycle) {
+    // the packed outputs of the simulators, or the registers of a
+    // dltrace_dump VCD
+    static const char *names[][2] = {
+        {"reg_4_l", "reg_4"}, {"reg_3_l", "reg_3"}, {"reg_2_l", "reg_2"},
+        {"reg_1_l", "reg_1"}, {"reg_0_l", "reg_0"}, {"reg_s_l", "reg_s"}
+    };
+    uint64_t time = cycle_end(cycle), dp = 0;
+    value_of("sw_dp", time, &dp);
+    for (auto &n : names) {
+        uint64_t v;
+        printf("%-6s", n[1]);
+        if (value_of(n[0], time, &v) && value_of(n[1], time, &v))
+            printf("unknown\n");
+        else
+            print_reg(v, dp);
+    }
+}
+
+// an event: a signal, and which of its changes count
+struct event_t {
+    int signal;
+    char value; // '1' for rises, '0' for falls, 0 for any change
+};
+
+static event_t parse_event(const char *arg) {
+    std::string name(arg);
+    char value = 0;
+    size_t colon = name.rfind(':');
+    if (colon != std::string::npos) {
+        std::string edge = name.substr(colon + 1);
+        name.resize(colon);
+        if (edge == "rise")
+            value = '1';
+        else if (edge == "fall")
+            value = '0';
+        else {
+            fprintf(stderr, "unknown edge %s, not rise or fall\n", edge.c_str());
+            exit(1);
+        }
+    }
+    return {find_signal(name.c_str()), value};
+}
+
+static int next_event(cursor_t &k, const event_t &e) {
+    while (cursor_step(k))
+        if (!e.value || vcd[k.offset] == e.value)
+            return 1;
+    return 0;
+}
+
+static void query_between(const event_t &a, const event_t &b, uint64_t from, uint64_t to) {
+    cursor_t ka, kb;
+    cursor_seek(ka, &changes[a.signal], from ? cycle_end(from - 1) : 0);
+    if (!from)
+        cursor_at_skip(ka, &changes[a.signal], 0);
+    int have_b = 0;
+
+    std::vector<uint64_t> spans;
+    while (next_event(ka, a) && ka.time / ticks < to) {
+        // the first b after this a, which a later a may share
+        if (!have_b || kb.time <= ka.time) {
+            cursor_seek(kb, &changes[b.signal], ka.time);
+            if (!next_event(kb, b))
+                break;
+            have_b = 1;
+        }
+        uint64_t span = (kb.time - ka.time) / ticks;
+        spans.push_back(span);
+        printf("%12lu %12lu %10lu\n", ka.time / ticks, kb.time / ticks, span);
+    }
+    if (spans.empty()) {
+        printf("no events\n");
+        return;
+    }
+    std::sort(spans.begin(), spans.end());
+    uint64_t sum = 0;
+    for (uint64_t s : spans)
+        sum += s;
+    printf("%zu spans: min %lu, median %lu, mean %.1f, max %lu cycles\n", spans.size(),
+           spans.front(), spans[spans.size() / 2], (double)sum / spans.size(), spans.back());
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [-j threads] [-t ticks] [-r] <trace.vcd> <query> [args]\n"
+            "  list [pattern]\n"
+            "  value <signal> <cycle>\n"
+            "  edges <pattern> [from:to]\n"
+            "  regs <cycle>\n"
+            "  between <signal>[:rise|:fall] <signal>[:rise|:fall] [from:to]\n", name);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int threads = std::thread::hardware_concurrency();
+    int rebuild = 0;
+    long t_arg = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:t:r")) != -1) {
+        switch (opt) {
+            case 'j': threads = atoi(optarg); break;
+            case 't': t_arg = atol(optarg); break;
+            case 'r': rebuild = 1; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (argc - optind < 2)
+        usage(argv[0]);
+    if (threads < 1)
+        threads = 1;
+
+    const char *filename = argv[optind];
+    struct stat st;
+    vcd = (const char *)map_file(filename, &vcd_size, &st);
+    if (!vcd) {
+        perror(filename);
+        return 1;
+    }
+    if (read_header()) {
+        fprintf(stderr, "%s has no $enddefinitions\n", filename);
+        return 1;
+    }
+    if (t_arg > 0)
+        ticks = t_arg;
+
+    std::string index = std::string(filename) + ".idx";
+    if (rebuild || read_index(index.c_str(), &st)) {
+        fprintf(stderr, "indexing %s...\n", filename);
+        madvise((void *)vcd, vcd_size, MADV_SEQUENTIAL);
+        if (write_index(index.c_str(), &st, threads) || read_index(index.c_str(), &st)) {
+            fprintf(stderr, "can't write index %s\n", index.c_str());
+            return 1;
+        }
+        madvise((void *)vcd, vcd_size, MADV_RANDOM);
+    }
+
+    const char *query = argv[optind + 1];
+    char **args = argv + optind + 2;
+    int nargs = argc - optind - 2;
+    uint64_t from, to;
+    if (!strcmp(query, "list") && nargs <= 1)
+        query_list(nargs ? args[0] : NULL);
+    else if (!strcmp(query, "value") && nargs == 2)
+        query_value(args[0], strtoull(args[1], NULL, 0));
+    else if (!strcmp(query, "edges") && (nargs == 1 || nargs == 2) &&
+             !parse_window(nargs == 2 ? args[1] : NULL, &from, &to))
+        query_edges(args[0], from, to);
+    else if (!strcmp(query, "regs") && nargs == 1)
+        query_regs(strtoull(args[0], NULL, 0));
+    else if (!strcmp(query, "between") && (nargs == 2 || nargs == 3) &&
+             !parse_window(nargs == 3 ? args[2] : NULL, &from, &to))
+        query_between(parse_event(args[0]), parse_event(args[1]), from, to);
+    else
+        usage(argv[0]);
+    return 0;
+}